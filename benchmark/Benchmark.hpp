@@ -0,0 +1,187 @@
+/**
+  *   @file Benchmark.hpp
+  *   @author Lauri Westerholm
+  *   @brief Helpers shared by all benchmarks
+  *   @details Contains timing utilities and scene builders which tile demo levels
+  */
+
+#pragma once
+
+#include "../include/PhysicsWorld.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+  *   @namespace bench
+  *   @brief Benchmark helpers
+  */
+namespace bench {
+
+  const char* const ManyObjects = "../demo/demo_levels/many_objects.csv"; /**< Mixed static and dynamic level */
+  const char* const ObjectMayhem = "../demo/demo_levels/object_mayhem.csv"; /**< Only dynamic objects */
+  const float TileSpacing = 1000.f; /**< Distance between tiled level copies */
+
+  /**
+    *   @struct LevelObject
+    *   @brief One row of a demo level csv file
+    */
+  struct LevelObject {
+    pe::ObjectType::ObjectType type; /**< DynamicObject or StaticObject */
+    float x; /**< x coordinate of the left upper corner */
+    float y; /**< y coordinate of the left upper corner */
+    float width; /**< object width */
+    float height; /**< object height */
+  };
+
+  /**
+    *   @class Timer
+    *   @brief Simple wall clock timer
+    */
+  class Timer {
+    public:
+      /**
+        *   @brief Constructor, starts the timer
+        */
+      Timer(): start(std::chrono::steady_clock::now()) {}
+
+      /**
+        *   @brief Restart timer
+        */
+      inline void reset() {
+        start = std::chrono::steady_clock::now();
+      }
+
+      /**
+        *   @brief Get elapsed time
+        *   @return milliseconds since construction or reset
+        */
+      inline double elapsed() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      }
+
+    private:
+      std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+    *   @brief Parse command line argument
+    *   @param argc argument count
+    *   @param argv arguments
+    *   @param index argument index
+    *   @param fallback value returned if argument is missing
+    *   @return parsed unsigned value
+    */
+  inline unsigned argument(int argc, char** argv, int index, unsigned fallback) {
+    if (argc > index) {
+      int value = std::atoi(argv[index]);
+      if (value > 0) return static_cast<unsigned>(value);
+    }
+    return fallback;
+  }
+
+  /**
+    *   @brief Read demo level csv file
+    *   @param path csv file path
+    *   @return objects of the level, empty if file couldn't be read
+    */
+  inline std::vector<LevelObject> readLevel(const char* path) {
+    std::vector<LevelObject> objects;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+      std::istringstream stream(line);
+      std::string type, x, y, width, height;
+      if (std::getline(stream, type, ',') && std::getline(stream, x, ',') && std::getline(stream, y, ',') &&
+          std::getline(stream, width, ',') && std::getline(stream, height, ',')) {
+        LevelObject object;
+        object.type = type == "DynamicObject" ? pe::ObjectType::DynamicObject : pe::ObjectType::StaticObject;
+        object.x = std::stof(x);
+        object.y = std::stof(y);
+        object.width = std::stof(width);
+        object.height = std::stof(height);
+        objects.push_back(object);
+      }
+    }
+    if (objects.empty()) std::cout << "Level read failed: " << path << std::endl;
+    return objects;
+  }
+
+  /**
+    *   @brief Create PhysicsObject matching LevelObject
+    *   @details Position is the left upper corner like in demo
+    *   @param object level object
+    *   @param shapes storage for created Shapes (deque keeps pointers valid)
+    *   @param offset added to the object position
+    *   @return heap allocated PhysicsObject, ownership is passed to caller
+    */
+  inline pe::PhysicsObject* createObject(const LevelObject& object, std::deque<pe::Shape>& shapes, pe::Vector2f offset) {
+    shapes.push_back(pe::Shape(object.width, object.height));
+    pe::Shape* shape = &shapes.back();
+    pe::PhysicsObject* physObject;
+    if (object.type == pe::ObjectType::StaticObject) physObject = new pe::StaticObject(shape);
+    else physObject = new pe::DynamicObject(shape, 1.f);
+    physObject->setOriginTransform(pe::Vector2f(object.width / 2.f, object.height / 2.f));
+    physObject->setPosition(pe::Vector2f(object.x, object.y) + offset);
+    return physObject;
+  }
+
+  /**
+    *   @brief Tile level copies to PhysicsWorld
+    *   @details Copies are placed row by row starting from origin
+    *   @param world PhysicsWorld where objects are added
+    *   @param level objects returned by readLevel
+    *   @param copies how many copies of the level are created
+    *   @param shapes storage for created Shapes
+    *   @param columns how many copies are placed to one row
+    *   @param origin position of the first copy
+    *   @return amount of added objects
+    */
+  inline unsigned tileLevel(pe::PhysicsWorld& world, const std::vector<LevelObject>& level, unsigned copies,
+                            std::deque<pe::Shape>& shapes, unsigned columns, pe::Vector2f origin) {
+    unsigned added = 0;
+    for (unsigned i = 0; i < copies; i++) {
+      pe::Vector2f offset = origin + pe::Vector2f(TileSpacing * (i % columns), TileSpacing * (i / columns));
+      for (auto& object : level) {
+        if (world.addObject(createObject(object, shapes, offset))) added++;
+      }
+    }
+    return added;
+  }
+
+  /**
+    *   @brief Tile level copies to PhysicsWorld
+    *   @details Copies are placed to a square pattern centered around origin
+    *   @param world PhysicsWorld where objects are added
+    *   @param level objects returned by readLevel
+    *   @param copies how many copies of the level are created
+    *   @param shapes storage for created Shapes
+    *   @return amount of added objects
+    */
+  inline unsigned tileLevel(pe::PhysicsWorld& world, const std::vector<LevelObject>& level, unsigned copies, std::deque<pe::Shape>& shapes) {
+    unsigned side = static_cast<unsigned>(std::ceil(std::sqrt(static_cast<float>(copies))));
+    float start = - TileSpacing * side / 2.f;
+    return tileLevel(world, level, copies, shapes, side, pe::Vector2f(start, start));
+  }
+
+  /**
+    *   @brief Measure average PhysicsWorld update time
+    *   @param world PhysicsWorld to be updated
+    *   @param steps how many updates are measured
+    *   @return milliseconds per update
+    */
+  inline double timeSteps(pe::PhysicsWorld& world, unsigned steps) {
+    Timer timer;
+    for (unsigned i = 0; i < steps; i++) {
+      world.update();
+    }
+    return timer.elapsed() / steps;
+  }
+
+} // end of namespace bench
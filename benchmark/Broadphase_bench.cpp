@@ -0,0 +1,103 @@
+/**
+  *   @file Broadphase_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark comparing Broadphase implementations
+  *   @details Uniform, clustered and mixed size scenes are simulated with each
+  *   BroadphaseType. Usage: ./Broadphase_bench.exe [objects] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+#include <random>
+
+/**
+  *   @namespace Scene
+  *   @brief Used to avoid namespace collisions with function names
+  */
+namespace Scene {
+  /**
+    *   @enum Scene
+    *   @brief Object distribution of the benchmark scene
+    */
+  enum Scene {
+    Uniform, /**< Small objects spread evenly over the world */
+    Clustered, /**< Small objects in a few dense clusters */
+    Mixed /**< Tiled many_objects level, debris and big static blocks */
+  };
+} // end of namespace Scene
+
+/**
+  *   @brief Fill PhysicsWorld with random objects
+  *   @param world PhysicsWorld where objects are added
+  *   @param scene Scene::Uniform or Scene::Clustered
+  *   @param amount how many objects are created
+  *   @param shapes storage for created Shapes
+  */
+void randomScene(pe::PhysicsWorld& world, enum Scene::Scene scene, unsigned amount, std::deque<pe::Shape>& shapes) {
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> uniform(-45000.f, 45000.f);
+  std::normal_distribution<float> cluster(0.f, 400.f);
+  std::uniform_real_distribution<float> size(5.f, 20.f);
+  std::vector<pe::Vector2f> centers;
+  for (int i = 0; i < 8; i++) centers.push_back(pe::Vector2f(uniform(random), uniform(random)));
+  for (unsigned i = 0; i < amount; i++) {
+    bench::LevelObject object;
+    object.type = i % 4 == 0 ? pe::ObjectType::StaticObject : pe::ObjectType::DynamicObject;
+    object.width = size(random);
+    object.height = size(random);
+    if (scene == Scene::Uniform) {
+      object.x = uniform(random);
+      object.y = uniform(random);
+    } else {
+      pe::Vector2f& center = centers[i % centers.size()];
+      object.x = center.getX() + cluster(random);
+      object.y = center.getY() + cluster(random);
+    }
+    world.addObject(bench::createObject(object, shapes, pe::Vector2f()));
+  }
+}
+
+/**
+  *   @brief Measure step time of one scene
+  *   @param type used BroadphaseType
+  *   @param scene scene to be simulated
+  *   @param amount objects in random scenes, level copies are amount / level size
+  *   @param steps measured updates
+  *   @return milliseconds per step
+  */
+double sceneStep(enum pe::BroadphaseType::BroadphaseType type, enum Scene::Scene scene, unsigned amount, unsigned steps) {
+  pe::PhysicsWorld world(type);
+  std::deque<pe::Shape> shapes;
+  if (scene == Scene::Mixed) {
+    std::vector<bench::LevelObject> level = bench::readLevel(bench::ManyObjects);
+    if (level.empty()) return 0.0;
+    unsigned copies = amount / level.size() > 0 ? amount / level.size() : 1;
+    bench::tileLevel(world, level, copies, shapes);
+  } else {
+    randomScene(world, scene, amount, shapes);
+  }
+  world.update();
+  return bench::timeSteps(world, steps);
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 20000);
+  unsigned steps = bench::argument(argc, argv, 2, 20);
+  const char* names[] = {"uniform", "clustered", "mixed"};
+  std::cout << "Broadphase benchmark, " << amount << " objects" << std::endl << std::endl;
+  std::cout << std::setw(12) << "scene" << std::setw(14) << "grid" << std::setw(14) << "hash grid"
+            << std::setw(16) << "sweep & prune" << std::setw(12) << "AABB tree" << "   (ms / step)" << std::endl;
+  for (int scene = Scene::Uniform; scene <= Scene::Mixed; scene++) {
+    enum Scene::Scene current = static_cast<enum Scene::Scene>(scene);
+    double grid = sceneStep(pe::BroadphaseType::Grid, current, amount, steps);
+    double hash = sceneStep(pe::BroadphaseType::HashGrid, current, amount, steps);
+    double sap = sceneStep(pe::BroadphaseType::SweepAndPrune, current, amount, steps);
+    double tree = sceneStep(pe::BroadphaseType::AABBTree, current, amount, steps);
+    std::cout << std::setw(12) << names[scene] << std::fixed << std::setprecision(3) << std::setw(14) << grid
+              << std::setw(14) << hash << std::setw(16) << sap << std::setw(12) << tree << std::endl;
+  }
+  return 0;
+}
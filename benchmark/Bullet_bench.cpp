@@ -0,0 +1,114 @@
+/**
+  *   @file Bullet_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for continuous collision detection of bullets
+  *   @details Small fast projectiles are shot at a thin static wall while
+  *   stacks of boxes keep the rest of the world busy. One simulated second is
+  *   run with the default step rate, with the projectiles flagged as bullets
+  *   and with doubled and quadrupled step rates. Cost is reported per
+  *   simulated second together with the amount of projectiles which tunnelled
+  *   through the wall. Sleeping is disabled to keep the stacks active.
+  *   Gravity matches the demo.
+  *   Usage: ./Bullet_bench.exe [projectiles] [speed] [stacks]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+
+const unsigned StackHeight = 4; /**< Boxes in one stack */
+const unsigned RowLength = 100; /**< Stacks on one ground strip */
+const float BoxSize = 20.f; /**< Width and height of one stacked box */
+const float Overlap = 0.5f; /**< Initial overlap of stacked boxes, keeps them in contact */
+const float ProjectileSize = 5.f; /**< Width and height of one projectile */
+const float WallWidth = 4.f; /**< Width of the wall the projectiles are shot at */
+const float Range = 300.f; /**< Distance from projectile start to the wall */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+
+/**
+  *   @brief Create stacks of boxes on static ground strips
+  *   @param world PhysicsWorld where objects are added
+  *   @param stacks amount of stacks
+  *   @param shapes storage for created Shapes
+  */
+void createStacks(pe::PhysicsWorld& world, unsigned stacks, std::deque<pe::Shape>& shapes) {
+  const float width = RowLength * 2.f * BoxSize;
+  for (unsigned row = 0; row * RowLength < stacks; row++) {
+    float y = row * (StackHeight + 3) * BoxSize;
+    bench::LevelObject ground{pe::ObjectType::StaticObject, -BoxSize, y, width + 2.f * BoxSize, BoxSize};
+    world.addObject(bench::createObject(ground, shapes, pe::Vector2f()));
+    for (unsigned i = row * RowLength; (i < stacks) && (i < (row + 1) * RowLength); i++) {
+      for (unsigned level = 0; level < StackHeight; level++) {
+        bench::LevelObject box{pe::ObjectType::DynamicObject, (i % RowLength) * 2.f * BoxSize, y - (level + 1) * (BoxSize - Overlap), BoxSize, BoxSize};
+        world.addObject(bench::createObject(box, shapes, pe::Vector2f()));
+      }
+    }
+  }
+}
+
+/**
+  *   @brief Create projectiles flying towards a wall left of the stacks
+  *   @param world PhysicsWorld where objects are added
+  *   @param amount amount of projectiles
+  *   @param speed horizontal velocity of the projectiles
+  *   @param bullets whether projectiles are swept
+  *   @param shapes storage for created Shapes
+  *   @param wall created wall is stored here
+  *   @return created projectiles
+  */
+std::vector<pe::PhysicsObject*> createProjectiles(pe::PhysicsWorld& world, unsigned amount, float speed, bool bullets,
+                                                  std::deque<pe::Shape>& shapes, pe::PhysicsObject*& wall) {
+  const float spacing = 3.f * ProjectileSize;
+  bench::LevelObject wall_object{pe::ObjectType::StaticObject, -1000.f, -spacing * amount, WallWidth, (amount + 1) * spacing};
+  wall = bench::createObject(wall_object, shapes, pe::Vector2f());
+  world.addObject(wall);
+  std::vector<pe::PhysicsObject*> projectiles;
+  for (unsigned i = 0; i < amount; i++) {
+    // start positions are staggered, so projectiles meet the wall at different phases of the step
+    bench::LevelObject projectile{pe::ObjectType::DynamicObject, -1000.f - Range - (i % 17) * 1.7f, -(i + 0.5f) * spacing, ProjectileSize, ProjectileSize};
+    pe::PhysicsObject* object = bench::createObject(projectile, shapes, pe::Vector2f());
+    object->setVelocity(pe::Vector2f(speed, 0.f));
+    object->setBullet(bullets);
+    world.addObject(object);
+    projectiles.push_back(object);
+  }
+  return projectiles;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 500);
+  float speed = bench::argument(argc, argv, 2, 3000);
+  unsigned stacks = bench::argument(argc, argv, 3, 2000);
+  pe::PhysicsProperties::GravityY = 100.f;
+  pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 0);
+  std::cout << "Bullet benchmark, " << amount << " projectiles at speed " << speed << ", "
+            << stacks * StackHeight << " stacked boxes" << std::endl << std::endl;
+  std::cout << std::setw(8) << "rate" << std::setw(10) << "bullets" << std::setw(12) << "ms / step"
+            << std::setw(16) << "ms / second" << std::setw(12) << "tunnelled" << std::endl;
+  struct Setup {
+    float rate;
+    bool bullets;
+  };
+  for (auto setup : {Setup{60.f, false}, Setup{60.f, true}, Setup{120.f, false}, Setup{240.f, false}}) {
+    pe::PhysicsWorld::setIterationAmount(setup.rate);
+    pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+    std::deque<pe::Shape> shapes;
+    createStacks(world, stacks, shapes);
+    pe::PhysicsObject* wall;
+    std::vector<pe::PhysicsObject*> projectiles = createProjectiles(world, amount, speed, setup.bullets, shapes, wall);
+    // one simulated second, projectiles reach the wall well before its end
+    unsigned steps = static_cast<unsigned>(setup.rate);
+    double ms = bench::timeSteps(world, steps);
+    unsigned tunnelled = 0;
+    for (auto projectile : projectiles) {
+      if (projectile->getMinPosition().getX() > wall->getMaxPosition().getX()) tunnelled++;
+    }
+    std::cout << std::setw(8) << static_cast<unsigned>(setup.rate) << std::setw(10) << (setup.bullets ? "yes" : "no")
+              << std::setw(12) << std::fixed << std::setprecision(3) << ms << std::setw(16) << ms * steps
+              << std::setw(12) << tunnelled << std::endl;
+  }
+  pe::PhysicsWorld::setIterationAmount(60.f);
+  return 0;
+}
@@ -0,0 +1,146 @@
+/**
+  *   @file Churn_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for spawning and removing short lived objects
+  *   @details Every step spawns projectiles with their own Shape and removes
+  *   projectiles which are older than their lifetime, like gameplay spawning
+  *   bullets and debris. Heap column allocates objects and Shapes with new and
+  *   removeObject deletes them, pool column uses PhysicsWorld factory methods.
+  *   Spawn and removal are timed apart from PhysicsWorld::update.
+  *   Allocation row creates and frees objects without PhysicsWorld.
+  *   Usage: ./Churn_bench.exe [spawns per step] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+
+const unsigned Lifetime = 30; /**< Steps a projectile lives */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+const float AreaSize = 20000.f; /**< Width and height of the spawn area */
+
+/**
+  *   @struct ChurnResult
+  *   @brief Timings of one churn run
+  */
+struct ChurnResult {
+  double churn = 0.0; /**< Nanoseconds per spawned and removed object */
+  double update = 0.0; /**< Milliseconds per PhysicsWorld update */
+};
+
+/**
+  *   @brief Run spawn and removal churn
+  *   @param spawns projectiles spawned per step
+  *   @param steps how many steps are simulated
+  *   @param pooled whether factory methods are used instead of new
+  *   @return timings
+  */
+ChurnResult churn(unsigned spawns, unsigned steps, bool pooled) {
+  pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+  std::vector<std::vector<pe::PhysicsObject*>> generations(Lifetime);
+  double churn_time = 0.0;
+  double update_time = 0.0;
+  unsigned churned = 0;
+  bench::Timer timer;
+  for (unsigned step = 0; step < steps + Lifetime; step++) {
+    std::vector<pe::PhysicsObject*>& generation = generations[step % Lifetime];
+    timer.reset();
+    // remove the oldest generation, its slots are reused by the new one
+    for (auto object : generation) {
+      pe::Shape* shape = object->getShape();
+      world.removeObject(object);
+      if (pooled) world.destroyShape(shape);
+      else delete shape;
+    }
+    generation.clear();
+    for (unsigned i = 0; i < spawns; i++) {
+      float size = 2.f + i % 4;
+      pe::DynamicObject* object;
+      if (pooled) object = world.createDynamicObject(world.createShape(size, size), 1.f);
+      else object = new pe::DynamicObject(new pe::Shape(size, size), 1.f);
+      // projectiles are scattered over the area and fly to different directions
+      unsigned seed = (step * spawns + i) * 2654435761u;
+      object->setPosition(pe::Vector2f(seed % 1000 * AreaSize / 1000.f, (seed >> 10) % 1000 * AreaSize / 1000.f));
+      object->setVelocity(pe::Vector2f((i % 7) * 60.f - 180.f, (i % 5) * 60.f - 120.f));
+      world.addObject(object);
+      generation.push_back(object);
+    }
+    // the first generations only fill the world
+    if (step >= Lifetime) {
+      churn_time += timer.elapsed();
+      churned += spawns;
+    }
+    timer.reset();
+    world.update();
+    if (step >= Lifetime) update_time += timer.elapsed();
+  }
+  for (auto& generation : generations) {
+    for (auto object : generation) {
+      pe::Shape* shape = object->getShape();
+      world.removeObject(object);
+      if (!pooled) delete shape;
+    }
+  }
+  ChurnResult result;
+  result.churn = churn_time * 1e6 / churned;
+  result.update = update_time / steps;
+  return result;
+}
+
+/**
+  *   @brief Time creating and freeing objects without PhysicsWorld
+  *   @param amount objects alive at the same time
+  *   @param rounds how many times all objects are recreated
+  *   @param pooled whether ObjectPools are used instead of new
+  *   @return nanoseconds per created and freed object
+  */
+double allocation(unsigned amount, unsigned rounds, bool pooled) {
+  pe::ObjectPool<pe::Shape> shapes;
+  pe::ObjectPool<pe::DynamicObject> objects;
+  std::vector<pe::DynamicObject*> alive(amount, nullptr);
+  bench::Timer timer;
+  for (unsigned round = 0; round < rounds; round++) {
+    for (unsigned i = 0; i < amount; i++) {
+      if (alive[i] != nullptr) {
+        pe::Shape* shape = alive[i]->getShape();
+        if (pooled) {
+          objects.destroy(alive[i]);
+          shapes.destroy(shape);
+        } else {
+          delete alive[i];
+          delete shape;
+        }
+      }
+      if (pooled) alive[i] = objects.create(shapes.create(4.f, 4.f), 1.f);
+      else alive[i] = new pe::DynamicObject(new pe::Shape(4.f, 4.f), 1.f);
+    }
+  }
+  double elapsed = timer.elapsed();
+  if (!pooled) {
+    for (auto object : alive) {
+      delete object->getShape();
+      delete object;
+    }
+  }
+  return elapsed * 1e6 / (static_cast<double>(amount) * rounds);
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned spawns = bench::argument(argc, argv, 1, 1000);
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  std::cout << "Spawn / remove churn, " << spawns << " projectiles per step living " << Lifetime
+            << " steps, " << steps << " steps" << std::endl << std::endl;
+  std::cout << std::setw(20) << "" << std::setw(12) << "heap" << std::setw(12) << "pool" << std::endl;
+  ChurnResult heap = churn(spawns, steps, false);
+  ChurnResult pool = churn(spawns, steps, true);
+  std::cout << std::fixed << std::setprecision(1) << std::setw(20) << "churn (ns / object)"
+            << std::setw(12) << heap.churn << std::setw(12) << pool.churn << std::endl;
+  std::cout << std::setprecision(3) << std::setw(20) << "update (ms / step)"
+            << std::setw(12) << heap.update << std::setw(12) << pool.update << std::endl;
+  unsigned amount = spawns * Lifetime;
+  std::cout << std::setprecision(1) << std::setw(20) << "alloc (ns / object)"
+            << std::setw(12) << allocation(amount, 20, false) << std::setw(12) << allocation(amount, 20, true) << std::endl;
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+  *   @file Colouring_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for coloured contact solving
+  *   @details One pile of boxes stands on a static ground. Neighbouring boxes
+  *   overlap, so the whole pile is one island which is solved by colours.
+  *   Step time is measured with every possible thread amount and without
+  *   colouring. Position checksum after the steps shows that the coloured
+  *   results don't depend on the amount of threads. Sleeping is disabled to
+  *   keep all contacts active. Gravity matches the demo.
+  *   Usage: ./Colouring_bench.exe [boxes] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+#include <thread>
+#include <cmath>
+
+const unsigned PileWidth = 500; /**< Boxes in one row of the pile */
+const float BoxSize = 20.f; /**< Width and height of one box */
+const float Overlap = 0.5f; /**< Initial overlap of neighbouring boxes, keeps them in contact */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+
+/**
+  *   @brief Create pile of boxes on a static ground
+  *   @param world PhysicsWorld where objects are added
+  *   @param boxes amount of boxes
+  *   @param shapes storage for created Shapes
+  *   @return created DynamicObjects
+  */
+std::vector<pe::PhysicsObject*> createPile(pe::PhysicsWorld& world, unsigned boxes, std::deque<pe::Shape>& shapes) {
+  const float step = BoxSize - Overlap;
+  bench::LevelObject ground{pe::ObjectType::StaticObject, -BoxSize, 0.f, PileWidth * step + 2.f * BoxSize, BoxSize};
+  world.addObject(bench::createObject(ground, shapes, pe::Vector2f()));
+  std::vector<pe::PhysicsObject*> pile;
+  for (unsigned i = 0; i < boxes; i++) {
+    bench::LevelObject box{pe::ObjectType::DynamicObject, (i % PileWidth) * step, -(i / PileWidth + 1.f) * step, BoxSize, BoxSize};
+    pile.push_back(bench::createObject(box, shapes, pe::Vector2f()));
+    world.addObject(pile.back());
+  }
+  return pile;
+}
+
+/**
+  *   @brief Sum positions of objects
+  *   @param objects summed objects
+  *   @return sum of coordinates
+  */
+double checksum(const std::vector<pe::PhysicsObject*>& objects) {
+  double sum = 0.0;
+  for (auto object : objects) sum += object->getPosition().getX() + object->getPosition().getY();
+  return sum;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned boxes = bench::argument(argc, argv, 1, 100000);
+  unsigned steps = bench::argument(argc, argv, 2, 20);
+  pe::PhysicsProperties::GravityY = 100.f;
+  pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 0);
+  unsigned limit = pe::ContactSolver::getColouringLimit();
+  std::cout << "Colouring benchmark, pile of " << boxes << " boxes" << std::endl << std::endl;
+  std::cout << std::setw(10) << "threads" << std::setw(10) << "coloured" << std::setw(10) << "islands"
+            << std::setw(12) << "contacts" << std::setw(14) << "ms / step" << std::setw(20) << "checksum" << std::endl;
+  for (unsigned threads = 0; threads <= std::thread::hardware_concurrency() + 1; threads++) {
+    // last row solves the pile in the added order
+    bool colouring = threads <= std::thread::hardware_concurrency();
+    pe::ContactSolver::setColouringLimit(colouring ? limit : 0);
+    pe::PhysicsWorld::setThreads(colouring ? threads : 0);
+    pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+    std::deque<pe::Shape> shapes;
+    std::vector<pe::PhysicsObject*> pile = createPile(world, boxes, shapes);
+    world.update(); // warm up, also creates pool threads
+    double ms = bench::timeSteps(world, steps);
+    std::cout << std::setw(10) << pe::PhysicsWorld::getThreads()
+              << std::setw(10) << (colouring ? "yes" : "no") << std::setw(10) << world.getIslandAmount()
+              << std::setw(12) << world.getContacts().size() << std::setw(14) << std::fixed << std::setprecision(3) << ms
+              << std::setw(20) << std::setprecision(4) << checksum(pile) << std::endl;
+  }
+  pe::ContactSolver::setColouringLimit(limit);
+  return 0;
+}
@@ -0,0 +1,86 @@
+/**
+  *   @file Contact_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for ContactCache
+  *   @details Rotated boxes are placed in touching pairs. Narrow phase column
+  *   times detectCollisions of all pairs without a cache, with a cache whose
+  *   pairs are unchanged and with a cache after every pair has moved, which
+  *   is the cost of a lookup that misses. Step column is a full PhysicsWorld
+  *   update of tiled demo levels, which also keeps the cache up to date.
+  *   Usage: ./Contact_bench.exe [pairs] [rounds]
+  */
+
+#include "Benchmark.hpp"
+#include "../include/CollisionDetection.hpp"
+#include "../include/ContactCache.hpp"
+#include <iomanip>
+
+/**
+  *   @brief Time detectCollisions of all pairs
+  *   @param pairs pairs to be checked
+  *   @param rounds how many times pairs are checked
+  *   @param cache ContactCache passed to detectCollisions
+  *   @param hits collided pairs of the latest round are stored here
+  *   @return milliseconds per round
+  */
+double timePairs(const std::vector<struct pe::ObjectPair>& pairs, unsigned rounds, const pe::ContactCache* cache,
+                 std::vector<std::pair<unsigned, struct pe::CollisionDetection::MTV>>& hits) {
+  bench::Timer timer;
+  for (unsigned round = 0; round < rounds; round++) {
+    hits.clear();
+    pe::CollisionDetection::detectCollisions(pairs.data(), pairs.size(), hits, cache);
+  }
+  return timer.elapsed() / rounds;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 100000);
+  unsigned rounds = bench::argument(argc, argv, 2, 20);
+  pe::Shape shape(20.f, 20.f);
+  std::vector<pe::DynamicObject*> objects;
+  std::vector<struct pe::ObjectPair> pairs;
+  for (unsigned i = 0; i < amount; i++) {
+    pe::DynamicObject* first = new pe::DynamicObject(&shape, 1.f);
+    pe::DynamicObject* second = new pe::DynamicObject(&shape, 1.f);
+    first->setPosition(pe::Vector2f(i * 100.f, 0.f));
+    second->setPosition(pe::Vector2f(i * 100.f + 10.f, 3.f));
+    first->getPhysics().angle = 0.1f + i % 7 * 0.1f;
+    second->getPhysics().angle = first->getPhysics().angle;
+    objects.push_back(first);
+    objects.push_back(second);
+    pairs.push_back(pe::ObjectPair{first, second});
+  }
+
+  std::vector<std::pair<unsigned, struct pe::CollisionDetection::MTV>> hits;
+  double plain = timePairs(pairs, rounds, nullptr, hits);
+  unsigned collided = hits.size();
+  pe::ContactCache cache;
+  cache.beginStep();
+  for (auto& hit : hits) cache.addContact(pairs[hit.first].first, pairs[hit.first].second, hit.second);
+  cache.endStep();
+  double cached = timePairs(pairs, rounds, &cache, hits);
+  if (hits.size() != collided) std::cout << "Cached results differ" << std::endl;
+  for (unsigned i = 1; i < objects.size(); i += 2) objects[i]->setPosition(objects[i]->getPosition() + pe::Vector2f(0.5f, 0.f));
+  double moved = timePairs(pairs, rounds, &cache, hits);
+
+  pe::PhysicsWorld world(pe::BroadphaseType::Grid, 500);
+  std::deque<pe::Shape> shapes;
+  std::vector<bench::LevelObject> level = bench::readLevel(bench::ManyObjects);
+  bench::tileLevel(world, level, 1600, shapes);
+  world.update();
+  double step = bench::timeSteps(world, rounds);
+
+  std::cout << "ContactCache, " << amount << " rotated box pairs (" << collided << " touching), " << rounds << " rounds"
+            << std::endl << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::setw(24) << "narrow phase, no cache" << std::setw(12) << plain << " ms" << std::endl;
+  std::cout << std::setw(24) << "unchanged pairs" << std::setw(12) << cached << " ms" << std::endl;
+  std::cout << std::setw(24) << "moved pairs" << std::setw(12) << moved << " ms" << std::endl;
+  std::cout << std::setw(24) << "world step" << std::setw(12) << step << " ms, "
+            << world.getContactEvents().size() << " events" << std::endl;
+  for (auto object : objects) delete object;
+  return 0;
+}
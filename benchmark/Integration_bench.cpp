@@ -0,0 +1,138 @@
+/**
+  *   @file Integration_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for BodyStore integration Kernels
+  *   @details Integrates the same bodies one object at a time with
+  *   DynamicObject::updatePhysics as PhysicsWorld did before BodyStore, and
+  *   with every supported BodyStore Kernel. Kernel column times integrate only,
+  *   full column also includes gathering and storing the objects in batches
+  *   like PhysicsWorld does. Deterministic results are checked to match updatePhysics.
+  *   Usage: ./Integration_bench.exe [bodies] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include "../include/BodyStore.hpp"
+#include <iomanip>
+
+const float Interval = 1.f / 60.f; /**< Time step */
+const unsigned BatchSize = 64; /**< Bodies integrated at once, PhysicsWorld::BodyBatchSize */
+
+/**
+  *   @brief Create DynamicObjects with varying state
+  *   @param amount how many objects are created
+  *   @param shape Shape of the objects
+  *   @return heap allocated objects
+  */
+std::vector<pe::DynamicObject*> createBodies(unsigned amount, pe::Shape* shape) {
+  std::vector<pe::DynamicObject*> objects;
+  for (unsigned i = 0; i < amount; i++) {
+    pe::DynamicObject* object = new pe::DynamicObject(shape, 1.f);
+    object->setPosition(pe::Vector2f(i % 1000 * 20.f, i / 1000 * 20.f));
+    object->setVelocity(pe::Vector2f(i % 7 * 10.f - 30.f, i % 5 * 10.f - 20.f));
+    object->setForce(pe::Vector2f(i % 3 * 100.f, 0.f));
+    object->getPhysics().resistance_counter = i % 2;
+    objects.push_back(object);
+  }
+  return objects;
+}
+
+/**
+  *   @brief Convert milliseconds to millions of bodies per second
+  */
+double rate(unsigned amount, unsigned steps, double milliseconds) {
+  return static_cast<double>(amount) * steps / (milliseconds * 1e3);
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 100000);
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  pe::Shape shape(10.f, 10.f);
+  std::cout << "Integration benchmark, " << amount << " bodies x " << steps << " steps" << std::endl << std::endl;
+
+  // per object update as PhysicsWorld did before BodyStore
+  std::vector<pe::DynamicObject*> reference = createBodies(amount, &shape);
+  std::vector<pe::PhysicsObject*> reference_moved;
+  bench::Timer timer;
+  for (unsigned step = 0; step < steps; step++) {
+    reference_moved.clear();
+    for (auto object : reference) {
+      pe::Vector2f position = object->getPhysics().position;
+      object->updatePhysics(Interval);
+      object->updateTransform();
+      if (object->getMoved() || !(object->getPhysics().position == position)) {
+        object->setMoved(true);
+        reference_moved.push_back(object);
+      }
+    }
+  }
+  std::cout << std::setw(26) << "per object updatePhysics" << std::fixed << std::setprecision(1)
+            << std::setw(10) << rate(amount, steps, timer.elapsed()) << " M bodies / s" << std::endl << std::endl;
+
+  std::cout << std::setw(10) << "kernel" << std::setw(16) << "mode" << std::setw(10) << "kernel"
+            << std::setw(10) << "full" << "   (M bodies / s)" << std::endl;
+  const char* names[] = {"scalar", "SSE", "AVX2"};
+  pe::Kernel::Kernel best = pe::BodyStore::getKernel();
+  for (auto kernel : {pe::Kernel::Scalar, pe::Kernel::SSE, pe::Kernel::AVX2}) {
+    if (!pe::BodyStore::setKernel(kernel)) {
+      std::cout << std::setw(10) << names[kernel] << "   not supported" << std::endl;
+      continue;
+    }
+    for (bool deterministic : {true, false}) {
+      pe::BodyStore::setDeterministic(deterministic);
+      std::vector<pe::DynamicObject*> objects = createBodies(amount, &shape);
+      std::vector<pe::PhysicsObject*> moved;
+      pe::BodyStore bodies;
+      // integrate only, objects are stored once at the end
+      for (auto object : objects) bodies.add(object, Interval);
+      timer.reset();
+      for (unsigned step = 0; step < steps; step++) bodies.integrate(Interval);
+      double integrate = timer.elapsed();
+      bodies.store(moved);
+      // full update like in PhysicsWorld, continues from the same state
+      timer.reset();
+      for (unsigned step = 0; step < steps; step++) {
+        moved.clear();
+        for (auto object : objects) {
+          bodies.add(object, Interval);
+          if (bodies.size() >= BatchSize) {
+            bodies.integrate(Interval);
+            bodies.store(moved);
+          }
+        }
+        bodies.integrate(Interval);
+        bodies.store(moved);
+      }
+      double full = timer.elapsed();
+      std::cout << std::setw(10) << names[kernel] << std::setw(16) << (deterministic ? "deterministic" : "fast")
+                << std::setw(10) << rate(amount, steps, integrate) << std::setw(10) << rate(amount, steps, full) << std::endl;
+      if (deterministic) {
+        // integrate only timing reused resistance multipliers, so compare fresh objects
+        std::vector<pe::DynamicObject*> check = createBodies(amount, &shape);
+        std::vector<pe::DynamicObject*> expected = createBodies(amount, &shape);
+        for (unsigned step = 0; step < 3; step++) {
+          for (auto object : check) bodies.add(object, Interval);
+          bodies.integrate(Interval);
+          bodies.store(moved);
+          for (auto object : expected) object->updatePhysics(Interval);
+        }
+        for (unsigned i = 0; i < amount; i++) {
+          if (!(check[i]->getPhysics().position == expected[i]->getPhysics().position) ||
+              !(check[i]->getPhysics().collision_velocity == expected[i]->getPhysics().collision_velocity)) {
+            std::cout << "Results differ from updatePhysics" << std::endl;
+            break;
+          }
+        }
+        for (auto object : check) delete object;
+        for (auto object : expected) delete object;
+      }
+      for (auto object : objects) delete object;
+    }
+  }
+  pe::BodyStore::setKernel(best);
+  pe::BodyStore::setDeterministic(true);
+  for (auto object : reference) delete object;
+  return 0;
+}
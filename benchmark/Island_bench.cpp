@@ -0,0 +1,74 @@
+/**
+  *   @file Island_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for contact islands
+  *   @details Stacks of boxes stand on static ground strips, so every stack is
+  *   one island. The top box of each stack is knocked down to give the solver
+  *   work. Step time is measured with every possible thread amount, sleeping
+  *   is disabled to keep all contacts active. Object mayhem demo level isn't
+  *   used: its objects fall at the same speed and never touch. Gravity
+  *   matches the demo.
+  *   Usage: ./Island_bench.exe [stacks] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+#include <thread>
+
+const unsigned StackHeight = 4; /**< Boxes in one stack */
+const unsigned RowLength = 100; /**< Stacks on one ground strip */
+const float BoxSize = 20.f; /**< Width and height of one box */
+const float Overlap = 0.5f; /**< Initial overlap of touching objects, keeps them in contact */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+
+/**
+  *   @brief Create stacks of boxes on static ground strips
+  *   @param world PhysicsWorld where objects are added
+  *   @param stacks amount of stacks
+  *   @param shapes storage for created Shapes
+  *   @return amount of boxes
+  */
+unsigned createScene(pe::PhysicsWorld& world, unsigned stacks, std::deque<pe::Shape>& shapes) {
+  const float width = RowLength * 2.f * BoxSize;
+  unsigned boxes = 0;
+  for (unsigned row = 0; row * RowLength < stacks; row++) {
+    float y = row * (StackHeight + 3) * BoxSize;
+    bench::LevelObject ground{pe::ObjectType::StaticObject, -BoxSize, y, width + 2.f * BoxSize, BoxSize};
+    world.addObject(bench::createObject(ground, shapes, pe::Vector2f()));
+    for (unsigned i = row * RowLength; (i < stacks) && (i < (row + 1) * RowLength); i++) {
+      for (unsigned level = 0; level < StackHeight; level++) {
+        bench::LevelObject box{pe::ObjectType::DynamicObject, (i % RowLength) * 2.f * BoxSize, y - (level + 1) * (BoxSize - Overlap), BoxSize, BoxSize};
+        pe::PhysicsObject* object = bench::createObject(box, shapes, pe::Vector2f());
+        if (level == StackHeight - 1) static_cast<pe::DynamicObject*>(object)->setVelocity(pe::Vector2f(0.f, 5.f));
+        world.addObject(object);
+        boxes++;
+      }
+    }
+  }
+  return boxes;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned stacks = bench::argument(argc, argv, 1, 5000);
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  pe::PhysicsProperties::GravityY = 100.f;
+  pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 0);
+  std::cout << "Island benchmark, " << stacks << " stacks of " << StackHeight << " boxes" << std::endl << std::endl;
+  std::cout << std::setw(10) << "threads" << std::setw(12) << "objects" << std::setw(12) << "islands"
+            << std::setw(12) << "contacts" << std::setw(14) << "ms / step" << std::endl;
+  for (unsigned threads = 0; threads <= std::thread::hardware_concurrency(); threads++) {
+    pe::PhysicsWorld::setThreads(threads);
+    pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+    std::deque<pe::Shape> shapes;
+    unsigned objects = createScene(world, stacks, shapes);
+    world.update(); // warm up, also creates pool threads
+    double ms = bench::timeSteps(world, steps);
+    std::cout << std::setw(10) << pe::PhysicsWorld::getThreads() << std::setw(12) << objects
+              << std::setw(12) << world.getIslandAmount() << std::setw(12) << world.getContacts().size()
+              << std::setw(14) << std::fixed << std::setprecision(3) << ms << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,129 @@
+/**
+  *   @file Layout_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark comparing row-major and Morton ordered PhysicsGrid Cells
+  *   @details Boxes are scattered over a grid of small Cells. Neighbour walk
+  *   visits the 3 x 3 neighbourhood of every Cell like update and collision
+  *   checks of straddling objects do. Collision phase checks all pairs inside
+  *   every Cell in collectCells order. Step column is a full PhysicsWorld update
+  *   of tiled demo levels.
+  *   Usage: ./Layout_bench.exe [objects] [rounds]
+  */
+
+#include "Benchmark.hpp"
+#include "../include/CollisionDetection.hpp"
+#include <iomanip>
+
+const int GridSize = 100000; /**< Width and height of the grid */
+const int CellSize = 100; /**< Size of one Cell */
+const float BoxSize = 40.f; /**< Width and height of the boxes */
+
+/**
+  *   @struct LayoutResult
+  *   @brief Timings of one Cell order in milliseconds per round
+  */
+struct LayoutResult {
+  double walk = 0.0; /**< Neighbour walk */
+  double collision = 0.0; /**< Pair checks inside Cells */
+  double step = 0.0; /**< PhysicsWorld update */
+  unsigned long checksum = 0; /**< Visited objects, must match between orders */
+};
+
+/**
+  *   @brief Visit 3 x 3 neighbourhood of every Cell
+  *   @param grid PhysicsGrid to be walked
+  *   @param cells Cells in collectCells order
+  *   @return amount of visited entities
+  */
+unsigned long walkNeighbours(const pe::PhysicsGrid& grid, const std::vector<pe::Cell<pe::PhysicsObject*>*>& cells) {
+  unsigned long visited = 0;
+  int32_t columns = grid.getColumns();
+  int32_t rows = grid.getRows();
+  for (auto cell : cells) {
+    for (int32_t y = std::max(0, cell->y - 1); y <= std::min(rows - 1, cell->y + 1); y++) {
+      for (int32_t x = std::max(0, cell->x - 1); x <= std::min(columns - 1, cell->x + 1); x++) {
+        visited += grid.getCell(x, y)->entities.size();
+      }
+    }
+  }
+  return visited;
+}
+
+/**
+  *   @brief Check all object pairs inside every Cell
+  *   @param cells Cells in collectCells order
+  *   @return amount of colliding pairs
+  */
+unsigned long checkCells(const std::vector<pe::Cell<pe::PhysicsObject*>*>& cells) {
+  unsigned long collisions = 0;
+  for (auto cell : cells) {
+    pe::PhysicsObject* const* entities = cell->entities.data();
+    unsigned size = cell->entities.size();
+    for (unsigned i = 0; i < size; i++) {
+      for (unsigned j = i + 1; j < size; j++) {
+        pe::CollisionDetection::MTV mtv;
+        if (pe::CollisionDetection::detectCollision(entities[i], entities[j], mtv)) collisions++;
+      }
+    }
+  }
+  return collisions;
+}
+
+/**
+  *   @brief Time one Cell order
+  *   @param order memory order of the Cells
+  *   @param amount how many boxes are added
+  *   @param rounds how many times each phase is timed
+  *   @return timings
+  */
+LayoutResult measure(enum pe::CellOrder::CellOrder order, unsigned amount, unsigned rounds) {
+  LayoutResult result;
+  pe::Shape shape(BoxSize, BoxSize);
+  {
+    pe::PhysicsGrid grid;
+    grid.addCells(GridSize, GridSize, CellSize, order);
+    for (unsigned i = 0; i < amount; i++) {
+      unsigned seed = i * 2654435761u;
+      pe::DynamicObject* object = new pe::DynamicObject(&shape, 1.f);
+      object->setPosition(pe::Vector2f(seed % 20000 * 4.f - 40000.f, (seed >> 15) % 20000 * 4.f - 40000.f));
+      grid.addObject(object);
+    }
+    std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+    grid.collectCells(cells, false);
+    bench::Timer timer;
+    for (unsigned round = 0; round < rounds; round++) result.checksum += walkNeighbours(grid, cells);
+    result.walk = timer.elapsed() / rounds;
+    timer.reset();
+    for (unsigned round = 0; round < rounds; round++) result.checksum += checkCells(cells);
+    result.collision = timer.elapsed() / rounds;
+  }
+  pe::PhysicsWorld::setCellOrder(order);
+  pe::PhysicsWorld world(pe::BroadphaseType::Grid, 500);
+  std::deque<pe::Shape> shapes;
+  std::vector<bench::LevelObject> level = bench::readLevel(bench::ManyObjects);
+  bench::tileLevel(world, level, 1600, shapes);
+  world.update();
+  result.step = bench::timeSteps(world, rounds);
+  return result;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 200000);
+  unsigned rounds = bench::argument(argc, argv, 2, 10);
+  std::cout << "PhysicsGrid Cell layout, " << amount << " boxes in " << (GridSize / CellSize) * (GridSize / CellSize)
+            << " Cells, " << rounds << " rounds" << std::endl << std::endl;
+  std::cout << std::setw(12) << "order" << std::setw(16) << "neighbour walk" << std::setw(12) << "collision"
+            << std::setw(12) << "step" << "   (ms)" << std::endl;
+  LayoutResult row = measure(pe::CellOrder::RowMajor, amount, rounds);
+  LayoutResult morton = measure(pe::CellOrder::Morton, amount, rounds);
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << std::setw(12) << "row-major" << std::setw(16) << row.walk << std::setw(12) << row.collision
+            << std::setw(12) << row.step << std::endl;
+  std::cout << std::setw(12) << "Morton" << std::setw(16) << morton.walk << std::setw(12) << morton.collision
+            << std::setw(12) << morton.step << std::endl;
+  if (row.checksum != morton.checksum) std::cout << "Results differ" << std::endl;
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+  *   @file Load_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for loading large levels
+  *   @details Generates a level csv file in demo_levels format, reads it and
+  *   inserts all objects to PhysicsWorld. Compares addObject calls one by one to
+  *   a single addObjects call. Parsing and object creation are timed apart from
+  *   insertion. The generated file is removed afterwards.
+  *   Usage: ./Load_bench.exe [objects]
+  */
+
+#include "Benchmark.hpp"
+#include <cstdio>
+#include <iomanip>
+
+const char* const LevelPath = "load_bench_level.csv"; /**< Generated level file */
+const int CellSize = 200; /**< Grid and SpatialHashGrid Cell size */
+const float AreaSize = 90000.f; /**< Width and height of the level, centered around origin inside the Grid */
+
+/**
+  *   @brief Write level csv file
+  *   @details Every tenth object is a static platform, the rest are boxes of
+  *   varying size scattered over the level
+  *   @param amount how many objects are written
+  */
+void writeLevel(unsigned amount) {
+  std::ofstream file(LevelPath);
+  for (unsigned i = 0; i < amount; i++) {
+    unsigned seed = i * 2654435761u;
+    float x = seed % 10000 * AreaSize / 10000.f - AreaSize / 2.f;
+    float y = (seed >> 14) % 10000 * AreaSize / 10000.f - AreaSize / 2.f;
+    if (i % 10 == 0) file << "StaticObject," << x << "," << y << ",100,30\n";
+    else file << "DynamicObject," << x << "," << y << "," << 10 + i % 20 << "," << 10 + i % 15 << "\n";
+  }
+}
+
+/**
+  *   @struct LoadResult
+  *   @brief Timings of one level load in milliseconds
+  */
+struct LoadResult {
+  double create = 0.0; /**< Creating objects */
+  double insert = 0.0; /**< Inserting objects to PhysicsWorld */
+  unsigned added = 0; /**< Objects added to PhysicsWorld */
+};
+
+/**
+  *   @brief Create objects of the level and insert them to PhysicsWorld
+  *   @param type Broadphase of the world
+  *   @param level objects returned by readLevel
+  *   @param bulk whether addObjects is used instead of addObject
+  *   @return timings
+  */
+LoadResult load(enum pe::BroadphaseType::BroadphaseType type, const std::vector<bench::LevelObject>& level, bool bulk) {
+  LoadResult result;
+  pe::PhysicsWorld world(type, CellSize);
+  std::deque<pe::Shape> shapes;
+  std::vector<pe::PhysicsObject*> objects;
+  objects.reserve(level.size());
+  bench::Timer timer;
+  for (auto& object : level) objects.push_back(bench::createObject(object, shapes, pe::Vector2f()));
+  result.create = timer.elapsed();
+  timer.reset();
+  if (bulk) {
+    result.added = world.addObjects(objects.data(), objects.size());
+  } else {
+    for (auto object : objects) {
+      if (world.addObject(object)) result.added++;
+    }
+  }
+  result.insert = timer.elapsed();
+  return result;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 1000000);
+  writeLevel(amount);
+  bench::Timer timer;
+  std::vector<bench::LevelObject> level = bench::readLevel(LevelPath);
+  double parse = timer.elapsed();
+  std::remove(LevelPath);
+  std::cout << "Level load, " << level.size() << " objects, parsed in " << std::fixed << std::setprecision(1)
+            << parse << " ms" << std::endl << std::endl;
+  std::cout << std::setw(16) << "broadphase" << std::setw(12) << "create" << std::setw(14) << "addObject"
+            << std::setw(14) << "addObjects" << "   (ms)" << std::endl;
+  const char* names[] = {"grid", "hash grid", "sweep & prune", "AABB tree"};
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+    LoadResult single = load(type, level, false);
+    LoadResult bulk = load(type, level, true);
+    std::cout << std::setw(16) << names[type] << std::setw(12) << single.create << std::setw(14) << single.insert
+              << std::setw(14) << bulk.insert << std::endl;
+    if (single.added != bulk.added) std::cout << "Added amounts differ" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+/**
+  *   @file Removal_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for removing many objects at once
+  *   @details Rows of debris boxes settle on static ground strips and fall
+  *   asleep. Each frame an explosion removes a block of neighbouring boxes
+  *   and the world is updated. Only removeObject calls are timed, they include
+  *   waking the sleeping neighbours of removed objects.
+  *   Usage: ./Removal_bench.exe [objects] [removed per frame]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+
+const unsigned RowLength = 100; /**< Boxes on one ground strip */
+const float BoxSize = 20.f; /**< Width and height of one box */
+const unsigned SettleSteps = 120; /**< Steps simulated before removing */
+const int CellSize = 200; /**< Grid and SpatialHashGrid Cell size */
+
+/**
+  *   @brief Create rows of boxes resting on static ground strips
+  *   @param world PhysicsWorld where objects are added
+  *   @param amount how many boxes are created
+  *   @param shape Shape of the boxes
+  *   @param ground_shape Shape of the ground strips
+  *   @return boxes row by row
+  */
+std::vector<pe::PhysicsObject*> createDebris(pe::PhysicsWorld& world, unsigned amount, pe::Shape* shape, pe::Shape* ground_shape) {
+  std::vector<pe::PhysicsObject*> boxes;
+  for (unsigned row = 0; row * RowLength < amount; row++) {
+    float y = row * 5.f * BoxSize - 20000.f;
+    pe::StaticObject* ground = world.createStaticObject(ground_shape);
+    ground->setPosition(pe::Vector2f(RowLength * BoxSize, y + BoxSize / 2.f));
+    world.addObject(ground);
+    for (unsigned i = row * RowLength; (i < amount) && (i < (row + 1) * RowLength); i++) {
+      pe::DynamicObject* box = world.createDynamicObject(shape, 1.f);
+      box->setPosition(pe::Vector2f((i % RowLength) * 2.f * BoxSize + BoxSize, y - BoxSize / 2.f));
+      world.addObject(box);
+      boxes.push_back(box);
+    }
+  }
+  return boxes;
+}
+
+/**
+  *   @brief Remove blocks of boxes frame by frame
+  *   @param type Broadphase of the world
+  *   @param amount how many boxes are created
+  *   @param per_frame how many boxes one explosion removes
+  *   @param sleeping sleeping objects before the first explosion are stored here
+  *   @return microseconds per removed object
+  */
+double explode(enum pe::BroadphaseType::BroadphaseType type, unsigned amount, unsigned per_frame, unsigned& sleeping) {
+  pe::PhysicsWorld world(type, CellSize);
+  pe::Shape* shape = world.createShape(BoxSize, BoxSize);
+  pe::Shape* ground_shape = world.createShape(RowLength * 2.f * BoxSize + 2.f * BoxSize, BoxSize);
+  std::vector<pe::PhysicsObject*> boxes = createDebris(world, amount, shape, ground_shape);
+  for (unsigned i = 0; i < SettleSteps; i++) world.update();
+  sleeping = world.getSleepingAmount();
+  double elapsed = 0.0;
+  unsigned removed = 0;
+  // explosions clear every other block so that survivors have sleeping neighbours to wake
+  for (unsigned begin = 0; begin + per_frame <= boxes.size(); begin += 2 * per_frame) {
+    bench::Timer timer;
+    for (unsigned i = begin; i < begin + per_frame; i++) world.removeObject(boxes[i]);
+    elapsed += timer.elapsed();
+    removed += per_frame;
+    world.update();
+  }
+  return removed > 0 ? elapsed * 1e3 / removed : 0.0;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 20000);
+  unsigned per_frame = bench::argument(argc, argv, 2, 2000);
+  pe::PhysicsProperties::GravityY = 100.f;
+  pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 60);
+  std::cout << "Bulk removal benchmark, " << amount << " boxes, " << per_frame << " removed per frame" << std::endl << std::endl;
+  std::cout << std::setw(16) << "broadphase" << std::setw(12) << "sleeping" << std::setw(14) << "removal"
+            << "   (us / object)" << std::endl;
+  const char* names[] = {"grid", "hash grid", "sweep & prune", "AABB tree"};
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+    unsigned sleeping = 0;
+    double removal = explode(type, amount, per_frame, sleeping);
+    std::cout << std::setw(16) << names[type] << std::setw(12) << sleeping << std::fixed << std::setprecision(3)
+              << std::setw(14) << removal << std::endl;
+  }
+  return 0;
+}
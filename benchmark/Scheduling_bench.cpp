@@ -0,0 +1,50 @@
+/**
+  *   @file Scheduling_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark comparing row partition and work-stealing scheduling
+  *   @details Objects are bunched to a single row of grid cells, which is the
+  *   worst case for row partition. Usage: ./Scheduling_bench.exe [level copies] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+#include <thread>
+
+/**
+  *   @brief Measure step time of a skewed scene
+  *   @param scheduling used Scheduling
+  *   @param copies how many times level is tiled
+  *   @param steps measured updates
+  *   @return milliseconds per step
+  */
+double skewedStep(enum pe::Scheduling::Scheduling scheduling, unsigned copies, unsigned steps) {
+  pe::PhysicsWorld::setScheduling(scheduling);
+  pe::PhysicsWorld world;
+  std::deque<pe::Shape> shapes;
+  std::vector<bench::LevelObject> level = bench::readLevel(bench::ObjectMayhem);
+  // 4 rows of copies, all inside one row of 5000 unit grid cells
+  unsigned columns = copies / 4 > 0 ? copies / 4 : 1;
+  bench::tileLevel(world, level, copies, shapes, columns, pe::Vector2f(- bench::TileSpacing * columns / 2.f, 100.f));
+  world.update();
+  return bench::timeSteps(world, steps);
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned copies = bench::argument(argc, argv, 1, 200);
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  std::cout << "Scheduling benchmark, skewed scene: " << bench::ObjectMayhem << " x " << copies
+            << " in one row of grid cells" << std::endl << std::endl;
+  std::cout << std::setw(10) << "threads" << std::setw(18) << "row partition" << std::setw(18) << "work stealing"
+            << "   (ms / step)" << std::endl;
+  for (unsigned threads = 0; threads <= std::thread::hardware_concurrency(); threads++) {
+    pe::PhysicsWorld::setThreads(threads);
+    double rows = skewedStep(pe::Scheduling::RowPartition, copies, steps);
+    double stealing = skewedStep(pe::Scheduling::WorkStealing, copies, steps);
+    std::cout << std::setw(10) << pe::PhysicsWorld::getThreads() << std::fixed << std::setprecision(3)
+              << std::setw(18) << rows << std::setw(18) << stealing << std::endl;
+  }
+  return 0;
+}
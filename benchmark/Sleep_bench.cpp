@@ -0,0 +1,76 @@
+/**
+  *   @file Sleep_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for sleeping DynamicObjects
+  *   @details Rows of boxes are placed on static ground strips and simulated
+  *   until they settle. Step time of the settled scene is compared with and
+  *   without sleeping. Gravity matches the demo. Boxes are not stacked,
+  *   Stacking_bench covers settling stacks.
+  *   Usage: ./Sleep_bench.exe [objects] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+
+const unsigned RowLength = 100; /**< Boxes on one ground strip */
+const float BoxSize = 20.f; /**< Width and height of one box */
+const unsigned SettleSteps = 120; /**< Steps simulated before timing */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+
+/**
+  *   @brief Create rows of boxes resting on static ground strips
+  *   @param world PhysicsWorld where objects are added
+  *   @param amount how many boxes are created
+  *   @param shapes storage for created Shapes
+  */
+void createScene(pe::PhysicsWorld& world, unsigned amount, std::deque<pe::Shape>& shapes) {
+  const float width = RowLength * 2.f * BoxSize;
+  for (unsigned row = 0; row * RowLength < amount; row++) {
+    float y = row * 5.f * BoxSize;
+    bench::LevelObject ground{pe::ObjectType::StaticObject, -BoxSize, y, width + 2.f * BoxSize, BoxSize};
+    world.addObject(bench::createObject(ground, shapes, pe::Vector2f()));
+    for (unsigned i = row * RowLength; (i < amount) && (i < (row + 1) * RowLength); i++) {
+      bench::LevelObject box{pe::ObjectType::DynamicObject, (i % RowLength) * 2.f * BoxSize, y - BoxSize, BoxSize, BoxSize};
+      world.addObject(bench::createObject(box, shapes, pe::Vector2f()));
+    }
+  }
+}
+
+/**
+  *   @brief Settle scene and measure step time
+  *   @param amount how many boxes are created
+  *   @param steps how many steps are timed
+  *   @param sleep_steps PhysicsWorld sleep steps, 0 disables sleeping
+  *   @param world_sleeping sleeping objects after settling are stored here
+  *   @return milliseconds per step
+  */
+double pileStep(unsigned amount, unsigned steps, unsigned sleep_steps, unsigned& world_sleeping) {
+  pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, sleep_steps);
+  pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+  std::deque<pe::Shape> shapes;
+  createScene(world, amount, shapes);
+  for (unsigned i = 0; i < SettleSteps; i++) world.update();
+  double step = bench::timeSteps(world, steps);
+  world_sleeping = world.getSleepingAmount();
+  return step;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 16000);
+  pe::PhysicsProperties::GravityY = 100.f;
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  std::cout << "Settled scene benchmark, " << RowLength << " boxes per ground strip" << std::endl << std::endl;
+  std::cout << std::setw(10) << "objects" << std::setw(12) << "sleeping" << std::setw(14) << "no sleep"
+            << std::setw(12) << "sleep" << "   (ms / step)" << std::endl;
+  for (unsigned size = amount / 8 > 0 ? amount / 8 : 1; size <= amount; size *= 2) {
+    unsigned sleeping = 0;
+    double awake = pileStep(size, steps, 0, sleeping);
+    double asleep = pileStep(size, steps, 60, sleeping);
+    std::cout << std::setw(10) << size << std::setw(12) << sleeping << std::fixed << std::setprecision(3)
+              << std::setw(14) << awake << std::setw(12) << asleep << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+/**
+  *   @file Stacking_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for ContactSolver stacks
+  *   @details Columns of boxes are dropped on a static ground so that each box
+  *   falls on the one below it. Scene is simulated until every box sleeps,
+  *   with and without warm starting at two step rates. Rest column is the
+  *   amount of steps needed, iterations the mean velocity iterations per step
+  *   and error the largest distance of a box from its place on top of the
+  *   bottom box of its column.
+  *   Gravity matches the demo.
+  *   Usage: ./Stacking_bench.exe [columns] [height]
+  */
+
+#include "Benchmark.hpp"
+#include "../include/ContactSolver.hpp"
+#include <iomanip>
+#include <cmath>
+
+const float BoxSize = 20.f; /**< Width and height of one box */
+const float Gap = 1.f; /**< Space left below each box */
+const unsigned MaxSteps = 3000; /**< Steps simulated at most */
+const int CellSize = 200; /**< SpatialHashGrid Cell size */
+
+/**
+  *   @struct StackResult
+  *   @brief Result of one settled scene
+  */
+struct StackResult {
+  unsigned steps; /**< Steps until every box sleeps, MaxSteps if they don't */
+  double iterations; /**< Mean velocity iterations per step */
+  double step; /**< Milliseconds per step */
+  float error; /**< Largest distance from the stacked position */
+};
+
+/**
+  *   @brief Drop columns and simulate until they rest
+  *   @param columns amount of columns
+  *   @param height boxes per column
+  *   @return StackResult
+  */
+struct StackResult settle(unsigned columns, unsigned height) {
+  pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, CellSize);
+  std::deque<pe::Shape> shapes;
+  bench::LevelObject ground{pe::ObjectType::StaticObject, -BoxSize, 0.f, columns * 2.f * BoxSize + 2.f * BoxSize, BoxSize};
+  world.addObject(bench::createObject(ground, shapes, pe::Vector2f()));
+  std::vector<pe::PhysicsObject*> boxes;
+  for (unsigned column = 0; column < columns; column++) {
+    for (unsigned i = 0; i < height; i++) {
+      bench::LevelObject box{pe::ObjectType::DynamicObject, column * 2.f * BoxSize, -(BoxSize + Gap) * (i + 1), BoxSize, BoxSize};
+      pe::PhysicsObject* object = bench::createObject(box, shapes, pe::Vector2f());
+      world.addObject(object);
+      boxes.push_back(object);
+    }
+  }
+  struct StackResult result{0, 0.0, 0.0, 0.f};
+  unsigned long iterations = 0;
+  bench::Timer timer;
+  while ((world.getSleepingAmount() < boxes.size()) && (result.steps < MaxSteps)) {
+    world.update();
+    iterations += world.getSolverIterations();
+    result.steps++;
+  }
+  result.step = timer.elapsed() / result.steps;
+  result.iterations = static_cast<double>(iterations) / result.steps;
+  for (unsigned i = 0; i < boxes.size(); i++) {
+    // boxes are compared with the bottom box of their column
+    pe::Vector2f stacked = boxes[i - i % height]->getPosition() - pe::Vector2f(0.f, BoxSize * (i % height));
+    result.error = std::max(result.error, (boxes[i]->getPosition() - stacked).getLength());
+  }
+  return result;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned columns = bench::argument(argc, argv, 1, 50);
+  unsigned height = bench::argument(argc, argv, 2, 10);
+  pe::PhysicsProperties::GravityY = 100.f;
+  std::cout << "Stacking benchmark, " << columns << " columns of " << height << " boxes, "
+            << pe::ContactSolver::getVelocityIterations() << " velocity iterations at most" << std::endl << std::endl;
+  std::cout << std::setw(8) << "rate" << std::setw(8) << "warm" << std::setw(10) << "rest" << std::setw(14) << "iterations"
+            << std::setw(14) << "ms / step" << std::setw(10) << "error" << std::endl;
+  for (float rate : {60.f, 30.f}) {
+    pe::PhysicsWorld::setIterationAmount(rate);
+    for (bool warm : {false, true}) {
+      pe::ContactSolver::setWarmStarting(warm);
+      struct StackResult result = settle(columns, height);
+      std::cout << std::setw(8) << rate << std::setw(8) << (warm ? "on" : "off") << std::setw(10);
+      if (result.steps < MaxSteps) std::cout << result.steps;
+      else std::cout << "-";
+      std::cout << std::fixed << std::setprecision(2) << std::setw(14) << result.iterations
+                << std::setprecision(3) << std::setw(14) << result.step << std::setw(10) << result.error << std::endl;
+      std::cout.unsetf(std::ios_base::fixed);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+/**
+  *   @file Straddle_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for objects overlapping multiple grid cells
+  *   @details Half of the objects are placed on grid cell borders. Step time
+  *   is compared to the cost of the old loose cell scan, where every object
+  *   overlapping multiple cells was checked against all other objects each step.
+  *   Usage: ./Straddle_bench.exe [objects] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include <iomanip>
+#include <random>
+
+const float CellSize = 5000.f; /**< PhysicsWorld default grid cell size */
+
+/**
+  *   @brief Create scene where every other object straddles a cell border
+  *   @param world PhysicsWorld where objects are added
+  *   @param amount how many objects are created
+  *   @param shapes storage for created Shapes
+  *   @param objects created objects are appended here
+  *   @return amount of straddling objects
+  */
+unsigned createScene(pe::PhysicsWorld& world, unsigned amount, std::deque<pe::Shape>& shapes, std::vector<pe::PhysicsObject*>& objects) {
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> position(-45000.f, 45000.f);
+  std::uniform_int_distribution<int> border(-8, 8);
+  unsigned straddling = 0;
+  for (unsigned i = 0; i < amount; i++) {
+    bench::LevelObject object;
+    object.width = 40.f;
+    object.height = 40.f;
+    object.x = position(random);
+    object.y = position(random);
+    if (i % 2 == 0) {
+      // static object centered on a vertical cell border
+      object.type = pe::ObjectType::StaticObject;
+      object.x = CellSize * border(random) - object.width / 2.f;
+      straddling++;
+    } else {
+      object.type = pe::ObjectType::DynamicObject;
+    }
+    pe::PhysicsObject* physObject = bench::createObject(object, shapes, pe::Vector2f());
+    if (world.addObject(physObject)) objects.push_back(physObject);
+  }
+  return straddling;
+}
+
+/**
+  *   @brief Measure the old loose cell scan
+  *   @details Each straddling object is tested against every other object
+  *   @param objects all objects of the scene
+  *   @return milliseconds per scan
+  */
+double looseScan(const std::vector<pe::PhysicsObject*>& objects) {
+  bench::Timer timer;
+  unsigned collisions = 0;
+  for (unsigned i = 0; i < objects.size(); i += 2) {
+    for (auto object : objects) {
+      struct pe::CollisionDetection::MTV mtv;
+      if ((object != objects[i]) && pe::CollisionDetection::detectCollision(objects[i], object, mtv)) collisions++;
+    }
+  }
+  double elapsed = timer.elapsed();
+  // prevent the loop from being optimized away
+  if (collisions == objects.size() * objects.size()) std::cout << collisions << std::endl;
+  return elapsed;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned amount = bench::argument(argc, argv, 1, 8000);
+  unsigned steps = bench::argument(argc, argv, 2, 20);
+  std::cout << "Straddling objects benchmark, every other object on a cell border" << std::endl << std::endl;
+  std::cout << std::setw(10) << "objects" << std::setw(12) << "straddling" << std::setw(14) << "step"
+            << std::setw(20) << "loose cell scan" << "   (ms)" << std::endl;
+  for (unsigned size = amount / 8 > 0 ? amount / 8 : 1; size <= amount; size *= 2) {
+    pe::PhysicsWorld world;
+    std::deque<pe::Shape> shapes;
+    std::vector<pe::PhysicsObject*> objects;
+    unsigned straddling = createScene(world, size, shapes, objects);
+    world.update();
+    double step = bench::timeSteps(world, steps);
+    double scan = looseScan(objects);
+    std::cout << std::setw(10) << objects.size() << std::setw(12) << straddling << std::fixed << std::setprecision(3)
+              << std::setw(14) << step << std::setw(20) << scan << std::endl;
+  }
+  return 0;
+}
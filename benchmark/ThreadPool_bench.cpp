@@ -0,0 +1,77 @@
+/**
+  *   @file ThreadPool_bench.cpp
+  *   @author Lauri Westerholm
+  *   @brief Benchmark for persistent ThreadPool used by PhysicsWorld
+  *   @details Usage: ./ThreadPool_bench.exe [level copies] [steps]
+  */
+
+#include "Benchmark.hpp"
+#include "../include/ThreadPool.hpp"
+#include <iomanip>
+#include <thread>
+
+/**
+  *   @brief Measure PhysicsWorld step time with every possible thread amount
+  *   @param path demo level path
+  *   @param copies how many times level is tiled
+  *   @param steps measured updates
+  */
+void stepTimes(const char* path, unsigned copies, unsigned steps) {
+  std::vector<bench::LevelObject> level = bench::readLevel(path);
+  std::cout << std::endl << path << " x " << copies << std::endl;
+  std::cout << std::setw(10) << "threads" << std::setw(12) << "objects" << std::setw(14) << "ms / step" << std::endl;
+  for (unsigned threads = 0; threads <= std::thread::hardware_concurrency(); threads++) {
+    pe::PhysicsWorld::setThreads(threads);
+    pe::PhysicsWorld world;
+    std::deque<pe::Shape> shapes;
+    unsigned objects = bench::tileLevel(world, level, copies, shapes);
+    world.update(); // warm up, also creates pool threads
+    double ms = bench::timeSteps(world, steps);
+    std::cout << std::setw(10) << pe::PhysicsWorld::getThreads() << std::setw(12) << objects
+              << std::setw(14) << std::fixed << std::setprecision(3) << ms << std::endl;
+  }
+}
+
+/**
+  *   @brief Compare thread dispatch cost of spawning threads and ThreadPool::run
+  *   @param rounds how many dispatches are measured
+  */
+void dispatchOverhead(unsigned rounds) {
+  unsigned workers = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
+  std::cout << "Dispatch overhead, " << workers << " worker threads, " << rounds << " rounds" << std::endl;
+
+  bench::Timer timer;
+  for (unsigned i = 0; i < rounds; i++) {
+    std::vector<std::thread> threads;
+    for (unsigned j = 0; j < workers; j++) {
+      threads.push_back(std::thread([] {}));
+    }
+    for (auto& thread : threads) thread.join();
+  }
+  double spawn = timer.elapsed() * 1000.0 / rounds;
+
+  pe::ThreadPool pool(workers);
+  std::function<void(unsigned)> job = [] (unsigned) {};
+  timer.reset();
+  for (unsigned i = 0; i < rounds; i++) {
+    pool.run(job);
+  }
+  double run = timer.elapsed() * 1000.0 / rounds;
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "  spawn + join:   " << spawn << " us / phase" << std::endl;
+  std::cout << "  ThreadPool run: " << run << " us / phase" << std::endl;
+}
+
+/**
+  *   @brief Benchmark main
+  */
+int main(int argc, char** argv) {
+  unsigned copies = bench::argument(argc, argv, 1, 400);
+  unsigned steps = bench::argument(argc, argv, 2, 100);
+  std::cout << "ThreadPool benchmark" << std::endl << std::endl;
+  dispatchOverhead(2000);
+  stepTimes(bench::ManyObjects, copies, steps);
+  stepTimes(bench::ObjectMayhem, copies, steps);
+  return 0;
+}
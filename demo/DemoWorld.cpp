@@ -60,7 +60,7 @@ void DemoWorld::update() {
     object->updatePosition();
   }
   //int num = 0;
-  std::list<struct pe::Collided>& collided = physWorld.getCollided();
+  std::vector<struct pe::Collided>& collided = physWorld.getContacts();
   for (auto it = collided.begin(); it != collided.end(); it++) {
     //num++;
     // remove collided if removal true
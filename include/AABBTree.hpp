@@ -0,0 +1,222 @@
+/**
+  *   @file AABBTree.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class AABBTree
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "DynamicObject.hpp"
+#include "StaticObject.hpp"
+#include "Broadphase.hpp"
+#include "ObjectBuckets.hpp"
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class AABBTree
+    *   @brief Broadphase which stores objects to a dynamic bounding volume tree
+    *   @details Each object is a leaf with a fat box: object bounds grown by
+    *   FatMargin and stretched towards the object velocity. Object is reinserted
+    *   only when it leaves its fat box, so slowly moving objects don't change
+    *   the tree. Inserts choose the sibling with the smallest perimeter growth
+    *   and the tree is kept balanced with rotations. Objects are also stored
+    *   to ObjectBuckets which are used as Cells when objects are updated.
+    *   AABBTree takes ownership of PhysicsObjects
+    */
+  class AABBTree: public Broadphase
+  {
+    public:
+      static constexpr float FatMargin = 5.f; /**< Fat box growth on every side */
+      static constexpr float VelocityFactor = 0.1f; /**< Fat box is stretched by velocity * VelocityFactor */
+
+      /**
+        *   @brief Empty constructor
+        */
+      AABBTree();
+
+      /**
+        *   @brief Deconstructor
+        *   @details Deletes all PhysicsObjects
+        */
+      virtual ~AABBTree();
+
+      /**
+        *   @brief Copy constructor, makes a hard copy
+        *   @param tree AABBTree to be copied
+        */
+      AABBTree(const AABBTree& tree);
+
+      /**
+        *   @brief Assignment operator, makes a hard copy
+        *   @param tree AABBTree to be copied
+        *   @return reference to this
+        */
+      AABBTree& operator=(const AABBTree& tree);
+
+      /**
+        *   @brief Make a hard copy of AABBTree
+        *   @return new AABBTree, caller takes ownership
+        */
+      virtual Broadphase* clone() const override;
+
+      /**
+        *   @brief Insert PhysicsObject to tree
+        *   @param object to be added
+        *   @return true, object can always be added
+        */
+      virtual bool addObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Remove PhysicsObject and delete it
+        *   @param object to be removed
+        *   @return true if object found and removed, otherwise false
+        */
+      virtual bool removeObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Reinsert listed objects which have left their fat boxes
+        *   @param moved objects whose position may have changed
+        */
+      virtual void moveObjects(const std::vector<PhysicsObject*>& moved) override;
+      using Broadphase::moveObjects;
+
+      /**
+        *   @brief Append bucket Cells to cells
+        *   @param cells vector where Cells are appended
+        *   @param active_only if true, only buckets containing DynamicObjects are appended
+        */
+      virtual void collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) override;
+
+      /**
+        *   @brief Append pairs with overlapping fat boxes to pairs
+        *   @details Tree is queried with fat box of each active object, pairs
+        *   where neither object is active are never produced
+        *   @param pairs vector where pairs are appended
+        *   @return true, AABBTree always produces pairs
+        */
+      virtual bool collectPairs(std::vector<struct ObjectPair>& pairs) override;
+
+      /**
+        *   @brief Find objects whose bounds overlap region
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      virtual void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) override;
+
+      /**
+        *   @brief Find objects whose bounds a line segment hits
+        *   @param from start point of the segment
+        *   @param to end point of the segment
+        *   @param objects found objects are appended here, the closest first
+        */
+      virtual void queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects) override;
+
+      /**
+        *   @brief Get amount of objects
+        *   @return amount of leaves
+        */
+      inline unsigned getObjectAmount() const {
+        return leaves;
+      }
+
+      /**
+        *   @brief Get tree height
+        *   @return height of the root, -1 for empty tree
+        */
+      inline int getHeight() const {
+        return root == AABBTree::NullNode ? -1 : nodes[root].height;
+      }
+
+    private:
+      static const int32_t NullNode = -1; /**< Marks missing node */
+
+      /**
+        *   @struct Node
+        *   @brief Leaf or internal node of the tree
+        *   @details Free nodes are linked by parent
+        */
+      struct Node {
+        Vector2f min; /**< smallest corner of the (fat) box */
+        Vector2f max; /**< biggest corner of the (fat) box */
+        PhysicsObject* object = nullptr; /**< Object of leaf node, nullptr for internal nodes */
+        int32_t parent = AABBTree::NullNode; /**< Parent node, next free node for free nodes */
+        int32_t child1 = AABBTree::NullNode; /**< 1st child, NullNode for leaves */
+        int32_t child2 = AABBTree::NullNode; /**< 2nd child, NullNode for leaves */
+        int32_t height = 0; /**< 0 for leaves, -1 for free nodes */
+      };
+
+      /**
+        *   @brief Take node from free list or allocate a new one
+        *   @return node index
+        *   @remark May reallocate nodes, references to nodes are invalidated
+        */
+      int32_t AllocateNode();
+
+      /**
+        *   @brief Return node to free list
+        *   @param index node to be freed
+        */
+      void FreeNode(int32_t index);
+
+      /**
+        *   @brief Compute fat box of object to leaf
+        *   @param leaf leaf node index
+        */
+      void FatBounds(int32_t leaf);
+
+      /**
+        *   @brief Insert leaf to tree
+        *   @param leaf leaf node index
+        */
+      void InsertLeaf(int32_t leaf);
+
+      /**
+        *   @brief Remove leaf from tree, leaf node itself is not freed
+        *   @param leaf leaf node index
+        */
+      void RemoveLeaf(int32_t leaf);
+
+      /**
+        *   @brief Refit boxes and heights from node to root, rotating on the way
+        *   @param index first node to be refitted
+        */
+      void Refit(int32_t index);
+
+      /**
+        *   @brief Rotate node if its subtrees are unbalanced
+        *   @param a node index
+        *   @return index of the node which replaced a
+        */
+      int32_t Balance(int32_t a);
+
+      /**
+        *   @brief Delete all PhysicsObjects and nodes
+        */
+      void Clear();
+
+      /**
+        *   @brief Copy objects, allocates new PhysicsObjects
+        *   @param tree AABBTree to be copied
+        */
+      void Copy(const AABBTree& tree);
+
+      std::vector<Node> nodes; /**< All nodes, PhysicsObject proxy is the index of its leaf */
+      int32_t root = AABBTree::NullNode; /**< Root node */
+      int32_t free_node = AABBTree::NullNode; /**< First free node */
+      unsigned leaves = 0; /**< Amount of leaves */
+      ObjectBuckets buckets; /**< Leaf index selects the bucket */
+      std::vector<int32_t> stack; /**< Traversal stack, reused by collectPairs */
+  };
+
+} // end of namespace pe
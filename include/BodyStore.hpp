@@ -0,0 +1,204 @@
+/**
+  *   @file BodyStore.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class BodyStore
+  */
+
+#pragma once
+
+#include "DynamicObject.hpp"
+#include <vector>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @namespace Kernel
+    *   @brief Used to avoid namespace collisions with BodyStore method names
+    */
+  namespace Kernel {
+    /**
+      *   @enum Kernel
+      *   @brief Instruction set used by BodyStore::integrate
+      */
+    enum Kernel {
+      Scalar, /**< One body at a time, available everywhere */
+      SSE, /**< 4 bodies per instruction, x86 only */
+      AVX2 /**< 8 bodies per instruction, x86 CPUs with AVX2 only */
+    };
+  } // end of namespace Kernel
+
+  /**
+    *   @class BodyStore
+    *   @brief Structure of arrays storage for integrating DynamicObjects
+    *   @details PhysicsWorld gathers awake DynamicObjects to a BodyStore in
+    *   small batches, integrates each batch in one linear loop over contiguous
+    *   float arrays and stores the results back to the objects. Arrays keep
+    *   their size between batches. Integration matches
+    *   DynamicObject::updatePhysics exactly. PhysicsObjects remain the owners
+    *   of the state, so PhysicsProperties can be used between updates as before.
+    *   By default the best Kernel supported by the CPU is selected at runtime.
+    *   In deterministic mode (default) all Kernels produce bitwise identical
+    *   results. BodyStore doesn't own the objects
+    */
+  class BodyStore
+  {
+    public:
+      /**
+        *   @brief Select integration Kernel for all BodyStores
+        *   @param kernel Kernel to be used
+        *   @return true if Kernel is supported and selected, otherwise false
+        *   and the previous Kernel is kept
+        */
+      static bool setKernel(enum Kernel::Kernel kernel);
+
+      /**
+        *   @brief Get selected integration Kernel
+        *   @return ActiveKernel
+        */
+      static inline enum Kernel::Kernel getKernel() {
+        return ActiveKernel;
+      }
+
+      /**
+        *   @brief Check whether Kernel can be used on this CPU
+        *   @param kernel Kernel to be checked
+        *   @return true if supported, otherwise false
+        */
+      static bool isSupported(enum Kernel::Kernel kernel);
+
+      /**
+        *   @brief Set deterministic mode
+        *   @details Deterministic integration does the same operations in the
+        *   same order as DynamicObject::updatePhysics. Otherwise the division
+        *   by elapsed time is replaced by a multiplication and constant terms
+        *   are combined, which changes results in the last bits
+        *   @param deterministic true for bitwise identical results (default)
+        */
+      static void setDeterministic(bool deterministic);
+
+      /**
+        *   @brief Check deterministic mode
+        *   @return Deterministic
+        */
+      static inline bool getDeterministic() {
+        return Deterministic;
+      }
+
+      /**
+        *   @brief Empty constructor
+        */
+      BodyStore();
+
+      /**
+        *   @brief Add DynamicObject for the next integrate call
+        *   @details Copies object state to the arrays and calls
+        *   DynamicObject::beginUpdate. Resistance is resolved to multipliers so
+        *   that integration has no per object branches. Multipliers of the
+        *   previous resistance_factor are reused
+        *   @param object to be integrated
+        *   @param elapsed_time time step of the next integrate call
+        */
+      void add(DynamicObject* object, float elapsed_time);
+
+      /**
+        *   @brief Integrate all added bodies
+        *   @details Position is moved by velocity, acceloration and gravity,
+        *   velocity and acceloration are decreased by resistance and
+        *   collision_velocity is calculated from the position change
+        *   @param elapsed_time time elapsed from the previous update (in seconds),
+        *   must match the one passed to add
+        */
+      void integrate(float elapsed_time);
+
+      /**
+        *   @brief Store integrated state back to the objects and clear the store
+        *   @details Objects are flagged moved and appended to moved if their
+        *   position changed or they were already flagged. World space vertices
+        *   are refreshed
+        *   @param moved moved objects are appended here
+        */
+      void store(std::vector<PhysicsObject*>& moved);
+
+      /**
+        *   @brief Remove all bodies without storing them
+        */
+      void clear();
+
+      /**
+        *   @brief Get amount of bodies
+        *   @return amount of added bodies
+        */
+      inline unsigned size() const {
+        return amount;
+      }
+
+    private:
+      static enum Kernel::Kernel ActiveKernel; /**< Kernel used by integrate */
+      static bool Deterministic; /**< Whether results match DynamicObject::updatePhysics exactly */
+      static const unsigned MinCapacity = 64; /**< Array size after the first add */
+
+      /**
+        *   @brief Find the fastest supported Kernel
+        *   @return AVX2, SSE or Scalar
+        */
+      static enum Kernel::Kernel BestKernel();
+
+      /**
+        *   @brief Double the size of all arrays
+        *   @details Arrays are never shrunk, so add writes by index and
+        *   clear only resets amount
+        */
+      void Grow();
+
+      /**
+        *   @brief Integrate bodies [begin, end) one at a time
+        *   @param begin first body
+        *   @param end body after the last body
+        *   @param elapsed_time time step
+        */
+      void IntegrateScalar(unsigned begin, unsigned end, float elapsed_time);
+
+      /**
+        *   @brief Integrate bodies four at a time with SSE
+        *   @param end body after the last body
+        *   @param elapsed_time time step
+        *   @return first body which was not integrated
+        */
+      unsigned IntegrateSSE(unsigned end, float elapsed_time);
+
+      /**
+        *   @brief Integrate bodies eight at a time with AVX2
+        *   @param end body after the last body
+        *   @param elapsed_time time step
+        *   @return first body which was not integrated
+        */
+      unsigned IntegrateAVX2(unsigned end, float elapsed_time);
+
+    private:
+      unsigned amount = 0; /**< Amount of added bodies, arrays may be larger */
+      bool resistance_cached = false; /**< Whether cached resistance multipliers are valid */
+      float cached_time = 0.f; /**< elapsed_time of the cached multipliers */
+      float cached_resistance = 0.f; /**< resistance_factor of the cached multipliers */
+      float cached_velocity_factor = 1.f; /**< Cached velocity multiplier */
+      float cached_acceloration_factor = 1.f; /**< Cached acceloration multiplier */
+      std::vector<DynamicObject*> objects; /**< Objects matching array indices */
+      std::vector<float> position_x; /**< physics.position x */
+      std::vector<float> position_y; /**< physics.position y */
+      std::vector<float> velocity_x; /**< physics.velocity x */
+      std::vector<float> velocity_y; /**< physics.velocity y */
+      std::vector<float> acceloration_x; /**< physics.acceloration x */
+      std::vector<float> acceloration_y; /**< physics.acceloration y */
+      std::vector<float> delta_x; /**< Position change x of the latest integrate */
+      std::vector<float> delta_y; /**< Position change y of the latest integrate */
+      std::vector<float> collision_velocity_x; /**< physics.collision_velocity x */
+      std::vector<float> collision_velocity_y; /**< physics.collision_velocity y */
+      std::vector<float> velocity_resistance; /**< Velocity multiplier, 1 if resistance is not applied */
+      std::vector<float> acceloration_resistance; /**< Acceloration multiplier, 1 if resistance is not applied */
+  };
+
+} // end of namespace pe
@@ -0,0 +1,321 @@
+/**
+  *   @file Broadphase.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for abstract class Broadphase and struct Cell
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @namespace BroadphaseType
+    *   @brief Used to avoid namespace collisions with Broadphase class names
+    */
+  namespace BroadphaseType {
+    /**
+      *   @enum BroadphaseType
+      *   @brief Tells which Broadphase PhysicsWorld uses
+      */
+    enum BroadphaseType {
+      Grid, /**< PhysicsGrid, fixed size dense grid (default) */
+      HashGrid, /**< SpatialHashGrid, unbounded grid which allocates only occupied Cells */
+      SweepAndPrune, /**< SweepAndPrune, sorted endpoints, suits objects of varying sizes */
+      AABBTree /**< AABBTree, dynamic bounding volume tree, slowly moving objects are cheap */
+    };
+  } // end of namespace BroadphaseType
+
+
+  /**
+    *   @struct Cell
+    *   @brief struct representing one cell in Grid
+    */
+  template<class T>
+  struct Cell {
+    std::vector<T> entities; /**< Contiguous entities Cell contains, order changes when entities are removed */
+    bool active_cell = false; /**< Whether Cell is active or not */
+    unsigned dynamic_entities = 0; /**< Amount of DynamicObjects, Cell is active when not zero */
+    int32_t x = 0; /**< Cell x coordinate */
+    int32_t y = 0; /**< Cell y coordinate */
+  };
+
+
+  /**
+    *   @struct ObjectPair
+    *   @brief Candidate pair of PhysicsObjects found by Broadphase
+    */
+  struct ObjectPair {
+    PhysicsObject* first; /**< 1st object */
+    PhysicsObject* second; /**< 2nd object */
+  };
+
+
+  /**
+    *   @brief Check whether Cell is the home Cell of object
+    *   @details Object is stored to every Cell it overlaps. Home Cell is the
+    *   overlapped Cell with the smallest coordinates, so each object has exactly
+    *   one home Cell. Per object work is done only in the home Cell
+    *   @param cell Cell containing object
+    *   @param object PhysicsObject to be checked
+    *   @return true if cell is the home Cell of object, otherwise false
+    */
+  inline bool isHomeCell(const Cell<PhysicsObject*>* cell, PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    return (range.min_x == cell->x) && (range.min_y == cell->y);
+  }
+
+  /**
+    *   @brief Set CellRange of object
+    *   @details Reserves one slot index for every Cell of range. Must be set
+    *   before the object is inserted to the Cells
+    *   @param object PhysicsObject to be updated
+    *   @param range Cells the object is inserted to
+    */
+  inline void setCellRange(PhysicsObject* object, const CellRange& range) {
+    object->getCellRange() = range;
+    unsigned size = range.empty() ? 0 : (range.max_x - range.min_x + 1) * (range.max_y - range.min_y + 1);
+    object->getCellSlots().resize(size);
+  }
+
+  /**
+    *   @brief Get index of object inside Cell entities
+    *   @param cell Cell inside the CellRange of object
+    *   @param object PhysicsObject stored to cell
+    *   @return slot index as reference
+    */
+  inline uint32_t& cellSlot(const Cell<PhysicsObject*>* cell, PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    return object->getCellSlots()[(cell->y - range.min_y) * (range.max_x - range.min_x + 1) + (cell->x - range.min_x)];
+  }
+
+  /**
+    *   @brief Check whether object is stored to Cell
+    *   @param cell Cell inside the CellRange of object
+    *   @param object PhysicsObject to be checked
+    *   @return true if object is found from its slot, otherwise false
+    */
+  inline bool inCell(const Cell<PhysicsObject*>* cell, PhysicsObject* object) {
+    if (object->getCellSlots().empty()) return false;
+    uint32_t slot = cellSlot(cell, object);
+    return (slot < cell->entities.size()) && (cell->entities[slot] == object);
+  }
+
+  /**
+    *   @brief Append object to Cell
+    *   @details Object slot is stored so that it can be removed in O(1)
+    *   @param cell Cell inside the CellRange of object, see setCellRange
+    *   @param object PhysicsObject to be inserted
+    */
+  inline void insertToCell(Cell<PhysicsObject*>* cell, PhysicsObject* object) {
+    cellSlot(cell, object) = cell->entities.size();
+    cell->entities.push_back(object);
+    if (object->getObjectType() == ObjectType::DynamicObject) {
+      cell->dynamic_entities++;
+      cell->active_cell = true;
+    }
+  }
+
+  /**
+    *   @brief Remove object from Cell in O(1)
+    *   @details The last entity is moved to the slot of object
+    *   @param cell Cell containing object
+    *   @param object PhysicsObject to be removed
+    */
+  inline void removeFromCell(Cell<PhysicsObject*>* cell, PhysicsObject* object) {
+    uint32_t slot = cellSlot(cell, object);
+    PhysicsObject* last = cell->entities.back();
+    cell->entities[slot] = last;
+    cellSlot(cell, last) = slot;
+    cell->entities.pop_back();
+    if (object->getObjectType() == ObjectType::DynamicObject) {
+      cell->dynamic_entities--;
+      cell->active_cell = cell->dynamic_entities > 0;
+    }
+  }
+
+  /**
+    *   @brief Check whether object needs collision checks
+    *   @details Pairs where neither object is active are skipped
+    *   @param object PhysicsObject to be checked
+    *   @return true for awake DynamicObjects, otherwise false
+    */
+  inline bool isActive(PhysicsObject* object) {
+    return (object->getObjectType() == ObjectType::DynamicObject) && !object->isSleeping();
+  }
+
+  /**
+    *   @brief Check whether Cell owns the pair of objects
+    *   @details Objects overlapping the same Cells are found from multiple Cells.
+    *   The pair is owned by the first Cell of their overlapping range so that
+    *   the pair is checked only once
+    *   @param cell Cell containing both objects
+    *   @param object1 1st PhysicsObject
+    *   @param object2 2nd PhysicsObject
+    *   @return true if cell owns the pair, otherwise false
+    */
+  inline bool ownsPair(const Cell<PhysicsObject*>* cell, PhysicsObject* object1, PhysicsObject* object2) {
+    const CellRange& range1 = object1->getCellRange();
+    const CellRange& range2 = object2->getCellRange();
+    return (std::max(range1.min_x, range2.min_x) == cell->x) && (std::max(range1.min_y, range2.min_y) == cell->y);
+  }
+
+
+  /**
+    *   @class Broadphase
+    *   @brief Abstract container for PhysicsObjects of PhysicsWorld
+    *   @details Broadphase divides PhysicsObjects to Cells so that only objects
+    *   in the same Cell need to be checked against each other. Objects which
+    *   don't fit to a single Cell are stored to every Cell they overlap, see
+    *   isHomeCell and ownsPair. Broadphase takes
+    *   ownership of PhysicsObjects so their memory deletion is handled by it.
+    *   Do NOT delete objects memory elsewhere
+    */
+  class Broadphase
+  {
+    public:
+      /**
+        *   @brief Virtual deconstructor
+        */
+      virtual ~Broadphase() {}
+
+      /**
+        *   @brief Make a hard copy of Broadphase
+        *   @details PhysicsObjects are copied as well
+        *   @return new Broadphase of the same type, caller takes ownership
+        */
+      virtual Broadphase* clone() const = 0;
+
+      /**
+        *   @brief Add PhysicsObject to Broadphase
+        *   @param object to be added
+        *   @return true if object was added, otherwise false
+        */
+      virtual bool addObject(PhysicsObject* object) = 0;
+
+      /**
+        *   @brief Compute Broadphase location of objects before addObjects
+        *   @details May be called from many threads at once for disjoint
+        *   ranges: Broadphase is only read and only the objects are written.
+        *   Default implementation does nothing
+        *   @param objects objects passed later to addObjects
+        *   @param begin index of the first object
+        *   @param end index of the object which must not be located anymore
+        */
+      virtual void locateObjects(PhysicsObject* const*, unsigned, unsigned) const {}
+
+      /**
+        *   @brief Add many PhysicsObjects at once
+        *   @details locateObjects must have been called for all objects.
+        *   Default implementation calls addObject for each object
+        *   @param objects objects to be added
+        *   @param count amount of objects
+        *   @return amount of added objects
+        */
+      virtual unsigned addObjects(PhysicsObject* const* objects, unsigned count);
+
+      /**
+        *   @brief Remove PhysicsObject from Broadphase and delete it
+        *   @param object to be removed
+        *   @return true if object successfully removed, otherwise false
+        */
+      virtual bool removeObject(PhysicsObject* object) = 0;
+
+      /**
+        *   @brief Move listed objects to correct Cells
+        *   @details Only objects of moved are checked, so the cost depends on
+        *   the amount of moved objects instead of all objects
+        *   @param moved objects whose position may have changed, each object at most once
+        *   @remark This should be called only from PhysicsWorld update
+        */
+      virtual void moveObjects(const std::vector<PhysicsObject*>& moved) = 0;
+
+      /**
+        *   @brief Move all objects whose moved flag is set to correct Cells
+        *   @details Walks every Cell to find the moved objects. PhysicsWorld
+        *   uses moveObjects(moved) with the objects it updated instead
+        */
+      void moveObjects();
+
+      /**
+        *   @brief Append Cells to cells
+        *   @param cells vector where Cells are appended
+        *   @param active_only if true, only Cells containing DynamicObjects are appended
+        */
+      virtual void collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) = 0;
+
+      /**
+        *   @brief Append candidate pairs to pairs
+        *   @details Broadphases which don't divide objects spatially to Cells
+        *   produce the pairs directly. Then Cells are used only to divide
+        *   object updates between threads
+        *   @param pairs vector where pairs are appended
+        *   @return false if collisions should be checked by Cells (default), otherwise true
+        */
+      virtual bool collectPairs(std::vector<struct ObjectPair>&) {
+        return false;
+      }
+
+      /**
+        *   @brief Find objects whose bounds overlap region
+        *   @details Default implementation checks every object of every Cell
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      virtual void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects);
+
+      /**
+        *   @brief Find objects whose bounds a line segment hits
+        *   @details Default implementation checks every object of every Cell
+        *   @param from start point of the segment
+        *   @param to end point of the segment
+        *   @param objects found objects are appended here, the closest first
+        */
+      virtual void queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects);
+
+      /**
+        *   @brief Check whether line segment hits bounds
+        *   @param from start point of the segment
+        *   @param to end point of the segment
+        *   @param min smallest corner of the bounds
+        *   @param max biggest corner of the bounds
+        *   @param distance fraction [0, 1] of the segment where bounds are entered
+        *   @return true if segment hits, otherwise false
+        */
+      static bool RayHit(const Vector2f from, const Vector2f to, const Vector2f min, const Vector2f max, float& distance);
+
+      /**
+        *   @brief Append objects of hits to objects, the closest first
+        *   @param hits pairs of hit distance and object, sorted by this method
+        *   @param objects objects are appended here
+        */
+      static void AppendHits(std::vector<std::pair<float, PhysicsObject*>>& hits, std::vector<PhysicsObject*>& objects);
+
+      /**
+        *   @brief Append objects of one Cell overlapping region
+        *   @details Used by Broadphases which visit only the Cells of region.
+        *   Object overlapping many of those Cells is appended only from the
+        *   first Cell where its CellRange and region meet
+        *   @param cell Cell inside region
+        *   @param region Cells overlapped by the queried region
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      static void QueryCell(const Cell<PhysicsObject*>* cell, const CellRange& region, const Vector2f min, const Vector2f max,
+                            std::vector<PhysicsObject*>& objects);
+  };
+
+} // end of namespace pe
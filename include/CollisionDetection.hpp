@@ -10,9 +10,12 @@
 #include "../utils/Vector2.hpp"
 #include "PhysicsObject.hpp"
 #include "PhysicsProperties.hpp"
+#include "Broadphase.hpp"
 #include <vector>
 #include <deque>
 #include <limits>
+#include <utility>
+#include <cstdint>
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b)) /**< Macro for min value */
 
@@ -22,11 +25,14 @@
   */
 namespace pe {
 
+  class ContactCache;
+
   /**
     *   @namespace CollisionDetection
     *   @brief Contains all collision detection related functions
     *   @details These functions should be called periodically from PhysicsWorld
-    *   @remark currently no real time collision detection support
+    *   @remark Continuous collision detection is limited to sweepCollision,
+    *   which PhysicsWorld uses for bullet objects
     */
   namespace CollisionDetection {
 
@@ -48,6 +54,28 @@ namespace pe {
       float amount = std::numeric_limits<float>::max(); /**< size of the translation needed, init to max value */
     };
 
+    /**
+      *   @struct ContactPoint
+      *   @brief One point of a contact Manifold
+      */
+    struct ContactPoint {
+      Vector2f point; /**< Position in PhysicsWorld */
+      float depth = 0.f; /**< Penetration along the Manifold normal */
+      float normal_impulse = 0.f; /**< Accumulated impulse along the normal, used for warm starting */
+      float tangent_impulse = 0.f; /**< Accumulated friction impulse, used for warm starting */
+      uint32_t feature = 0; /**< Edges which produced the point, matches the same point between steps */
+    };
+
+    /**
+      *   @struct Manifold
+      *   @brief Contact points of a collided pair
+      */
+    struct Manifold {
+      Vector2f normal; /**< Unit normal pointing from the 1st object towards the 2nd */
+      struct ContactPoint points[2]; /**< Contact points, count first are valid */
+      unsigned count = 0; /**< Amount of contact points, 0 - 2 */
+    };
+
     /**
       *   @brief Calculate collision between PhysicsObjects
       *   @details Check if objects have collided and apply necessary forces to the
@@ -60,6 +88,108 @@ namespace pe {
       */
     bool calculateCollision(PhysicsObject* obj1, PhysicsObject* obj2);
 
+    /**
+      *   @brief Detect collision between PhysicsObjects
+      *   @details Same checks as in calculateCollision but objects are not
+      *   modified, so this can be called for the same object from multiple
+      *   threads at the same time
+      *   @param obj1 1st PhysicsObject to be checked
+      *   @param obj2 2nd PhysicsObject to be checked
+      *   @param mtv minimum translation vector is stored here if objects collided
+      *   @param cache separating axis test is skipped for pairs whose cached
+      *   result is still valid, see ContactCache::reuse. Axis aligned boxes are
+      *   cheaper to test than to look up
+      *   @return true if obj1 and obj2 collided, else false
+      */
+    bool detectCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv, const ContactCache* cache = nullptr);
+
+    /**
+      *   @brief Detect collisions of many candidate pairs
+      *   @details Pairs of axis aligned boxes are tested four at a time with
+      *   SIMD, other pairs with detectCollision. Objects are not modified
+      *   @param pairs candidate pairs, e.g. from Broadphase collectPairs
+      *   @param count amount of pairs
+      *   @param hits index of each collided pair and its minimum translation
+      *   vector are appended here, box pairs may be appended after later pairs
+      *   @param cache results of unchanged pairs are taken from here, see detectCollision
+      */
+    void detectCollisions(const struct ObjectPair* pairs, unsigned count, std::vector<std::pair<unsigned, struct MTV>>& hits,
+                          const ContactCache* cache = nullptr);
+
+    /**
+      *   @brief Find contact points of a collided pair
+      *   @details Clips the incident edge against the reference edge, which is
+      *   the edge most perpendicular to the MTV axis. Box pairs get up to two
+      *   points, an edge touching a corner gets one. Impulses are left to zero
+      *   @param obj1 1st PhysicsObject
+      *   @param obj2 2nd PhysicsObject
+      *   @param mtv minimum translation vector returned by detectCollision
+      *   @param manifold contact points and normal are stored here
+      *   @return amount of contact points
+      */
+    unsigned findManifold(PhysicsObject* obj1, PhysicsObject* obj2, const struct MTV& mtv, struct Manifold& manifold);
+
+    /**
+      *   @brief Find contact points of a collided pair without allocating
+      *   @details Same as findManifold, but objects without a valid transform
+      *   are transformed into caller owned buffers which keep their capacity
+      *   between calls
+      *   @param obj1 1st PhysicsObject
+      *   @param obj2 2nd PhysicsObject
+      *   @param mtv minimum translation vector returned by detectCollision
+      *   @param manifold contact points and normal are stored here
+      *   @param scratch1 vertex buffer for obj1
+      *   @param scratch2 vertex buffer for obj2
+      *   @return amount of contact points
+      */
+    unsigned findManifold(PhysicsObject* obj1, PhysicsObject* obj2, const struct MTV& mtv, struct Manifold& manifold,
+                          std::vector<Vector2f>& scratch1, std::vector<Vector2f>& scratch2);
+
+    /**
+      *   @brief Check whether object can use the box fast path
+      *   @param object PhysicsObject to be checked
+      *   @return true if Shape is ShapeType::Box and object is not rotated
+      */
+    inline bool isAxisAlignedBox(PhysicsObject* object) {
+      return (object->getShape()->getType() == ShapeType::Box) && (object->getPhysics().angle == 0.f);
+    }
+
+    /**
+      *   @brief Detect collision between two axis aligned boxes
+      *   @details Gives the same result as the generic separating axis test,
+      *   but compares only the object bounds
+      *   @param obj1 1st PhysicsObject, isAxisAlignedBox must be true
+      *   @param obj2 2nd PhysicsObject, isAxisAlignedBox must be true
+      *   @param mtv minimum translation vector is stored here if objects collided
+      *   @return true if obj1 and obj2 collided, else false
+      */
+    bool detectBoxCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv);
+
+    /**
+      *   @brief Find time of impact of a moving object
+      *   @details Swept separating axis test: obj1 translates by motion from
+      *   its start position and ends at its current position, obj2 stays
+      *   still. Projections on the Shape axes of both objects must overlap at
+      *   the same time, so the time of impact is the latest time they start to
+      *   overlap. Pairs which already overlap at the start are left to
+      *   detectCollision. Objects are not modified
+      *   @param obj1 moving PhysicsObject, at the end of motion
+      *   @param motion position change of obj1 during the step
+      *   @param obj2 stationary PhysicsObject
+      *   @param toi share of motion travelled before impact, 0 - 1, is stored here
+      *   @return true if obj1 hits obj2 during motion, else false
+      */
+    bool sweepCollision(PhysicsObject* obj1, Vector2f motion, PhysicsObject* obj2, float& toi);
+
+    /**
+      *   @brief Apply collision response to collided PhysicsObjects
+      *   @details Should be called after detectCollision has returned true
+      *   @param obj1 1st collided PhysicsObject
+      *   @param obj2 2nd collided PhysicsObject
+      *   @param mtv minimum translation vector returned by detectCollision
+      */
+    void resolveCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv);
+
     /**
       *   @brief Check if objects are close to each other
       *   @details This functions should tell whether objects could collide with each other.
@@ -85,6 +215,25 @@ namespace pe {
 
     struct Projection ProjectShape(Vector2f axis, Vector2f position, Shape* shape, float object_angle);
 
+    /**
+      *   @brief Project world space vertices on axis
+      *   @param axis axis on which vertices are projected
+      *   @param vertices vertices in PhysicsWorld coordinates, e.g.
+      *   PhysicsObject::getWorldVertices()
+      *   @return Projection with min and max projection values
+      */
+    struct Projection ProjectVertices(Vector2f axis, const std::vector<Vector2f>& vertices);
+
+    /**
+      *   @brief Project PhysicsObject on axis
+      *   @details Uses cached world space vertices when they are up to date,
+      *   otherwise falls back to ProjectShape. Object is not modified
+      *   @param axis axis on which object is projected
+      *   @param object PhysicsObject to be projected
+      *   @return Projection with min and max projection values
+      */
+    struct Projection ProjectObject(Vector2f axis, PhysicsObject* object);
+
     /**
       *   @brief Check whether Projections overlap
       *   @param proj1 1st Projection to check
@@ -137,6 +286,75 @@ namespace pe {
       */
     void collideObjects(std::deque<PhysicsObject*>& objects, struct MTV& mtv);
 
+    /**
+      *   @brief Detect collisions of up to four box pairs at once
+      *   @param pairs candidate pairs
+      *   @param indices indices of the box pairs in pairs, canCollide must be true
+      *   @param amount amount of indices, 1 - 4
+      *   @param hits collided pairs are appended here
+      */
+    void DetectBoxBatch(const struct ObjectPair* pairs, const unsigned* indices, unsigned amount, std::vector<std::pair<unsigned, struct MTV>>& hits);
+
+    /**
+      *   @brief Narrow the time interval when projections of a swept pair overlap
+      *   @param proj1 projection of the moving object at the start
+      *   @param proj2 projection of the stationary object
+      *   @param speed movement of proj1 along the axis during the step
+      *   @param enter latest start of overlap, updated
+      *   @param exit earliest end of overlap, updated
+      *   @return false if projections never overlap, else true
+      */
+    bool SweepAxis(const struct Projection& proj1, const struct Projection& proj2, float speed, float& enter, float& exit);
+
+    /**
+      *   @brief Store MTV of a box pair
+      *   @details Picks the first axis of obj1 Shape which has the smallest
+      *   overlap, like the generic separating axis test does
+      *   @param mtv minimum translation vector
+      *   @param obj1 1st PhysicsObject of the pair
+      *   @param overlap_x overlap along x axis
+      *   @param overlap_y overlap along y axis
+      */
+    void StoreBoxMTV(struct MTV& mtv, PhysicsObject* obj1, float overlap_x, float overlap_y);
+
+    /**
+      *   @struct Edge
+      *   @brief Polygon edge used in contact clipping
+      */
+    struct Edge {
+      Vector2f max; /**< Vertex furthest along the searched direction */
+      Vector2f begin; /**< 1st vertex of the edge */
+      Vector2f end; /**< 2nd vertex of the edge */
+      uint32_t index; /**< Index of begin in the vertices */
+    };
+
+    /**
+      *   @brief Get world space vertices of an object
+      *   @param object PhysicsObject
+      *   @param scratch vertices are transformed here if the cached transform is invalid
+      *   @return cached world vertices or scratch, same as used by ProjectObject
+      */
+    const std::vector<Vector2f>& ObjectVertices(PhysicsObject* object, std::vector<Vector2f>& scratch);
+
+    /**
+      *   @brief Find edge of a polygon which is most perpendicular to direction
+      *   @param vertices polygon vertices in order
+      *   @param direction direction of the search
+      *   @return Edge containing the vertex furthest along direction
+      */
+    struct Edge BestEdge(const std::vector<Vector2f>& vertices, Vector2f direction);
+
+    /**
+      *   @brief Clip segment to the half plane dot(direction, point) >= offset
+      *   @details End point outside the half plane is moved to the plane, so
+      *   both points keep their order
+      *   @param points two segment end points, replaced by the clipped points
+      *   @param direction half plane direction
+      *   @param offset half plane offset
+      *   @return false if the whole segment is outside, otherwise true
+      */
+    bool ClipSegment(Vector2f* points, Vector2f direction, float offset);
+
     /**
       *   @brief Set correct collision direction for objects
       *   @param obj1 1st collided object
@@ -0,0 +1,198 @@
+/**
+  *   @file ContactCache.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class ContactCache
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "CollisionDetection.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @namespace ContactState
+    *   @brief Used to avoid namespace collisions with ContactCache method names
+    */
+  namespace ContactState {
+    /**
+      *   @enum ContactState
+      *   @brief Transition of a contact pair between two steps
+      */
+    enum ContactState {
+      Begin, /**< Objects started touching */
+      Persist, /**< Objects touched also during the previous step */
+      End /**< Objects stopped touching */
+    };
+  } // end of namespace ContactState
+
+  /**
+    *   @struct ContactEvent
+    *   @brief Contact transition reported by ContactCache
+    */
+  struct ContactEvent {
+    PhysicsObject* first; /**< 1st object of the pair */
+    PhysicsObject* second; /**< 2nd object of the pair */
+    enum ContactState::ContactState state; /**< Transition of the pair */
+    struct CollisionDetection::MTV mtv; /**< Latest minimum translation vector of the pair */
+  };
+
+
+  /**
+    *   @class ContactCache
+    *   @brief Persistent contact pairs keyed by object ids
+    *   @details Keeps the state of every touching pair across steps. Each step
+    *   contacts are added between beginStep and endStep, which reports pairs
+    *   as begun, persisted or ended. Pairs of objects which are both inactive
+    *   (sleeping or static) are not checked by PhysicsWorld, so they persist
+    *   without events until either object wakes. Cached pairs also store the
+    *   relative transform of the objects, so that the separating axis test can
+    *   be skipped when it hasn't changed. Each pair keeps the contact Manifold
+    *   of the latest step, so that ContactSolver can warm start from the
+    *   previous impulses. Pairs of removed objects are dropped without events
+    */
+  class ContactCache
+  {
+    public:
+      /**
+        *   @brief Empty constructor
+        */
+      ContactCache() {}
+
+      /**
+        *   @brief Start collecting the contacts of a step
+        *   @details Clears the events of the previous step
+        */
+      void beginStep();
+
+      /**
+        *   @brief Add contact detected during the current step
+        *   @param obj1 1st collided object
+        *   @param obj2 2nd collided object
+        *   @param mtv minimum translation vector of the pair
+        */
+      void addContact(PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv);
+
+      /**
+        *   @brief Report pairs which weren't added during the current step as ended
+        *   @details Pairs are removed from the cache in O(1) each
+        */
+      void endStep();
+
+      /**
+        *   @brief Drop pairs of an object which is going to be removed
+        *   @details Pairs are dropped without End events at the next endStep,
+        *   until then the object must not be reported in contacts
+        *   @param object PhysicsObject to be removed
+        */
+      void removeObject(PhysicsObject* object);
+
+      /**
+        *   @brief Remove all pairs and events
+        */
+      void clear();
+
+      /**
+        *   @brief Get cached result of an unchanged pair
+        *   @details Pair must have touched during the latest step in the same
+        *   order, with the same Shapes and the same relative position and angles.
+        *   Only reads the cache, so it can be called from many threads
+        *   @param obj1 1st object of the pair
+        *   @param obj2 2nd object of the pair
+        *   @param mtv cached minimum translation vector is stored here
+        *   @return true if the cached result is still valid, otherwise false
+        */
+      bool reuse(PhysicsObject* obj1, PhysicsObject* obj2, struct CollisionDetection::MTV& mtv) const;
+
+      /**
+        *   @brief Get Manifold of a pair touching during the latest step
+        *   @details Manifold is stored by ContactSolver and read back during
+        *   the next step. It's reset when the order of the objects changes
+        *   @param obj1 1st object of the pair, in the same order as added
+        *   @param obj2 2nd object of the pair
+        *   @return pointer to the stored Manifold, valid until the next endStep,
+        *   or nullptr if the pair isn't cached
+        */
+      struct CollisionDetection::Manifold* getManifold(PhysicsObject* obj1, PhysicsObject* obj2);
+
+      /**
+        *   @brief Get events of the latest step
+        *   @return Begin and Persist events in contact order, followed by End events
+        */
+      inline const std::vector<struct ContactEvent>& getEvents() const {
+        return events;
+      }
+
+      /**
+        *   @brief Get amount of cached pairs
+        *   @return pairs touching during the latest step
+        */
+      inline unsigned size() const {
+        return pairs.size();
+      }
+
+    private:
+      /**
+        *   @struct CachedPair
+        *   @brief State of one touching pair
+        */
+      struct CachedPair {
+        uint64_t key; /**< Ordered ids of the objects */
+        PhysicsObject* first; /**< 1st object in the latest contact */
+        PhysicsObject* second; /**< 2nd object in the latest contact */
+        Shape* first_shape; /**< Shape of first during the latest contact */
+        Shape* second_shape; /**< Shape of second during the latest contact */
+        Vector2f relative; /**< Position of second relative to first */
+        float first_angle; /**< Angle of first */
+        float second_angle; /**< Angle of second */
+        struct CollisionDetection::MTV mtv; /**< Latest minimum translation vector */
+        struct CollisionDetection::Manifold manifold; /**< Latest contact points and impulses */
+        uint32_t step; /**< Latest step when the pair touched */
+      };
+
+      /**
+        *   @brief Get key of a pair
+        *   @param obj1 1st object
+        *   @param obj2 2nd object
+        *   @return smaller id in the high bits, independent of the object order
+        */
+      static inline uint64_t PairKey(PhysicsObject* obj1, PhysicsObject* obj2) {
+        uint64_t id1 = obj1->getId();
+        uint64_t id2 = obj2->getId();
+        return id1 < id2 ? (id1 << 32) | id2 : (id2 << 32) | id1;
+      }
+
+      /**
+        *   @brief Store the contact transform of a pair
+        *   @param pair CachedPair to be updated
+        *   @param obj1 1st collided object
+        *   @param obj2 2nd collided object
+        *   @param mtv minimum translation vector of the pair
+        */
+      void Store(struct CachedPair& pair, PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv);
+
+      /**
+        *   @brief Remove pair by moving the last pair to its place
+        *   @param index index of the pair in pairs
+        */
+      void RemovePair(unsigned index);
+
+      std::vector<struct CachedPair> pairs; /**< Touching pairs */
+      std::unordered_map<uint64_t, uint32_t> index; /**< Pair key to index in pairs */
+      std::unordered_set<uint32_t> removed; /**< Ids of objects removed since the latest endStep */
+      std::vector<struct ContactEvent> events; /**< Events of the latest step */
+      uint32_t step = 1; /**< Current step, 0 is never used */
+  };
+
+} // end of namespace pe
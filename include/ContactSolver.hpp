@@ -0,0 +1,342 @@
+/**
+  *   @file ContactSolver.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class ContactSolver
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "CollisionDetection.hpp"
+#include "ThreadPool.hpp"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @namespace SolverPass
+    *   @brief Used to avoid namespace collisions with ContactSolver method names
+    */
+  namespace SolverPass {
+    /**
+      *   @enum SolverPass
+      *   @brief Pass run over all contacts of a ContactSolver
+      */
+    enum SolverPass {
+      WarmStart, /**< Apply cached impulses */
+      Velocity, /**< Solve impulses once */
+      Position /**< Push overlapping objects apart once */
+    };
+  } // end of namespace SolverPass
+
+  /**
+    *   @class ContactSolver
+    *   @brief Sequential impulse solver for contact Manifolds
+    *   @details Collided pairs are added once per step. solve iterates normal
+    *   and friction impulses of all contact points until the velocities
+    *   converge, then pushes overlapping objects apart in separate position
+    *   iterations, so that penetration doesn't add velocity. Accumulated
+    *   impulses are stored to the cached Manifolds and applied again at the
+    *   start of the next step (warm starting), which lets resting stacks
+    *   converge in a few iterations. Objects don't rotate, so the points of a
+    *   Manifold share the load along the same normal. Objects may only be
+    *   pushed by objects with the same or greater collision mask, like in
+    *   CollisionDetection::GetCollisionResult. Large sets of contacts are
+    *   coloured so that contacts of the same colour share no DynamicObject.
+    *   Each colour is then solved in parallel batches without locks, and the
+    *   result doesn't depend on the amount of threads. Solver doesn't own the
+    *   objects
+    */
+  class ContactSolver
+  {
+    public:
+      /**
+        *   @brief Set iteration counts of all ContactSolvers
+        *   @param velocity maximum amount of velocity iterations, must be > 0
+        *   @param position amount of position iterations
+        */
+      static void setIterations(unsigned velocity, unsigned position);
+
+      /**
+        *   @brief Get maximum amount of velocity iterations
+        *   @return VelocityIterations
+        */
+      static inline unsigned getVelocityIterations() {
+        return VelocityIterations;
+      }
+
+      /**
+        *   @brief Get amount of position iterations
+        *   @return PositionIterations
+        */
+      static inline unsigned getPositionIterations() {
+        return PositionIterations;
+      }
+
+      /**
+        *   @brief Set friction coefficient of all contacts
+        *   @param friction friction coefficient, abs is taken
+        */
+      static void setFriction(float friction);
+
+      /**
+        *   @brief Get friction coefficient
+        *   @return Friction
+        */
+      static inline float getFriction() {
+        return Friction;
+      }
+
+      /**
+        *   @brief Set whether impulses of the previous step are reused
+        *   @param warm_starting true to apply cached impulses first (default)
+        */
+      static void setWarmStarting(bool warm_starting);
+
+      /**
+        *   @brief Check whether warm starting is used
+        *   @return WarmStarting
+        */
+      static inline bool getWarmStarting() {
+        return WarmStarting;
+      }
+
+      /**
+        *   @brief Set approach velocity needed for bouncing
+        *   @details Slower contacts don't bounce, which lets objects come to rest
+        *   @param velocity approach velocity limit
+        */
+      static void setRestitutionThreshold(float velocity);
+
+      /**
+        *   @brief Set amount of contacts which are solved by colours
+        *   @details Smaller sets are solved one contact at a time in the
+        *   added order. Colouring changes the solving order, so results differ
+        *   slightly from the sequential order
+        *   @param contacts least amount of contacts coloured, 0 disables colouring
+        */
+      static void setColouringLimit(unsigned contacts);
+
+      /**
+        *   @brief Get amount of contacts which are solved by colours
+        *   @return ColouringLimit
+        */
+      static inline unsigned getColouringLimit() {
+        return ColouringLimit;
+      }
+
+      /**
+        *   @brief Empty constructor
+        */
+      ContactSolver();
+
+      /**
+        *   @brief Add collided pair to be solved
+        *   @param obj1 1st collided object
+        *   @param obj2 2nd collided object
+        *   @param mtv minimum translation vector returned by detectCollision
+        *   @param cached Manifold of the previous step, used for warm starting
+        *   and updated by solve, may be nullptr
+        */
+      void add(PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv, struct CollisionDetection::Manifold* cached);
+
+      /**
+        *   @brief Solve all added contacts and clear the solver
+        *   @details Velocities, positions and world space vertices of the
+        *   DynamicObjects are updated and the objects are flagged moved.
+        *   Impulses are solved on the velocities of the latest integration,
+        *   which include gravity of the step. Velocity stored to PhysicsProperties
+        *   doesn't include gravity, so only the change is added to it and the
+        *   solved velocity is stored to physics.collision_velocity
+        *   @param pool threads sharing the colours, used only when at least
+        *   ColouringLimit contacts were added. nullptr solves them in the calling thread
+        *   @remark Must not be called from inside a job of pool
+        */
+      void solve(ThreadPool* pool = nullptr);
+
+      /**
+        *   @brief Remove all added contacts without solving them
+        */
+      void clear();
+
+      /**
+        *   @brief Get amount of added contacts
+        *   @return contacts added since the latest solve
+        */
+      inline unsigned size() const {
+        return constraints.size();
+      }
+
+      /**
+        *   @brief Get velocity iterations used by the latest solve
+        *   @details Iteration stops early when no impulse changes velocities
+        *   more than Tolerance
+        *   @return iterations, 0 if there were no contacts
+        */
+      inline unsigned getIterations() const {
+        return iterations;
+      }
+
+      /**
+        *   @brief Get amount of colours used by the latest solve
+        *   @return colours, 0 if contacts were solved in the added order
+        */
+      inline unsigned getColours() const {
+        return colours;
+      }
+
+    private:
+      static unsigned VelocityIterations; /**< Maximum velocity iterations per step */
+      static unsigned PositionIterations; /**< Position iterations per step */
+      static float Friction; /**< Friction coefficient of all contacts */
+      static bool WarmStarting; /**< Whether cached impulses are applied first */
+      static float RestitutionThreshold; /**< Approach velocity needed for bouncing */
+      static unsigned ColouringLimit; /**< Least amount of contacts solved by colours, 0 disables */
+      static const unsigned Colours; /**< Colours available, bits in colour_masks */
+      static const unsigned BatchSize; /**< Least amount of contacts of one colour per thread */
+      static const float Tolerance; /**< Velocity change which ends velocity iterations */
+      static const float Baumgarte; /**< Share of the penetration corrected per position iteration */
+      static const float Slop; /**< Penetration allowed, keeps resting contacts touching */
+
+      /**
+        *   @struct SolverBody
+        *   @brief Velocity and position correction of one object during solve
+        */
+      struct SolverBody {
+        PhysicsObject* object; /**< Solved object */
+        Vector2f velocity; /**< Velocity during the step */
+        Vector2f integrated; /**< Velocity used by the latest integration */
+        Vector2f correction; /**< Accumulated position correction */
+        float inverse_mass; /**< 0 for StaticObjects */
+      };
+
+      /**
+        *   @struct Constraint
+        *   @brief Contact Manifold of one pair
+        */
+      struct Constraint {
+        struct CollisionDetection::MTV mtv; /**< Minimum translation vector of the pair */
+        unsigned body1; /**< Index of the 1st object in bodies */
+        unsigned body2; /**< Index of the 2nd object in bodies */
+        float inverse_mass1; /**< Inverse mass of the 1st object, 0 if it isn't pushed */
+        float inverse_mass2; /**< Inverse mass of the 2nd object, 0 if it isn't pushed */
+        float normal_mass; /**< Inverse of the summed inverse masses */
+        float restitution; /**< Bounciness of the pair */
+        Vector2f tangent; /**< Friction direction */
+        float bias[2]; /**< Target separation velocity of each point */
+        struct CollisionDetection::Manifold manifold; /**< Contact points and accumulated impulses */
+        struct CollisionDetection::Manifold* cached; /**< Manifold stored for the next step */
+      };
+
+      /**
+        *   @brief Get index of object in bodies, object is added if needed
+        *   @param object PhysicsObject
+        *   @return index in bodies
+        */
+      unsigned Body(PhysicsObject* object);
+
+      /**
+        *   @brief Find contact points and restitution targets of a constraint
+        *   @details Points are matched with the cached Manifold by feature for
+        *   warm starting. Velocities are only read, so constraints may be
+        *   prepared concurrently
+        *   @param constraint Constraint whose Manifold is found
+        *   @param thread index of the executing thread, selects vertex_buffers
+        */
+      void Prepare(struct Constraint& constraint, unsigned thread);
+
+      /**
+        *   @brief Apply cached impulses of a constraint
+        *   @param constraint Constraint whose impulses are applied
+        */
+      void WarmStart(struct Constraint& constraint);
+
+      /**
+        *   @brief Solve normal and friction impulses of a constraint once
+        *   @param constraint solved Constraint
+        *   @return largest velocity change caused by a single impulse
+        */
+      float SolveVelocity(struct Constraint& constraint);
+
+      /**
+        *   @brief Push objects of a constraint apart once
+        *   @param constraint solved Constraint
+        */
+      void SolvePosition(struct Constraint& constraint);
+
+      /**
+        *   @brief Run one pass over a constraint
+        *   @param constraint solved Constraint
+        *   @param pass executed SolverPass
+        *   @return largest velocity change of SolverPass::Velocity, otherwise 0
+        */
+      float Solve(struct Constraint& constraint, SolverPass::SolverPass pass);
+
+      /**
+        *   @brief Store velocity and position of a body to its object
+        *   @param body solved SolverBody
+        */
+      void Store(struct SolverBody& body);
+
+      /**
+        *   @brief Order constraints by colour
+        *   @details Each constraint gets the smallest colour not used by the
+        *   pushable objects it reads. Other objects are never written, so they
+        *   may be shared. Constraints which find no free colour are placed
+        *   last and solved by one thread
+        */
+      void Colour();
+
+      /**
+        *   @brief Divide a range to pool threads
+        *   @details Small ranges and nullptr pool run in the calling thread
+        *   @param pool executing threads, may be nullptr
+        *   @param amount size of the range
+        *   @param job called with begin, end and index of the executing thread
+        */
+      template <typename Job>
+      void Run(ThreadPool* pool, unsigned amount, const Job& job) {
+        unsigned threads = pool != nullptr ? pool->getWorkers() + 1 : 1;
+        threads = std::min(threads, amount / ContactSolver::BatchSize);
+        if (threads <= 1) {
+          job(0, amount, 0);
+          return;
+        }
+        pool->run([&job, amount, threads] (unsigned thread) {
+          if (thread < threads) job(amount * thread / threads, amount * (thread + 1) / threads, thread);
+        });
+      }
+
+      /**
+        *   @brief Run one pass over all constraints in colour order
+        *   @details Calling thread waits for each colour to finish before the
+        *   next one, so constraints of different colours never run concurrently
+        *   @param pool threads sharing the colours, may be nullptr
+        *   @param pass executed SolverPass
+        *   @return largest velocity change of SolverPass::Velocity, otherwise 0
+        */
+      float SolveColours(ThreadPool* pool, SolverPass::SolverPass pass);
+
+      std::vector<struct SolverBody> bodies; /**< Objects of the added contacts */
+      std::vector<struct Constraint> constraints; /**< Added contacts */
+      std::unordered_map<PhysicsObject*, unsigned> body_index; /**< Object to index in bodies */
+      std::vector<unsigned> coloured; /**< Indices of constraints ordered by colour */
+      std::vector<unsigned> colour_offsets; /**< Start of each colour in coloured, one extra at the end */
+      std::vector<uint64_t> colour_masks; /**< Colours used by the constraints of each body */
+      std::vector<uint8_t> constraint_colours; /**< Colour of each constraint during Colour */
+      std::vector<float> thread_changes; /**< Largest velocity change found by each thread */
+      std::vector<std::vector<Vector2f>> vertex_buffers; /**< Two findManifold buffers for each thread, reused between steps */
+      unsigned iterations = 0; /**< Velocity iterations used by the latest solve */
+      unsigned colours = 0; /**< Colours used by the latest solve */
+  };
+
+} // end of namespace pe
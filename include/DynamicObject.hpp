@@ -41,7 +41,8 @@ namespace pe {
         /**
           *   @brief Set force for DynamicObject
           *   @see PhysicsObject setForce
-          *   @details force changes the acceloration value in PhysicsProperties of the object
+          *   @details force changes the acceloration value in PhysicsProperties of the object.
+          *   Wakes sleeping object
           *   @param force force to be set for the object
           */
         virtual void setForce(Vector2f force) override;
@@ -49,7 +50,8 @@ namespace pe {
         /**
           *   @brief Set velocity for DynamicObject
           *   @see PhysicsObject setVelocity
-          *   @details velocity replaces old velocity value in PhysicsProperties of the object
+          *   @details velocity replaces old velocity value in PhysicsProperties of the object.
+          *   Wakes sleeping object
           *   @param velocity velocity to be set for the object
           */
         virtual void setVelocity(Vector2f velocity) override;
@@ -73,6 +75,29 @@ namespace pe {
           */
         virtual void updatePhysics(float elapsed_time) override;
 
+        /**
+          *   @brief Prepare DynamicObject for integration
+          *   @details First part of updatePhysics, stores the previous position.
+          *   Used by BodyStore which integrates many objects at once
+          *   @remark DO NOT call this outside PhysicsWorld
+          */
+        inline void beginUpdate() {
+          if (updatesFromPrevCollision < std::numeric_limits<unsigned>::max()) updatesFromPrevCollision++;
+          if (updatesFromPrevCollision > 1) prevPosition = physics.position;
+        }
+
+        /**
+          *   @brief Finish integration
+          *   @details Last part of updatePhysics, called after position,
+          *   velocity and acceloration are updated
+          *   @param delta position change of the integration
+          *   @remark DO NOT call this outside PhysicsWorld
+          */
+        inline void endUpdate(Vector2f delta) {
+          inverse_direction = Vector2f(-delta.getX(), -delta.getY());
+          alreadyCollided = false;
+        }
+
         /**
           *   @brief Set collision action direction, implemented from the base class
           *   @param direction new collision_direction, this method will normalize direction
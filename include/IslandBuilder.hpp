@@ -0,0 +1,135 @@
+/**
+  *   @file IslandBuilder.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class IslandBuilder
+  */
+
+#pragma once
+
+#include "PhysicsObject.hpp"
+#include <unordered_map>
+#include <vector>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class IslandBuilder
+    *   @brief Partitions contacts to independent groups of touching objects
+    *   @details Contacts are added once per step and build joins the
+    *   DynamicObjects of each contact with union-find. An island is a group of
+    *   DynamicObjects connected by contacts together with those contacts.
+    *   StaticObjects don't join islands, so objects resting on the same ground
+    *   stay apart. Islands share no DynamicObjects, which lets them be solved
+    *   concurrently and put to sleep as a whole. Builder doesn't own the objects
+    */
+  class IslandBuilder
+  {
+    public:
+      /**
+        *   @brief Empty constructor
+        */
+      IslandBuilder() {}
+
+      /**
+        *   @brief Add contact of the current step
+        *   @details Contacts are numbered in the order they are added
+        *   @param obj1 1st collided object
+        *   @param obj2 2nd collided object
+        */
+      void addContact(PhysicsObject* obj1, PhysicsObject* obj2);
+
+      /**
+        *   @brief Partition added contacts to islands
+        *   @details Islands are numbered in the order their first contact was
+        *   added, contacts and objects of an island keep their added order
+        */
+      void build();
+
+      /**
+        *   @brief Remove all contacts and islands
+        */
+      void clear();
+
+      /**
+        *   @brief Get amount of islands
+        *   @return islands found by the latest build
+        */
+      inline unsigned size() const {
+        return contact_offsets.empty() ? 0 : contact_offsets.size() - 1;
+      }
+
+      /**
+        *   @brief Get amount of added contacts
+        *   @return contacts added since the latest clear
+        */
+      inline unsigned getContactAmount() const {
+        return contacts.size();
+      }
+
+      /**
+        *   @brief Get contacts of an island
+        *   @param island island index, < size()
+        *   @param amount amount of contacts is stored here
+        *   @return pointer to the contact numbers of the island
+        */
+      inline const unsigned* getContacts(unsigned island, unsigned& amount) const {
+        amount = contact_offsets[island + 1] - contact_offsets[island];
+        return island_contacts.data() + contact_offsets[island];
+      }
+
+      /**
+        *   @brief Get DynamicObjects of an island
+        *   @param island island index, < size()
+        *   @param amount amount of objects is stored here
+        *   @return pointer to the objects of the island
+        */
+      inline PhysicsObject* const* getObjects(unsigned island, unsigned& amount) const {
+        amount = object_offsets[island + 1] - object_offsets[island];
+        return island_objects.data() + object_offsets[island];
+      }
+
+    private:
+      static const unsigned NoNode; /**< Node of StaticObjects, which don't join islands */
+
+      /**
+        *   @brief Get union-find index of an object
+        *   @param object PhysicsObject
+        *   @return index in parents, NoNode for StaticObjects
+        */
+      unsigned Node(PhysicsObject* object);
+
+      /**
+        *   @brief Find root of a node
+        *   @details Path is halved on the way
+        *   @param node index in parents
+        *   @return root index
+        */
+      unsigned Find(unsigned node);
+
+      /**
+        *   @brief Join sets of two nodes
+        *   @details Smaller set is attached to the bigger one
+        *   @param node1 1st index in parents
+        *   @param node2 2nd index in parents
+        */
+      void Union(unsigned node1, unsigned node2);
+
+      std::vector<std::pair<unsigned, unsigned>> contacts; /**< Union-find nodes of each added contact */
+      std::vector<PhysicsObject*> objects; /**< DynamicObject of each node */
+      std::vector<unsigned> parents; /**< Union-find parent of each node */
+      std::vector<unsigned> sizes; /**< Set size of each root node */
+      std::unordered_map<PhysicsObject*, unsigned> node_index; /**< DynamicObject to node */
+      std::vector<unsigned> root_island; /**< Island of each root node during build */
+      std::vector<unsigned> contact_island; /**< Island of each contact during build */
+      std::vector<unsigned> island_contacts; /**< Contact numbers grouped by island */
+      std::vector<unsigned> contact_offsets; /**< Start of each island in island_contacts, one extra at the end */
+      std::vector<PhysicsObject*> island_objects; /**< DynamicObjects grouped by island */
+      std::vector<unsigned> object_offsets; /**< Start of each island in island_objects, one extra at the end */
+  };
+
+} // end of namespace pe
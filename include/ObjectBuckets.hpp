@@ -0,0 +1,64 @@
+/**
+  *   @file ObjectBuckets.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class ObjectBuckets
+  */
+
+#pragma once
+
+#include "PhysicsObject.hpp"
+#include "Broadphase.hpp"
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class ObjectBuckets
+    *   @brief Groups objects of a Broadphase without Cells to fixed size buckets
+    *   @details Broadphases which produce pairs directly (SweepAndPrune, AABBTree)
+    *   still need Cells so that PhysicsWorld can divide object updates between
+    *   threads. Object with index i is stored to bucket i / BucketSize, which
+    *   becomes its home Cell. ObjectBuckets doesn't own the objects
+    */
+  class ObjectBuckets
+  {
+    public:
+      static const unsigned BucketSize = 256; /**< Objects with indices [i * BucketSize, (i + 1) * BucketSize) share bucket i */
+
+      /**
+        *   @brief Add object to the bucket matching index
+        *   @details Sets object CellRange to the bucket
+        *   @param object to be added
+        *   @param index Broadphase specific object index
+        */
+      void add(PhysicsObject* object, uint32_t index);
+
+      /**
+        *   @brief Remove object from its bucket
+        *   @param object to be removed, must have been added
+        */
+      void remove(PhysicsObject* object);
+
+      /**
+        *   @brief Append buckets to cells
+        *   @param cells vector where buckets are appended
+        *   @param active_only if true, only buckets containing DynamicObjects are appended
+        */
+      void collect(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only);
+
+      /**
+        *   @brief Remove all buckets
+        */
+      void clear();
+
+    private:
+      std::vector<Cell<PhysicsObject*>> buckets; /**< Bucket Cells, Cell x is the bucket index */
+  };
+
+} // end of namespace pe
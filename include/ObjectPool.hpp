@@ -0,0 +1,210 @@
+/**
+  *   @file ObjectPool.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for slab allocated ObjectPool
+  */
+
+#pragma once
+
+#include <new>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class PoolBase
+    *   @brief Type independent interface of ObjectPool
+    *   @details Lets objects return their memory without knowing the type of
+    *   the pool they were created from
+    */
+  class PoolBase
+  {
+    public:
+      /**
+        *   @brief Virtual deconstructor
+        */
+      virtual ~PoolBase() {}
+
+      /**
+        *   @brief Return memory of a destroyed object to the pool
+        *   @param memory address of the most derived object, its deconstructor
+        *   must have been called already
+        */
+      virtual void release(void* memory) = 0;
+  };
+
+
+  /**
+    *   @struct PoolLink
+    *   @brief Pool which owns the memory of an object
+    *   @details Copies of pooled objects are allocated from heap, so the link is
+    *   never copied
+    */
+  struct PoolLink {
+    PoolBase* pool = nullptr; /**< Owning pool, nullptr for heap allocated objects */
+
+    /**
+      *   @brief Empty constructor
+      */
+    PoolLink() {}
+
+    /**
+      *   @brief Copy constructor, creates an empty link
+      */
+    PoolLink(const PoolLink&) {}
+
+    /**
+      *   @brief Assignment operator, keeps the current link
+      *   @return reference to the link
+      */
+    PoolLink& operator=(const PoolLink&) {
+      return *this;
+    }
+  };
+
+
+  /**
+    *   @class ObjectPool
+    *   @brief Type segregated slab allocator
+    *   @details Objects are constructed to slots of fixed size slabs. Slabs are
+    *   never moved nor freed before the pool, so object pointers are stable
+    *   handles. Destroyed slots are pushed to a free list and reused first, so
+    *   create and destroy are O(1) and allocate only when all slabs are full.
+    *   Objects created one after another are adjacent in memory.
+    *   Not thread safe
+    */
+  template<class T>
+  class ObjectPool: public PoolBase
+  {
+    public:
+      static const unsigned SlabSize = 256; /**< Slots allocated at once */
+
+      /**
+        *   @brief Empty constructor, no slabs are allocated
+        */
+      ObjectPool() {}
+
+      /**
+        *   @brief Deconstructor
+        *   @details Destroys objects which are still alive and frees all slabs
+        */
+      virtual ~ObjectPool() {
+        for (auto slab : slabs) {
+          for (unsigned i = 0; i < SlabSize; i++) {
+            if (slab[i].next == &slab[i]) reinterpret_cast<T*>(slab[i].storage)->~T();
+          }
+          delete[] slab;
+        }
+      }
+
+      ObjectPool(const ObjectPool&) = delete;
+      ObjectPool& operator=(const ObjectPool&) = delete;
+
+      /**
+        *   @brief Construct object to a free slot
+        *   @param args constructor arguments of T
+        *   @return pointer to the object, valid until destroy
+        */
+      template<typename... Args>
+      T* create(Args&&... args) {
+        if (free_slots == nullptr) AddSlab();
+        Slot* slot = free_slots;
+        // slot is taken only after the constructor succeeded
+        T* object = new (slot->storage) T(std::forward<Args>(args)...);
+        free_slots = slot->next;
+        slot->next = slot;
+        alive++;
+        return object;
+      }
+
+      /**
+        *   @brief Destroy object created by this pool
+        *   @param object to be destroyed
+        */
+      void destroy(T* object) {
+        object->~T();
+        release(object);
+      }
+
+      /**
+        *   @brief Return memory of a destroyed object to the pool
+        *   @param memory address of the object
+        */
+      virtual void release(void* memory) override {
+        Slot* slot = static_cast<Slot*>(memory);
+        slot->next = free_slots;
+        free_slots = slot;
+        alive--;
+      }
+
+      /**
+        *   @brief Check whether object is alive in this pool
+        *   @details Linear in the amount of slabs
+        *   @param object checked address
+        *   @return true if object was created by this pool and is not destroyed
+        */
+      bool owns(const T* object) const {
+        uintptr_t address = reinterpret_cast<uintptr_t>(object);
+        for (auto slab : slabs) {
+          uintptr_t begin = reinterpret_cast<uintptr_t>(slab);
+          if ((address < begin) || (address >= begin + SlabSize * sizeof(Slot))) continue;
+          const Slot* slot = &slab[(address - begin) / sizeof(Slot)];
+          return (reinterpret_cast<uintptr_t>(slot->storage) == address) && (slot->next == slot);
+        }
+        return false;
+      }
+
+      /**
+        *   @brief Get amount of alive objects
+        *   @return alive
+        */
+      inline unsigned size() const {
+        return alive;
+      }
+
+      /**
+        *   @brief Get amount of allocated slots
+        *   @return slots in all slabs
+        */
+      inline unsigned capacity() const {
+        return slabs.size() * SlabSize;
+      }
+
+    private:
+      /**
+        *   @struct Slot
+        *   @brief Storage for one object
+        *   @details next points to the next free slot, alive slots point to themselves
+        */
+      struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)]; /**< Object memory, first so that object and slot addresses match */
+        Slot* next; /**< Next free slot, the slot itself when alive */
+      };
+
+      /**
+        *   @brief Allocate a new slab and push its slots to the free list
+        *   @details Slots are pushed in reverse so that they are handed out in
+        *   address order
+        */
+      void AddSlab() {
+        Slot* slab = new Slot[SlabSize];
+        for (unsigned i = SlabSize; i > 0; i--) {
+          slab[i - 1].next = free_slots;
+          free_slots = &slab[i - 1];
+        }
+        slabs.push_back(slab);
+      }
+
+      std::vector<Slot*> slabs; /**< Allocated slabs */
+      Slot* free_slots = nullptr; /**< Head of the free list */
+      unsigned alive = 0; /**< Amount of alive objects */
+  };
+
+} // end of namespace pe
@@ -11,8 +11,9 @@
 #include "PhysicsObject.hpp"
 #include "DynamicObject.hpp"
 #include "StaticObject.hpp"
-#include <list>
+#include "Broadphase.hpp"
 #include <vector>
+#include <cstdint>
 
 
 /**
@@ -21,25 +22,32 @@
   */
 namespace pe {
 
-
   /**
-    *   @struct Cell
-    *   @brief struct representing one cell in Grid
+    *   @namespace CellOrder
+    *   @brief Used to avoid namespace collisions with PhysicsGrid method names
     */
-  template<class T>
-  struct Cell {
-    std::list<T> entities; /**< list of entities Cell contains */
-    bool active_cell; /**< Whether Cell is active or not */
-  };
+  namespace CellOrder {
+    /**
+      *   @enum CellOrder
+      *   @brief Memory order of PhysicsGrid Cells
+      */
+    enum CellOrder {
+      RowMajor, /**< Rows one after another (default) */
+      Morton /**< Z-order curve, neighbouring Cells in both directions are mostly close in memory.
+                  Grid is padded to a square of power of two, narrow grids stay row-major */
+    };
+  } // end of namespace CellOrder
+
 
   /**
     *   @class PhysicsGrid
     *   @brief Container for PhysicsObject of PhysicsWorld
     *   @details Consists of Cell structs. PhysicsGrid and it's Cells take
     *   ownership of PhysicsObjects so their memory deletion is handled by Grid.
-    *   Do NOT delete objects memory elsewhere
+    *   Do NOT delete objects memory elsewhere. Grid covers a fixed area given
+    *   to addCells, objects outside it are stored to the border Cells
     */
-    class PhysicsGrid
+    class PhysicsGrid: public Broadphase
     {
       public:
         /**
@@ -65,88 +73,126 @@ namespace pe {
           */
         PhysicsGrid& operator=(const PhysicsGrid& grid);
 
+        /**
+          *   @brief Make a hard copy of PhysicsGrid
+          *   @return new PhysicsGrid, caller takes ownership
+          */
+        virtual Broadphase* clone() const override;
+
         /**
           *   @brief Add cells to Grid, this must be called prior accessing PhysicsGrid
-          *   @details After Cell is added, Grid maintains removal of the entities
+          *   @details After Cell is added, Grid maintains removal of the entities.
+          *   All Cells are allocated as one contiguous array in the given order.
+          *   Calling again replaces the Cells, objects are deleted
           *   @param gridWidth width of the whole grid, symmetrically distributed around zero
           *   @param gridHeight height of the whole game area, symmetrically distributed around zero
           *   @param cellSize size of one grid cell
+          *   @param order memory order of the Cells, collectCells follows it
           */
-        void addCells(int gridWidth, int gridHeight, int gridCellSize);
+        void addCells(int gridWidth, int gridHeight, int gridCellSize, enum CellOrder::CellOrder order = CellOrder::RowMajor);
 
         /**
-          *   @brief Add PhysicsObject to Cell in the Grid
+          *   @brief Add PhysicsObject to all Cells it overlaps
           *   @param object to be added
-          *   @return true if object was added, otherwise false
-          *   @details object cannot be added if there is no Cell matching to
-          *   the position of object
-          *   @remark This is not very trustworthy, only the center of object
-          *   is checked whether it's inside Cell or not
+          *   @return true if object was added, false if addCells hasn't been called
           */
-        bool addObject(PhysicsObject* object);
+        virtual bool addObject(PhysicsObject* object) override;
+
+        /**
+          *   @brief Compute CellRanges of objects
+          *   @param objects objects passed later to addObjects
+          *   @param begin index of the first object
+          *   @param end index of the object which must not be located anymore
+          */
+        virtual void locateObjects(PhysicsObject* const* objects, unsigned begin, unsigned end) const override;
+
+        /**
+          *   @brief Add many located PhysicsObjects at once
+          *   @details Objects are counted per Cell first, so every Cell grows
+          *   at most once. Objects keep their order inside each Cell
+          *   @param objects objects to be added, see locateObjects
+          *   @param count amount of objects
+          *   @return amount of added objects, 0 if addCells hasn't been called
+          */
+        virtual unsigned addObjects(PhysicsObject* const* objects, unsigned count) override;
 
         /**
           *   @brief Remove PhysicsObject from PhysicsGrid
+          *   @details Object is removed from the Cells stored in its CellRange
           *   @param object to be removed
           *   @return true if object successfully removes, otherwise false
           */
-        bool removeObject(PhysicsObject* object);
+        virtual bool removeObject(PhysicsObject* object) override;
 
         /**
-          *   @brief Move all objects to correct grid cells
-          *   @details PhysicsObject checked for move its moved bool is true.
-          *   After possibly moving sets the moved to false. DynamicObject
-          *   needs to be moved if its position isn't inside the grid cell
-          *   @remark This is necessarily quite heavy method and it should be
-          *   called only from PhysicsWorld update
+          *   @brief Move listed objects to correct grid cells
+          *   @details Sets moved to false. Object needs to be moved if the Cells
+          *   it overlaps have changed, old Cells are found from its CellRange
+          *   @param moved objects whose position may have changed
+          *   @remark This should be called only from PhysicsWorld update
           */
-        void moveObjects();
+        virtual void moveObjects(const std::vector<PhysicsObject*>& moved) override;
+        using Broadphase::moveObjects;
 
         /**
-          *   @brief Get const iterator to the beginning of cell
-          *   @return cells.cbegin()
+          *   @brief Append Cells to cells in memory order, see CellOrder
+          *   @param cells vector where Cells are appended
+          *   @param active_only if true, only active Cells are appended
           */
-        inline std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator cbegin() {
-          return cells.cbegin();
-        }
+        virtual void collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) override;
 
         /**
-          *   @brief Get const iterator to the end of cell
-          *   @return cells.cend()
+          *   @brief Find objects whose bounds overlap region
+          *   @details Visits only the Cells overlapped by region
+          *   @param min smallest corner of the region
+          *   @param max biggest corner of the region
+          *   @param objects found objects are appended here
           */
-        inline std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator cend() {
-          return cells.cend();
-        }
+        virtual void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) override;
+
         /**
-          *   @brief Get iterator to the beginning of cell
-          *   @return cells.begin()
+          *   @brief Map positions to Cell ids
+          *   @details Id of Cell (x, y) is y * columns + x. Positions outside the
+          *   grid map to the border Cells like objects do
+          *   @param positions positions to be mapped
+          *   @param count amount of positions
+          *   @param ids Cell ids are stored here, must have room for count ids.
+          *   Left untouched if addCells hasn't been called
           */
-        inline std::vector<std::vector<Cell<PhysicsObject*>*>>::iterator begin() {
-          return cells.begin();
+        void getCellIds(const Vector2f* positions, unsigned count, uint32_t* ids) const;
+
+        /**
+          *   @brief Get Cell
+          *   @param x column index, must be smaller than getColumns
+          *   @param y row index, must be smaller than getRows
+          *   @return Cell pointer
+          */
+        inline Cell<PhysicsObject*>* getCell(unsigned x, unsigned y) const {
+          return CellAt(x, y);
         }
 
         /**
-          *   @brief Get iterator to the end of cell
-          *   @return cell.cend()
+          *   @brief Get amount of Cell rows
+          *   @return rows, 0 if addCells hasn't been called
           */
-        inline std::vector<std::vector<Cell<PhysicsObject*>*>>::iterator end() {
-          return cells.end();
+        inline unsigned getRows() const {
+          return grid_rows;
         }
 
         /**
-          *   @brief Get loose_cell
-          *   @return pointer to loose_cell
+          *   @brief Get amount of Cells in one row
+          *   @return columns, 0 if addCells hasn't been called
           */
-        inline Cell<PhysicsObject*>* getLooseCell() {
-          return loose_cell;
+        inline unsigned getColumns() const {
+          return grid_columns;
         }
 
         /**
-          *   @brief Get cells size
-          *   @return cells.size
+          *   @brief Get memory order of Cells
+          *   @return order given to addCells
           */
-        inline unsigned getCellsSize() {
-          return cells.size();
+        inline enum CellOrder::CellOrder getCellOrder() const {
+          return cell_order;
         }
 
       private:
@@ -166,40 +212,100 @@ namespace pe {
         void Copy(const PhysicsGrid& grid);
 
         /**
-          *   @brief Activate / deactivate Cell
-          *   @details Cell is active if it contains at least one DynamicObject
-          *   @param cell Cell to be checked
-          *   @return true if cell active, otherwise false
+          *   @brief Insert object to all Cells it overlaps
+          *   @details Updates object CellRange
+          *   @param object PhysicsObject to be inserted
           */
-        bool ActivateCell(Cell<PhysicsObject*>* cell);
+        void InsertObject(PhysicsObject* object);
 
         /**
-          *   @brief Try to insert object to cell
-          *   @param object PhysicsObject to be inserted
-          *   @return true if successful, otherwise false -> object should be
-          *   inserted to loose_cell
+          *   @brief Remove object from the Cells of its CellRange
+          *   @details Object memory is not deleted
+          *   @param object PhysicsObject to be removed
           */
-        bool insertObject(PhysicsObject* object);
+        void RemoveFromCells(PhysicsObject* object);
 
         /**
-          *   @brief Move loose_cell PhysicsObjects
-          *   @remark This should be called only from moveObjects
+          *   @brief Get Cells overlapped by object
+          *   @param object PhysicsObject to be checked
+          *   @return CellRange, clamped to the grid
           */
-        void moveLooseCellObjects();
+        CellRange GetCellRange(PhysicsObject* object) const;
 
+        /**
+          *   @brief Get Cells overlapped by many objects
+          *   @param objects PhysicsObjects to be checked
+          *   @param count amount of objects
+          *   @param ranges CellRanges are stored here, clamped to the grid
+          */
+        void GetCellRanges(PhysicsObject* const* objects, unsigned count, CellRange* ranges) const;
 
         /**
-          *   @brief Get Cell that matches position
+          *   @brief Get Cell indices matching position
+          *   @details Positions outside the grid are clamped to the border Cells
           *   @param pos position vector
-          *   @return Cell or nullptr if no Cell found
+          *   @param x column index is stored here
+          *   @param y row index is stored here
+          */
+        void CellIndices(const Vector2f pos, int32_t& x, int32_t& y) const;
+
+        /**
+          *   @brief Get Cell indices matching many positions
+          *   @details Branch free, uses the precomputed inverse Cell size
+          *   @param positions position vectors
+          *   @param count amount of positions
+          *   @param x column indices are stored here
+          *   @param y row indices are stored here
+          */
+        void CellIndices(const Vector2f* positions, unsigned count, int32_t* x, int32_t* y) const;
+
+        /**
+          *   @brief Get Cell by its coordinates
+          *   @param x column index, must be inside the grid
+          *   @param y row index, must be inside the grid
+          *   @return Cell pointer
           */
-        Cell<PhysicsObject*>* GetCorrectCell(const Vector2f pos) const;
+        inline Cell<PhysicsObject*>* CellAt(int32_t x, int32_t y) const {
+          if (cell_order == CellOrder::Morton) return &cell_array[MortonCode(x, y)];
+          return &cell_array[y * grid_columns + x];
+        }
+
+        /**
+          *   @brief Interleave bits of Cell coordinates
+          *   @param x column index, at most 16 bits
+          *   @param y row index, at most 16 bits
+          *   @return Morton code, x bits are the even bits
+          */
+        static inline uint32_t MortonCode(uint32_t x, uint32_t y) {
+          return SpreadBits(x) | (SpreadBits(y) << 1);
+        }
+
+        /**
+          *   @brief Spread 16 bits to the even bits
+          *   @param value bits to be spread
+          *   @return spread bits
+          */
+        static inline uint32_t SpreadBits(uint32_t value) {
+          value = (value | (value << 8)) & 0x00ff00ffu;
+          value = (value | (value << 4)) & 0x0f0f0f0fu;
+          value = (value | (value << 2)) & 0x33333333u;
+          value = (value | (value << 1)) & 0x55555555u;
+          return value;
+        }
 
-        std::vector<std::vector<Cell<PhysicsObject*>*>> cells;
-        Cell<PhysicsObject*>* loose_cell = nullptr; /**< Cell for all PhysicsObjects which are not in a single Cell, cells */
+        Cell<PhysicsObject*>* cell_array = nullptr; /**< All Cells as one allocation, in cell_order */
+        unsigned cell_capacity = 0; /**< Allocated Cells, Morton order pads the grid to a square of power of two */
+        int32_t grid_rows = 0; /**< Amount of rows */
+        enum CellOrder::CellOrder cell_order = CellOrder::RowMajor; /**< Memory order of cell_array */
         int gridWidth = 0;
         int gridHeight = 0;
         int gridCellSize = 0;
+        int32_t grid_columns = 0; /**< Cells in one row */
+        float inverse_cell_size = 0.f; /**< 1 / gridCellSize */
+        float half_width = 0.f; /**< Offset from world x coordinate to grid x coordinate */
+        float half_height = 0.f; /**< Offset from world y coordinate to grid y coordinate */
+        float last_column = 0.f; /**< Biggest column index */
+        float last_row = 0.f; /**< Biggest row index */
     };
 
 
@@ -10,9 +10,11 @@
 #include "../utils/Vector2.hpp"
 #include "../include/Shape.hpp"
 #include "../include/PhysicsProperties.hpp"
+#include "../include/ObjectPool.hpp"
 #include <cmath>
 #include <utility>
 #include <cstdint>
+#include <vector>
 
 /**
   *   @namespace pe
@@ -51,6 +53,80 @@ namespace pe {
   };
 
 
+  /**
+    *   @struct CellRange
+    *   @brief Inclusive range of Broadphase Cell coordinates overlapped by PhysicsObject
+    *   @details Maintained by Broadphase. Range is empty when object hasn't
+    *   been added to any Broadphase
+    */
+  struct CellRange {
+    int32_t min_x = 0; /**< smallest Cell x coordinate */
+    int32_t min_y = 0; /**< smallest Cell y coordinate */
+    int32_t max_x = -1; /**< biggest Cell x coordinate */
+    int32_t max_y = -1; /**< biggest Cell y coordinate */
+
+    /**
+      *   @brief Check whether range contains any Cells
+      *   @return true if range is empty, otherwise false
+      */
+    inline bool empty() const {
+      return (min_x > max_x) || (min_y > max_y);
+    }
+
+    /**
+      *   @brief Compare ranges
+      *   @param range CellRange to be compared
+      *   @return true if ranges are equal, otherwise false
+      */
+    inline bool operator==(const CellRange& range) const {
+      return (min_x == range.min_x) && (min_y == range.min_y) && (max_x == range.max_x) && (max_y == range.max_y);
+    }
+
+    /**
+      *   @brief Compare ranges
+      *   @param range CellRange to be compared
+      *   @return true if ranges differ, otherwise false
+      */
+    inline bool operator!=(const CellRange& range) const {
+      return !(*this == range);
+    }
+  };
+
+  /**
+    *   @struct ObjectId
+    *   @brief Unique identifier of PhysicsObject
+    *   @details Every constructed object and every copy takes the next id, so
+    *   ids are not reused when pooled memory is reused
+    */
+  struct ObjectId {
+    uint32_t value; /**< Id of the object */
+
+    /**
+      *   @brief Empty constructor, takes the next id
+      */
+    ObjectId(): value(next()) {}
+
+    /**
+      *   @brief Copy constructor, takes the next id
+      */
+    ObjectId(const ObjectId&): value(next()) {}
+
+    /**
+      *   @brief Assignment operator, keeps the current id
+      *   @return reference to the id
+      */
+    ObjectId& operator=(const ObjectId&) {
+      return *this;
+    }
+
+    /**
+      *   @brief Take the next unused id
+      *   @return id, thread safe
+      */
+    static uint32_t next();
+  };
+
+
   /**
     *   @class PhysicsObject
     *   @brief Abstract class for all objects in the PhysicsWorld
@@ -157,11 +233,23 @@ namespace pe {
         */
       Shape* getShape() const;
 
+      /**
+        *   @brief Replace Shape with an identical copy
+        *   @details Used when the owner of the Shape is copied, mass and the
+        *   cached world vertices are kept
+        *   @param copy Shape equal to the current one
+        */
+      inline void replaceShape(Shape* copy) {
+        shape = copy;
+      }
+
       /**
         *   @brief Get PhysicsProperties of the object
         *   @return physics as reference
         */
-      PhysicsProperties& getPhysics();
+      inline PhysicsProperties& getPhysics() {
+        return physics;
+      }
 
       /**
         *   @brief Set position for object
@@ -169,7 +257,8 @@ namespace pe {
         *   @details position is normally calculated in relation to Shape center of mass.
         *   setOriginTransform to choose arbitrary base point for position
         *   @remark If PhysicsObject is added to PhysicsWorld you need to call
-        *   PhysicsWorld.update() before you try to remove the PhysicsObject
+        *   PhysicsWorld.update() before you try to remove the PhysicsObject.
+        *   Wakes sleeping object
         */
       void setPosition(Vector2f position);
 
@@ -182,13 +271,17 @@ namespace pe {
 
       /**
         *   @brief Get PhysicsObject smallest edge position
-        *   @return Shape min + getPosition
+        *   @details Matches the position used in collision detection, i.e.
+        *   origin_transform is not taken into account
+        *   @return Shape min + physics.position
         */
       Vector2f getMinPosition() const;
 
       /**
         *   @brief Get PhysicsObject biggest edge position
-        *   @return Shape max + getPosition
+        *   @details Matches the position used in collision detection, i.e.
+        *   origin_transform is not taken into account
+        *   @return Shape max + physics.position
         */
       Vector2f getMaxPosition() const;
 
@@ -245,6 +338,25 @@ namespace pe {
         */
       uint8_t getCollisionMask() const;
 
+      /**
+        *   @brief Set whether the object is swept for continuous collision detection
+        *   @details PhysicsWorld stops a moving bullet at the first object its
+        *   step passes through, so fast objects don't tunnel. Only DynamicObjects
+        *   move, so the flag has no effect on StaticObjects
+        *   @param bullet true to sweep the object, false by default
+        */
+      inline void setBullet(bool bullet) {
+        this->bullet = bullet;
+      }
+
+      /**
+        *   @brief Check whether the object is swept for continuous collision detection
+        *   @return bullet
+        */
+      inline bool isBullet() const {
+        return bullet;
+      }
+
       /**
         *   @brief Check if moved
         *   @return moved
@@ -260,6 +372,153 @@ namespace pe {
         this->moved = moved;
       }
 
+      /**
+        *   @brief Get Broadphase Cells the object is stored to
+        *   @return cell_range as reference
+        *   @remark Only Broadphase should modify cell_range
+        */
+      inline CellRange& getCellRange() {
+        return cell_range;
+      }
+
+      /**
+        *   @brief Get indices of the object inside its Cells
+        *   @details One slot per Cell of cell_range in row-major order
+        *   @return cell_slots as reference
+        *   @remark Only Broadphase should modify cell_slots
+        */
+      inline std::vector<uint32_t>& getCellSlots() {
+        return cell_slots;
+      }
+
+      /**
+        *   @brief Get Broadphase proxy index
+        *   @details Used by Broadphases which don't store objects by Cells
+        *   @return proxy as reference
+        *   @remark Only Broadphase should modify proxy
+        */
+      inline uint32_t& getProxy() {
+        return proxy;
+      }
+
+      /**
+        *   @brief Set ObjectPool which owns the memory of the object
+        *   @details Set by PhysicsWorld factory methods
+        *   @param pool owning pool, nullptr for heap allocated objects
+        */
+      inline void setPool(PoolBase* pool) {
+        pool_link.pool = pool;
+      }
+
+      /**
+        *   @brief Get ObjectPool which owns the memory of the object
+        *   @return owning pool, nullptr for heap allocated objects
+        */
+      inline PoolBase* getPool() const {
+        return pool_link.pool;
+      }
+
+      /**
+        *   @brief Get unique id of the object
+        *   @return id, copies have their own ids
+        */
+      inline uint32_t getId() const {
+        return id.value;
+      }
+
+      /**
+        *   @brief Free object
+        *   @details Pooled objects are returned to their ObjectPool, heap
+        *   allocated objects are deleted. Broadphases and StaticGeometry free
+        *   their objects with this
+        *   @param object to be freed
+        */
+      static void destroy(PhysicsObject* object);
+
+      /**
+        *   @brief Check if sleeping
+        *   @details Sleeping objects are not updated and they are checked for
+        *   collisions only against awake objects
+        *   @return sleeping
+        */
+      inline bool isSleeping() const {
+        return sleeping;
+      }
+
+      /**
+        *   @brief Wake sleeping object
+        *   @details Object needs to rest again for the whole sleep period
+        *   before it can fall asleep
+        */
+      void wake();
+
+      /**
+        *   @brief Put object to sleep immediately
+        *   @details Velocity and acceloration are cleared
+        */
+      void sleep();
+
+      /**
+        *   @brief Get amount of successive updates object has been resting
+        *   @return 0 if object moved during the latest updateSleep call
+        */
+      inline unsigned getRestSteps() const {
+        return rest_steps;
+      }
+
+      /**
+        *   @brief Lower resting updates to a limit
+        *   @details PhysicsWorld limits every object of a contact island to
+        *   the least rested object, so that the island falls asleep together
+        *   @param steps largest allowed amount of resting updates
+        */
+      inline void limitRestSteps(unsigned steps) {
+        if (rest_steps > steps) rest_steps = steps;
+      }
+
+      /**
+        *   @brief Update sleep state
+        *   @details Called by PhysicsWorld once per update before updatePhysics.
+        *   Object is resting if its velocity of the latest step
+        *   (physics.collision_velocity) and position change since the previous
+        *   call are below the limits. physics.velocity isn't used, because a
+        *   resting object keeps a velocity that cancels gravity of the step.
+        *   Object falls asleep after resting for steps successive calls
+        *   @param velocity_limit velocity must stay below this
+        *   @param distance_limit position change per update must stay below this
+        *   @param steps successive resting updates needed, 0 disables sleeping
+        *   @return true if object is sleeping
+        */
+      bool updateSleep(float velocity_limit, float distance_limit, unsigned steps);
+
+      /**
+        *   @brief Refresh world space vertices of the Shape
+        *   @details Vertices are recomputed only when physics.position or
+        *   physics.angle has changed since the previous refresh. Called by
+        *   PhysicsWorld once after updatePhysics, and by setPosition and
+        *   collision response
+        *   @remark Not thread safe for the same object
+        */
+      void updateTransform();
+
+      /**
+        *   @brief Check whether world space vertices match current position and angle
+        *   @return true if getWorldVertices can be used in collision detection
+        */
+      inline bool isTransformValid() const {
+        return transform_valid && (transform_position == physics.position) && (transform_angle == physics.angle);
+      }
+
+      /**
+        *   @brief Get world space vertices of the Shape
+        *   @details Shape frame translated by physics.position and rotated by
+        *   physics.angle, as in CollisionDetection::ProjectShape
+        *   @return world_vertices, check isTransformValid before use
+        */
+      inline const std::vector<Vector2f>& getWorldVertices() const {
+        return world_vertices;
+      }
+
       /**
         *   @brief Get object mass
         *   @details if PhysicsProperties.inverse_mass == 0.f returns
@@ -286,6 +545,19 @@ namespace pe {
       No collisions with objects which have smaller collision_masks. 0xFF -> no collisions at all */
       ObjectType::ObjectType type;  /**< PhysicsObject type, either DynamicObject or StaticObject */
       bool moved; /**< Whether PhysicsObject is moved */
+      CellRange cell_range; /**< Broadphase Cells overlapped by PhysicsObject */
+      std::vector<uint32_t> cell_slots; /**< Index of the object inside each Cell of cell_range */
+      uint32_t proxy = 0xFFFFFFFF; /**< Object index inside Broadphase, 0xFFFFFFFF if not set */
+      bool sleeping = false; /**< Whether PhysicsObject is sleeping */
+      bool bullet = false; /**< Whether PhysicsObject is swept against tunnelling */
+      unsigned rest_steps = 0; /**< Successive updates object has been resting */
+      Vector2f rest_position; /**< Position during the previous updateSleep call */
+      std::vector<Vector2f> world_vertices; /**< Cached world space vertices of the Shape */
+      Vector2f transform_position; /**< physics.position when world_vertices were computed */
+      float transform_angle = 0.f; /**< physics.angle when world_vertices were computed */
+      bool transform_valid = false; /**< Whether world_vertices have been computed */
+      PoolLink pool_link; /**< ObjectPool owning the memory, not copied */
+      ObjectId id; /**< Unique id, not copied */
 
 
   };
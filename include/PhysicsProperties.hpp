@@ -73,6 +73,40 @@ namespace pe {
           */
         void applyResistance(float elapsed_time);
 
+        /**
+          *   @brief Get resistance multipliers of the next update
+          *   @details Advances resistance_counter like applyResistance, but
+          *   velocity and acceloration are not modified. Multipliers are 1 when
+          *   resistance is not applied during this update
+          *   @param elapsed_time time elapsed since previous update (in seconds)
+          *   @param velocity_factor velocity multiplier is stored here
+          *   @param acceloration_factor acceloration multiplier is stored here
+          */
+        void resistanceFactors(float elapsed_time, float& velocity_factor, float& acceloration_factor);
+
+        /**
+          *   @brief Advance resistance_counter
+          *   @details Used by resistanceFactors and BodyStore::add
+          *   @return true if resistance is applied during the next update
+          */
+        inline bool advanceResistance() {
+          bool apply = resistance_counter % PhysicsProperties::ResistanceInterval == 0;
+          if (apply) resistance_counter = 0;
+          resistance_counter++;
+          return apply;
+        }
+
+        /**
+          *   @brief Calculate resistance multipliers for applied resistance
+          *   @details Multipliers depend only on the parameters, so they can be
+          *   reused for objects with the same resistance_factor
+          *   @param elapsed_time time elapsed since previous update (in seconds)
+          *   @param resistance_factor resistance_factor of the object
+          *   @param velocity_factor velocity multiplier is stored here
+          *   @param acceloration_factor acceloration multiplier is stored here
+          */
+        static void resistanceMultipliers(float elapsed_time, float resistance_factor, float& velocity_factor, float& acceloration_factor);
+
         /**
           *   @brief Set density value
           *   @details inverse_mass needs to be recalculated after density is changed
@@ -11,11 +11,23 @@
 #include "PhysicsObject.hpp"
 #include "DynamicObject.hpp"
 #include "StaticObject.hpp"
+#include "Broadphase.hpp"
 #include "PhysicsGrid.hpp"
+#include "SpatialHashGrid.hpp"
+#include "SweepAndPrune.hpp"
+#include "AABBTree.hpp"
+#include "StaticGeometry.hpp"
+#include "BodyStore.hpp"
+#include "ObjectPool.hpp"
 #include "CollisionDetection.hpp"
+#include "ContactCache.hpp"
+#include "ContactSolver.hpp"
+#include "IslandBuilder.hpp"
+#include "ThreadPool.hpp"
+#include "TaskScheduler.hpp"
 #include <list>
+#include <vector>
 #include <thread>
-#include <mutex>
 
 /**
   *   @namespace pe
@@ -30,6 +42,7 @@ namespace pe {
   struct Collided {
     PhysicsObject* first; /**< 1st collided object */
     PhysicsObject* second; /**< 2nd collided object */
+    struct CollisionDetection::MTV mtv; /**< Minimum translation vector used in collision response */
 
     /**
       *   @brief Constructor
@@ -39,6 +52,15 @@ namespace pe {
     Collided(PhysicsObject* first, PhysicsObject* second):
               first(first), second(second) {}
 
+    /**
+      *   @brief Constructor
+      *   @param first collided PhysicsObject pointer
+      *   @param second collided PhysicsObject pointer
+      *   @param mtv minimum translation vector returned by CollisionDetection::detectCollision
+      */
+    Collided(PhysicsObject* first, PhysicsObject* second, const struct CollisionDetection::MTV& mtv):
+              first(first), second(second), mtv(mtv) {}
+
     /**
       *   @brief Get index matching PhysicsObject
       *   @param index collided object's index (0 or 1)
@@ -62,19 +84,36 @@ namespace pe {
       */
     enum WorkType {
       UpdateObjects,
-      CheckCollisions
+      CheckCollisions,
+      CheckStaticCollisions
     };
   } // end of namespace WorkType
 
+  /**
+    *   @namespace Scheduling
+    *   @brief Used to avoid namespace collisions with PhysicsWorld method names
+    */
+  namespace Scheduling {
+    /**
+      *   @enum Scheduling
+      *   @brief Describes how PhysicsWorld::DoWork divides work between threads
+      */
+    enum Scheduling {
+      RowPartition, /**< Each thread gets an equal slice of grid Cells (rows for PhysicsGrid) */
+      WorkStealing /**< Each active Cell is a task, idle threads steal tasks (default) */
+    };
+  } // end of namespace Scheduling
+
 
   /**
     *   @class PhysicsWorld
     *   @brief World for PhysicsObject
     *   @details How PhysicsWorld should be used?
-    *   1. Create Dynamic/StaticObjects, set their initial positions, forces etc.
+    *   1. Create Dynamic/StaticObjects (preferably with the factory methods),
+    *   set their initial positions, forces etc.
     *   2. Add Objects to PhysicsWorld
     *   3. Call PhysicsWorld.update() to update Objects' position in the world and their physics
-    *   4. Possibly remove PhysicsObjects which have collided or have some other actions based on getCollided()
+    *   4. Possibly remove PhysicsObjects which have collided or have some other actions based on getContacts()
     *   4. Draw PhysicsObjects
     *   5. Possibly change forces, object positions etc.
     *   6. Repeat process described above
@@ -84,7 +123,9 @@ namespace pe {
     public:
       /**
         *   @brief Set how many worker threads PhysicsEngine uses during PhysicsWorld update
-        *   @remark PhysicsEngine actually uses one more thread which is the main thread
+        *   @remark PhysicsEngine actually uses one more thread which is the main thread.
+        *   Worker threads are persistent: each PhysicsWorld resizes its ThreadPool
+        *   during the next update() call
         *   @param amount needs to be smaller or equal to std::thread::hardware_concurrency
         */
       static void setThreads(unsigned amount);
@@ -99,6 +140,20 @@ namespace pe {
         return THREADS + 1;
       }
 
+      /**
+        *   @brief Set how work is divided between threads
+        *   @param scheduling Scheduling::WorkStealing (default) or Scheduling::RowPartition
+        */
+      static void setScheduling(enum Scheduling::Scheduling scheduling);
+
+      /**
+        *   @brief Get current Scheduling
+        *   @return Scheduling used by all PhysicsWorlds
+        */
+      static inline enum Scheduling::Scheduling getScheduling() {
+        return PhysicsWorld::WorkScheduling;
+      }
+
       /**
         *   @brief Set how many iterations is calculated each second
         *   @details Changes the class variable, PhysicsWorld::IterationsInterval
@@ -114,6 +169,34 @@ namespace pe {
         return 1.f / IterationsInterval;
       }
 
+      /**
+        *   @brief Set when resting DynamicObjects fall asleep
+        *   @details Object is resting when its velocity and its position change
+        *   per update stay below the limits. Object falls asleep after resting
+        *   for steps successive updates, objects of a contact island fall
+        *   asleep together. Sleeping objects are not updated nor moved, and
+        *   they are checked for collisions only against awake objects
+        *   @param velocity velocity limit
+        *   @param distance position change limit
+        *   @param steps successive resting updates needed, 0 disables sleeping
+        */
+      static void setSleepThresholds(float velocity, float distance, unsigned steps);
+
+      /**
+        *   @brief Set memory order of PhysicsGrid Cells
+        *   @details Affects PhysicsWorlds created afterwards with BroadphaseType::Grid
+        *   @param order CellOrder::RowMajor (default) or CellOrder::Morton
+        */
+      static void setCellOrder(enum CellOrder::CellOrder order);
+
+      /**
+        *   @brief Get memory order of PhysicsGrid Cells
+        *   @return CellOrder used by new PhysicsWorlds
+        */
+      static inline enum CellOrder::CellOrder getCellOrder() {
+        return PhysicsWorld::GridCellOrder;
+      }
+
       /**
         *   @brief Constructor
         *   @details Creates PhysicsWorld with PhysicsGrid consisting of empty
@@ -121,21 +204,36 @@ namespace pe {
         */
       PhysicsWorld();
 
+      /**
+        *   @brief Constructor
+        *   @details Creates PhysicsWorld with selected Broadphase
+        *   @param type BroadphaseType::Grid for fixed size PhysicsGrid,
+        *   BroadphaseType::HashGrid for unbounded SpatialHashGrid,
+        *   BroadphaseType::SweepAndPrune for SweepAndPrune or
+        *   BroadphaseType::AABBTree for AABBTree
+        *   @param cellSize size of one Cell, should be clearly bigger than typical
+        *   objects. Not used by SweepAndPrune and AABBTree
+        */
+      PhysicsWorld(enum BroadphaseType::BroadphaseType type, int cellSize = GridCellSize);
+
       /**
         *   @brief Deconstructor
-        *   @details Removes every PhysicsObject, PhysicsGrid and deletes memory
+        *   @details Removes every PhysicsObject, Broadphase and deletes memory
         *   allocated for those
         */
       virtual ~PhysicsWorld();
 
       /**
         *   @brief Copy constructor
+        *   @details Objects are copied to the heap. Shapes created by
+        *   createShape are copied too, so the copy doesn't depend on world
         *   @param world to be copied
         */
       PhysicsWorld(const PhysicsWorld& world);
 
       /**
         *   @brief Assignment operator
+        *   @details Objects and pooled Shapes are copied as in the copy constructor
         *   @param world to be assigned
         *   @return updated reference to the PhysicsWorld
         */
@@ -143,101 +241,446 @@ namespace pe {
 
       /**
         *   @brief Add PhysicsObject to PhysicsWorld
-        *   @details Adds object to the correct PhysicsGrid Cell and starts to
-        *   update its position and collisions when update is called
+        *   @details Adds DynamicObject to the correct Broadphase Cell and starts to
+        *   update its position and collisions when update is called. StaticObject
+        *   is added to StaticGeometry which is rebuilt during the next update
         *   @param object to be added
-        *   @remark PhysicsWorld (PhysicsGrid) takes ownership of the object (must be allocated from heap).
+        *   @remark PhysicsWorld (Broadphase) takes ownership of the object (must be allocated from heap
+        *   or created by the factory methods of this PhysicsWorld).
         *   Remove object by calling removeObject (Do NOT delete object by other ways)
         *   @return true if object added, otherwise false
         */
       bool addObject(PhysicsObject* object);
 
+      /**
+        *   @brief Add many PhysicsObjects at once
+        *   @details Faster than addObject for loading levels: Broadphase
+        *   locations are computed in parallel with the pool threads and Cells
+        *   are filled in one pass. Same ownership rules as addObject
+        *   @param objects objects to be added
+        *   @param count amount of objects
+        *   @return amount of added objects
+        */
+      unsigned addObjects(PhysicsObject* const* objects, unsigned count);
+
       /**
         *   @brief Remove object from PhysicsWorld
         *   @details This is the only correct way to permanently remove objects.
-        *   object is removed from PhysicsGrid and its memory is deleted
+        *   object is removed from Broadphase and its memory is deleted or returned
+        *   to the pool. Objects store their Broadphase location, so Broadphase removal takes
+        *   constant time and works also after the object was moved since the
+        *   latest update. Sleeping objects touching the removed object are woken
+        *   together with the sleeping objects connected to them
         *   @param object to be removed permanently
         *   @return true if object found and removed, otherwise false
         */
       bool removeObject(PhysicsObject* object);
 
+      /**
+        *   @brief Create box Shape from the Shape pool
+        *   @param width box width
+        *   @param height box height
+        *   @return Shape owned by PhysicsWorld, valid until destroyShape or
+        *   PhysicsWorld deconstructor
+        */
+      Shape* createShape(float width, float height);
+
+      /**
+        *   @brief Create copy of Shape to the Shape pool
+        *   @param shape Shape to be copied
+        *   @return Shape owned by PhysicsWorld, valid until destroyShape or
+        *   PhysicsWorld deconstructor
+        */
+      Shape* createShape(const Shape& shape);
+
+      /**
+        *   @brief Return Shape to the Shape pool
+        *   @param shape created by createShape, no object may use it anymore
+        */
+      void destroyShape(Shape* shape);
+
+      /**
+        *   @brief Create DynamicObject from the DynamicObject pool
+        *   @details Pooled objects are used like heap allocated objects: add them
+        *   with addObject and removeObject returns them to the pool. Freed slots
+        *   are reused, so spawning and removing objects doesn't allocate
+        *   @param shape Shape of the object
+        *   @param density 2D density of the object
+        *   @return DynamicObject, not yet added to PhysicsWorld
+        */
+      DynamicObject* createDynamicObject(Shape* shape, float density);
+
+      /**
+        *   @brief Create StaticObject from the StaticObject pool
+        *   @param shape Shape of the object
+        *   @return StaticObject, not yet added to PhysicsWorld
+        */
+      StaticObject* createStaticObject(Shape* shape);
+
+      /**
+        *   @brief Free object which hasn't been added to PhysicsWorld
+        *   @details Added objects are freed by removeObject
+        *   @param object created by the factory methods or allocated from heap
+        */
+      void destroyObject(PhysicsObject* object);
+
+      /**
+        *   @brief Get amount of pooled objects alive
+        *   @return DynamicObjects and StaticObjects created by the factory
+        *   methods and not yet freed
+        */
+      inline unsigned getPooledAmount() const {
+        return dynamic_pool.size() + static_pool.size();
+      }
+
+      /**
+        *   @brief Rebuild StaticGeometry
+        *   @details StaticObjects are not tracked after they are added. This
+        *   must be called after StaticObjects are moved, adding and removing
+        *   StaticObjects rebuilds automatically
+        */
+      void rebuildStatics();
+
       /**
         *   @brief Update PhysicsWorld
-        *   @details This should be called periodically. Currently no support for
-        *   real time collision detection (fast moving objects will go through each
-        *   other)
-        *   @remark This is should be called before calling getCollided()
+        *   @details This should be called periodically. Objects flagged with
+        *   PhysicsObject::setBullet are swept against other objects each step,
+        *   other fast moving objects can still go through each other
+        *   @remark This is should be called before calling getContacts() or getCollided()
         */
       void update();
 
+      /**
+        *   @brief Get collided PhysicsObjects as a contiguous vector
+        *   @details Each entry in the vector is struct Collided. Prefer this over
+        *   getCollided(): it doesn't allocate and it's cache friendly to iterate
+        *   @return contacts
+        *   @remark contacts is updated when update is called
+        */
+      std::vector<struct Collided>& getContacts();
+
       /**
         *   @brief Get list of collied PhysicsObjects
-        *   @details Each entry in the list is struct Collided
+        *   @details Each entry in the list is struct Collided. The list is built
+        *   from contacts on the first call after update
         *   @return collided
         *   @remark collided is updated when update is called
         */
       std::list<struct Collided>& getCollided();
 
+      /**
+        *   @brief Get contact transitions of the latest update
+        *   @details Pairs are tracked across updates by object ids, so callers
+        *   don't need to diff contacts themselves. Pairs of sleeping objects
+        *   persist without events, pairs of removed objects end without events
+        *   @return Begin and Persist events in contacts order, followed by End events
+        *   @remark events are updated when update is called
+        */
+      const std::vector<struct ContactEvent>& getContactEvents() const;
+
+      /**
+        *   @brief Get velocity iterations used by the latest update
+        *   @details Each contact island is solved separately, solver settings
+        *   are in ContactSolver
+        *   @return most iterations used by an island, 0 if nothing was in contact
+        */
+      inline unsigned getSolverIterations() const {
+        return solver_iterations;
+      }
+
+      /**
+        *   @brief Get amount of contact islands of the latest update
+        *   @details Island is a group of DynamicObjects connected by contacts,
+        *   StaticObjects don't connect islands
+        *   @return islands solved during the latest update
+        */
+      inline unsigned getIslandAmount() const {
+        return islands.size();
+      }
+
+      /**
+        *   @brief Find PhysicsObjects whose bounds overlap region
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        *   @remark Every BroadphaseType checks only nearby objects, StaticGeometry uses its hierarchy
+        */
+      void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects);
+
+      /**
+        *   @brief Find PhysicsObjects whose bounds a line segment hits
+        *   @param from start point of the segment
+        *   @param to end point of the segment
+        *   @param objects found objects are appended here, the closest first
+        *   @remark Fast with BroadphaseType::AABBTree, other Broadphases check all objects
+        */
+      void queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects);
+
+      /**
+        *   @brief Get amount of awake DynamicObjects
+        *   @return awake objects during the latest update
+        */
+      inline unsigned getAwakeAmount() const {
+        return awake_amount;
+      }
+
+      /**
+        *   @brief Get amount of sleeping DynamicObjects
+        *   @return sleeping objects during the latest update
+        */
+      inline unsigned getSleepingAmount() const {
+        return sleeping_amount;
+      }
+
+      /**
+        *   @brief Get BroadphaseType of the PhysicsWorld
+        *   @return broadphase_type
+        */
+      inline enum BroadphaseType::BroadphaseType getBroadphaseType() const {
+        return broadphase_type;
+      }
+
     private:
       // Class members
       static const int GridCellSize;
+      static const unsigned ContactBufferReserve; /**< Initial capacity of each contact buffer */
+      static const unsigned PairTaskSize; /**< Amount of Broadphase pairs checked by one task */
+      static const unsigned IslandTaskSize; /**< Least amount of contacts solved by one island task */
+      static const unsigned BodyBatchSize; /**< Amount of DynamicObjects integrated at once by UpdateCell */
+      static const float BulletOverlap; /**< Penetration left to a swept bullet at the time of impact */
       static unsigned THREADS;
       static int WorldWidth;
       static int WorldHeight;
       static float IterationsInterval;
+      static enum Scheduling::Scheduling WorkScheduling;
+      static float SleepVelocity; /**< Velocity limit for resting objects */
+      static float SleepDistance; /**< Position change limit for resting objects */
+      static unsigned SleepSteps; /**< Resting updates before object falls asleep, 0 disables sleeping */
+      static enum CellOrder::CellOrder GridCellOrder; /**< Memory order of PhysicsGrid Cells */
 
       // Private functions
       /**
-        *   @brief Init grid to contain empty Cells
-        *   @details This should be called from constructor to init grid
+        *   @brief Create Broadphase containing empty Cells
+        *   @details This should be called from constructor to init broadphase
+        *   @param cellSize size of one Cell
         */
-      void InitGrid();
+      void InitGrid(int cellSize);
 
       /**
-        *   @brief Start threads to do specified work
+        *   @brief Give copied objects their own copies of pooled Shapes
+        *   @details Called after copying objects from world, whose shape_pool
+        *   is not shared. Shapes outside the pool stay shared
+        *   @param world copied PhysicsWorld
+        */
+      void CopyShapes(const PhysicsWorld& world);
+
+      /**
+        *   @brief Wake pool threads to do specified work
+        *   @details Returns after all threads have finished the work
         *   @param worktype WorkType describing whether PhysicsObjects should be
         *   updated or collisions checked
         */
       void DoWork(enum WorkType::WorkType worktype);
 
       /**
-        *   @brief Update PhysicsObjects
-        *   @details Updates objects which are in the specific Cells given with
-        *   iterators. Calls updatePhysics for DynamicObjects
-        *   @param begin iterator to the first vector of the 2d Cell container
-        *   @param end iterator which must not be updated anymore (1st dimension)
+        *   @brief Divide work by equal slices of all Cells
+        *   @details Used when WorkScheduling is Scheduling::RowPartition. For
+        *   PhysicsGrid a slice consists of grid rows
+        *   @param worktype WorkType describing the work
+        *   @return false if there are too few Cells for the threads (work not done)
         */
-      void UpdateObjects(std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator begin, std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator end);
+      bool DoRowPartitionWork(enum WorkType::WorkType worktype);
 
       /**
-        *   @brief Update loose_cell PhysicsObjects
-        *   @details Calls updatePhysics for DynamicObjects
+        *   @brief Run work as one task per active Cell using TaskScheduler
+        *   @details Used when WorkScheduling is Scheduling::WorkStealing.
+        *   Inactive Cells contain only StaticObjects and they are skipped
+        *   @param worktype WorkType describing the work
         */
-      void UpdateLooseObjects();
+      void DoCellTaskWork(enum WorkType::WorkType worktype);
 
       /**
-        *   @brief Check collisions between PhysicsObjects
-        *   @details Goes through all objects that are located in same grid cell
-        *   or are lose (these can also collide). Calls CollisionDetection::canCollide
-        *   Updates also collided based on return value of canCollide
-        *   @param begin iterator to grid vector 1st dimension
-        *   @param end iterator to grid vector 1st dimension which must not be checked
-        *   @remark O*N^2 complexity, multithread support
+        *   @brief Check collisions of Broadphase pairs
+        *   @details Used when Broadphase produces pairs. Pairs are divided to
+        *   tasks of PairTaskSize pairs which are run with TaskScheduler
+        */
+      void DoPairWork();
+
+      /**
+        *   @brief Merge per thread contact_buffers to contacts
+        *   @details Buffers are merged in thread index order and cleared
+        *   (their capacity is kept for the next update)
+        */
+      void MergeContacts();
+
+      /**
+        *   @brief Integrate DynamicObjects left in body_stores
+        *   @details Every pool thread integrates the last partial batch of its
+        *   own BodyStore and stores the results back to the objects. Objects
+        *   which moved are appended to the moved buffer of the thread
+        */
+      void IntegrateBodies();
+
+      /**
+        *   @brief Merge per thread moved_buffers to moved
+        *   @details Buffers are cleared, their capacity is kept for the next update
+        */
+      void MergeMoved();
+
+      /**
+        *   @brief Stop moved bullet objects at their first time of impact
+        *   @details Swept bounds of each moved bullet are queried from the
+        *   Broadphase and StaticGeometry, and the candidates are tested with
+        *   CollisionDetection::sweepCollision. Other objects are treated as
+        *   stationary at their new positions. Bullet is moved back to
+        *   BulletOverlap inside the first object it hits, its velocity is left
+        *   to the contact solver. Only bullets pay for the sweep, other moved
+        *   objects are just skipped
+        */
+      void SweepBullets();
+
+      /**
+        *   @brief Apply collision response to all contacts
+        *   @details Done after the collision phase: the same object may be in
+        *   many Cells which are checked concurrently. Sleeping object is woken
+        *   by a moving object and resting object which touches a sleeping
+        *   object falls asleep as well. Remaining contacts are partitioned to
+        *   islands, which are solved concurrently by SolveIslands. Islands of
+        *   at least ContactSolver colouring limit contacts are solved one at a
+        *   time, each by all threads. Moved DynamicObjects are flagged so the
+        *   next update rebins them
+        */
+      void ResolveContacts();
+
+      /**
+        *   @brief Solve small contact islands
+        *   @param begin index of the first island in small_islands
+        *   @param end index in small_islands which must not be solved anymore
+        *   @param thread index of the executing thread, selects ContactSolver
+        */
+      void SolveIslands(unsigned begin, unsigned end, unsigned thread);
+
+      /**
+        *   @brief Solve one contact island
+        *   @details Contacts of the island are solved together by the
+        *   ContactSolver of the thread, warm started from the Manifolds in
+        *   contact_cache. Objects of an island rest as long as the least
+        *   rested of them, so the whole island falls asleep at once. Contacts
+        *   of coloured islands are ordered by object ids, so the result doesn't
+        *   depend on the order the threads found them
+        *   @param island island index in islands
+        *   @param thread index of the executing thread, selects ContactSolver
+        *   @param pool threads sharing a coloured island, nullptr inside pool jobs
+        */
+      void SolveIsland(unsigned island, unsigned thread, ThreadPool* pool);
+
+      /**
+        *   @brief Update PhysicsObjects of one Cell
+        *   @details Gathers DynamicObjects whose home Cell is cell to the
+        *   BodyStore of the thread, so objects overlapping multiple Cells are
+        *   integrated once. Full batches of BodyBatchSize objects are integrated
+        *   and stored right away, so the objects are not loaded twice from
+        *   memory. Sleeping objects are skipped
+        *   @param cell Cell to be updated
+        *   @param thread index of the executing thread, selects BodyStore
+        */
+      void UpdateCell(Cell<PhysicsObject*>* cell, unsigned thread);
+
+      /**
+        *   @brief Check collisions between PhysicsObjects of one Cell
+        *   @details Only pairs owned by cell are checked, see ownsPair
+        *   @param cell Cell to be checked
+        *   @param thread index of the executing thread, selects contact buffer
+        */
+      void CheckCellCollisions(Cell<PhysicsObject*>* cell, unsigned thread);
+
+      /**
+        *   @brief Check collisions between Broadphase pairs
+        *   @details Checks pairs[begin, end) with the batched
+        *   CollisionDetection::detectCollisions and stores collided objects to
+        *   the contact buffer of the thread
+        *   @param begin index of the first pair
+        *   @param end index of the pair which must not be checked anymore
+        *   @param thread index of the executing thread, selects contact buffer
+        */
+      void CheckPairs(unsigned begin, unsigned end, unsigned thread);
+
+      /**
+        *   @brief Check collisions between DynamicObjects of one Cell and StaticGeometry
+        *   @details Each DynamicObject queries StaticGeometry in its home Cell
+        *   @param cell Cell to be checked
+        *   @param thread index of the executing thread, selects contact buffer
+        */
+      void CheckStaticCellCollisions(Cell<PhysicsObject*>* cell, unsigned thread);
+
+      /**
+        *   @brief Check collisions between DynamicObjects and StaticGeometry
+        *   @details Goes through Cells in cell_tasks[begin, end)
+        *   @param begin index of the first Cell in cell_tasks
+        *   @param end index of the Cell which must not be checked anymore
+        *   @param thread index of the executing thread, selects contact buffer
         */
-      void CheckCollisions(std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator begin, std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator end);
+      void CheckStaticCollisions(unsigned begin, unsigned end, unsigned thread);
 
       /**
-        *   @brief Check collisions for the loose PhysicsObjects
-        *   @details Loose objects can collided with any objects (loose or not loose).
-        *   Updates collided based on return values of CollisionDetection::canCollide
-        *   @remark O*N^2 complexity, this cannot be multithreaded
+        *   @brief Update PhysicsObjects
+        *   @details Updates objects which are in cell_tasks[begin, end).
+        *   Calls updatePhysics for DynamicObjects
+        *   @param begin index of the first Cell in cell_tasks
+        *   @param end index of the Cell which must not be updated anymore
+        *   @param thread index of the executing thread, selects moved buffer
+        */
+      void UpdateObjects(unsigned begin, unsigned end, unsigned thread);
+
+      /**
+        *   @brief Check collisions between PhysicsObjects
+        *   @details Goes through all objects that are located in same grid cell
+        *   in cell_tasks[begin, end). Calls CollisionDetection::detectCollision
+        *   and stores collided objects to the contact buffer of the thread
+        *   @param begin index of the first Cell in cell_tasks
+        *   @param end index of the Cell which must not be checked anymore
+        *   @param thread index of the executing thread, selects contact buffer
+        *   @remark O*N^2 complexity, multithread support
         */
-      void CheckLooseCollisions();
+      void CheckCollisions(unsigned begin, unsigned end, unsigned thread);
 
       // Instance variables
-      PhysicsGrid* grid;
-      std::list<struct Collided> collided;
-      std::mutex collided_mutex;
+      enum BroadphaseType::BroadphaseType broadphase_type; /**< Type of broadphase */
+      Broadphase* broadphase; /**< Contains DynamicObjects, selected by broadphase_type */
+      ObjectPool<Shape> shape_pool; /**< Shapes created by createShape */
+      ObjectPool<DynamicObject> dynamic_pool; /**< DynamicObjects created by createDynamicObject */
+      ObjectPool<StaticObject> static_pool; /**< StaticObjects created by createStaticObject, must outlive statics */
+      StaticGeometry statics; /**< Contains StaticObjects */
+      ThreadPool* pool; /**< Persistent worker threads, resized to THREADS in update() */
+      TaskScheduler* scheduler; /**< Work-stealing scheduler running on pool threads */
+      std::vector<Cell<PhysicsObject*>*> cell_tasks; /**< Cells of the current phase, reused between updates */
+      std::vector<struct ObjectPair> pairs; /**< Broadphase pairs of the current update, reused between updates */
+      std::vector<std::vector<struct Collided>> contact_buffers; /**< One contact buffer per thread, no locking needed */
+      std::vector<std::vector<PhysicsObject*>> static_queries; /**< One StaticGeometry query result per thread */
+      std::vector<std::vector<std::pair<unsigned, struct CollisionDetection::MTV>>> pair_hits; /**< One detectCollisions result per thread */
+      std::vector<BodyStore> body_stores; /**< DynamicObjects gathered by each thread for integration */
+      std::vector<std::vector<PhysicsObject*>> moved_buffers; /**< Objects moved by each thread during the update phase */
+      std::vector<PhysicsObject*> moved; /**< Merged moved_buffers, passed to Broadphase moveObjects */
+      std::vector<unsigned> awake_counts; /**< Awake objects found by each thread */
+      std::vector<unsigned> sleeping_counts; /**< Sleeping objects found by each thread */
+      unsigned awake_amount = 0; /**< Awake DynamicObjects during the latest update */
+      unsigned sleeping_amount = 0; /**< Sleeping DynamicObjects during the latest update */
+      std::vector<struct Collided> contacts; /**< Merged contact_buffers of the latest update */
+      std::list<struct Collided> collided; /**< contacts as a list, built by getCollided() */
+      bool collided_valid = false; /**< Whether collided matches contacts */
+      ContactCache contact_cache; /**< Touching pairs across updates, not copied */
+      IslandBuilder islands; /**< Contact islands of the latest update, not copied */
+      std::vector<unsigned> small_islands; /**< Islands solved by one thread each */
+      std::vector<unsigned> large_islands; /**< Islands coloured and solved by all threads */
+      std::vector<PhysicsObject*> swept; /**< Bullets moved back by SweepBullets */
+      std::vector<PhysicsObject*> bullet_candidates; /**< Objects overlapping the swept bounds of a bullet */
+      std::vector<std::pair<uint64_t, unsigned>> ordered_contacts; /**< Id pair and contact number of a large island in solving order */
+      std::vector<unsigned> island_tasks; /**< First index in small_islands of each solve task, one extra at the end */
+      std::vector<unsigned> resolved; /**< Index in contacts of each island contact */
+      std::vector<struct CollisionDetection::Manifold*> manifolds; /**< Cached Manifold of each island contact */
+      std::vector<ContactSolver> solvers; /**< One ContactSolver per thread, not copied */
+      std::vector<unsigned> iteration_counts; /**< Most iterations of an island solved by each thread */
+      unsigned solver_iterations = 0; /**< Most iterations of an island during the latest update */
 
   };
 
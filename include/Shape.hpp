@@ -18,6 +18,22 @@
   *   @remark Stands for PhysicsEngine
   */
 namespace pe {
+
+  /**
+    *   @namespace ShapeType
+    *   @brief Used to avoid namespace collisions with Shape method names
+    */
+  namespace ShapeType {
+    /**
+      *   @enum ShapeType
+      *   @brief Kind of the Shape, selects collision detection path
+      */
+    enum ShapeType {
+      Polygon, /**< Generic polygon, checked with separating axis theorem */
+      Box /**< Axis aligned box created by Shape(width, height) */
+    };
+  } // end of namespace ShapeType
+
   /**
     *   @class Shape
     *   @brief Contains PhysicsObject shape (polygon)
@@ -117,6 +133,15 @@ namespace pe {
           */
         float getHeight() const;
 
+        /**
+          *   @brief Get kind of the Shape
+          *   @return ShapeType::Box for Shapes created with Shape(width, height)
+          *   and their copies, otherwise ShapeType::Polygon
+          */
+        inline enum ShapeType::ShapeType getType() const {
+          return type;
+        }
+
 
       private:
 
@@ -154,6 +179,7 @@ namespace pe {
         Vector2f* max = nullptr; /**< Should point to the biggest entry in frame */
         Vector2f* min = nullptr; /**< Should point to the smallest entry in frame */
         float area; /**< Area of the Spape */
+        enum ShapeType::ShapeType type = ShapeType::Polygon; /**< Kind of the Shape */
 
     };
 }// end of namespace pe
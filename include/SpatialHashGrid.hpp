@@ -0,0 +1,248 @@
+/**
+  *   @file SpatialHashGrid.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class SpatialHashGrid
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "DynamicObject.hpp"
+#include "StaticObject.hpp"
+#include "Broadphase.hpp"
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class SpatialHashGrid
+    *   @brief Unbounded grid which stores only occupied Cells
+    *   @details Cells are identified by integer cell coordinates. Coordinates are
+    *   mapped to Cells with an open addressing hash table (linear probing) and
+    *   Cells themselves are stored in one vector, so no heap node is allocated
+    *   per Cell. Objects which overlap multiple Cells are stored to all of them
+    *   like in PhysicsGrid. SpatialHashGrid takes ownership of PhysicsObjects
+    */
+  class SpatialHashGrid: public Broadphase
+  {
+    public:
+      static constexpr float DefaultCellSize = 5000.f; /**< Cell size used by the empty constructor */
+
+      /**
+        *   @brief Empty constructor, uses DefaultCellSize
+        */
+      SpatialHashGrid();
+
+      /**
+        *   @brief Constructor
+        *   @param cellSize width and height of one Cell, abs is taken and 0 is
+        *   replaced by DefaultCellSize
+        */
+      SpatialHashGrid(float cellSize);
+
+      /**
+        *   @brief Deconstructor
+        *   @details Deletes all PhysicsObjects
+        */
+      virtual ~SpatialHashGrid();
+
+      /**
+        *   @brief Copy constructor, makes a hard copy
+        *   @param grid SpatialHashGrid to be copied
+        */
+      SpatialHashGrid(const SpatialHashGrid& grid);
+
+      /**
+        *   @brief Assignment operator, makes a hard copy
+        *   @param grid SpatialHashGrid to be copied
+        *   @return reference to this
+        */
+      SpatialHashGrid& operator=(const SpatialHashGrid& grid);
+
+      /**
+        *   @brief Make a hard copy of SpatialHashGrid
+        *   @return new SpatialHashGrid, caller takes ownership
+        */
+      virtual Broadphase* clone() const override;
+
+      /**
+        *   @brief Add PhysicsObject to all Cells it overlaps
+        *   @details Cells are created if they don't exist yet
+        *   @param object to be added
+        *   @return true, object can always be added
+        */
+      virtual bool addObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Compute CellRanges of objects
+        *   @param objects objects passed later to addObjects
+        *   @param begin index of the first object
+        *   @param end index of the object which must not be located anymore
+        */
+      virtual void locateObjects(PhysicsObject* const* objects, unsigned begin, unsigned end) const override;
+
+      /**
+        *   @brief Add many located PhysicsObjects at once
+        *   @details Hash table and Cell array are grown once for the whole batch
+        *   instead of rehashing repeatedly. Objects keep their order inside each Cell
+        *   @param objects objects to be added, see locateObjects
+        *   @param count amount of objects
+        *   @return count, objects can always be added
+        */
+      virtual unsigned addObjects(PhysicsObject* const* objects, unsigned count) override;
+
+      /**
+        *   @brief Remove PhysicsObject and delete it
+        *   @details Object is removed from the Cells stored in its CellRange
+        *   @param object to be removed
+        *   @return true if object found and removed, otherwise false
+        */
+      virtual bool removeObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Move listed objects to correct Cells
+        *   @details Empty Cells are released when there are clearly more
+        *   empty than occupied Cells
+        *   @param moved objects whose position may have changed
+        */
+      virtual void moveObjects(const std::vector<PhysicsObject*>& moved) override;
+      using Broadphase::moveObjects;
+
+      /**
+        *   @brief Append Cells to cells
+        *   @param cells vector where Cells are appended
+        *   @param active_only if true, only active Cells are appended
+        *   @remark Pointers are valid until the next addObject or moveObjects call
+        */
+      virtual void collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) override;
+
+      /**
+        *   @brief Find objects whose bounds overlap region
+        *   @details Visits only the Cells overlapped by region, falls back to
+        *   checking all Cells when region covers more Cells than are allocated
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      virtual void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) override;
+
+      /**
+        *   @brief Get Cell size
+        *   @return cellSize
+        */
+      inline float getCellSize() const {
+        return cellSize;
+      }
+
+      /**
+        *   @brief Get amount of allocated Cells
+        *   @return cells.size()
+        */
+      inline unsigned getCellAmount() const {
+        return cells.size();
+      }
+
+    private:
+      /**
+        *   @struct Slot
+        *   @brief One entry of the open addressing table
+        */
+      struct Slot {
+        int32_t x; /**< Cell x coordinate */
+        int32_t y; /**< Cell y coordinate */
+        uint32_t cell; /**< Index to cells, EmptySlot if unused */
+      };
+
+      static const uint32_t EmptySlot = 0xFFFFFFFF; /**< Marks unused Slot */
+      static const unsigned MinTableSize = 64; /**< Table size is power of two and at least this */
+
+      /**
+        *   @brief Convert position to integer Cell coordinates
+        *   @param pos position in PhysicsWorld
+        *   @param x Cell x coordinate is stored here
+        *   @param y Cell y coordinate is stored here
+        */
+      void CellCoordinates(const Vector2f pos, int32_t& x, int32_t& y) const;
+
+      /**
+        *   @brief Find Cell index
+        *   @param x Cell x coordinate
+        *   @param y Cell y coordinate
+        *   @return index to cells or EmptySlot if Cell doesn't exist
+        */
+      uint32_t FindCell(int32_t x, int32_t y) const;
+
+      /**
+        *   @brief Find Cell index, Cell is created if it doesn't exist
+        *   @param x Cell x coordinate
+        *   @param y Cell y coordinate
+        *   @return index to cells
+        */
+      uint32_t GetOrCreateCell(int32_t x, int32_t y);
+
+      /**
+        *   @brief Hash Cell coordinates
+        *   @param x Cell x coordinate
+        *   @param y Cell y coordinate
+        *   @return hash value
+        */
+      static uint32_t Hash(int32_t x, int32_t y);
+
+      /**
+        *   @brief Rebuild table with new size
+        *   @param size new table size, must be power of two
+        */
+      void Rehash(unsigned size);
+
+      /**
+        *   @brief Release empty Cells and rebuild table
+        */
+      void Compact();
+
+      /**
+        *   @brief Insert object to all Cells it overlaps
+        *   @details Updates object CellRange
+        *   @param object to be inserted
+        */
+      void InsertObject(PhysicsObject* object);
+
+      /**
+        *   @brief Remove object from the Cells of its CellRange
+        *   @details Object memory is not deleted
+        *   @param object to be removed
+        */
+      void RemoveFromCells(PhysicsObject* object);
+
+      /**
+        *   @brief Get Cells overlapped by object
+        *   @param object PhysicsObject to be checked
+        *   @return CellRange
+        */
+      CellRange GetCellRange(PhysicsObject* object) const;
+
+      /**
+        *   @brief Delete all PhysicsObjects and Cells
+        */
+      void Clear();
+
+      /**
+        *   @brief Copy grid, allocates new PhysicsObjects
+        *   @param grid SpatialHashGrid to be copied
+        */
+      void Copy(const SpatialHashGrid& grid);
+
+      float cellSize; /**< Width and height of one Cell */
+      float inverseCellSize; /**< 1 / cellSize */
+      std::vector<Slot> table; /**< Open addressing table, size is power of two */
+      std::vector<Cell<PhysicsObject*>> cells; /**< Occupied Cells */
+      unsigned empty_cells = 0; /**< Amount of Cells without entities */
+  };
+
+} // end of namespace pe
@@ -0,0 +1,182 @@
+/**
+  *   @file StaticGeometry.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class StaticGeometry
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "StaticObject.hpp"
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class StaticGeometry
+    *   @brief Immutable acceleration structure for StaticObjects
+    *   @details StaticObjects never move, so they are kept apart from the
+    *   Broadphase which is updated every step. Objects are bulk built to a
+    *   packed bounding volume hierarchy which is only queried by DynamicObjects.
+    *   Adding or removing objects marks the hierarchy dirty and it must be
+    *   rebuilt before the next query. StaticGeometry takes ownership of the
+    *   objects
+    */
+  class StaticGeometry
+  {
+    public:
+      static const unsigned LeafSize = 4; /**< Maximum amount of objects in one leaf */
+
+      /**
+        *   @brief Empty constructor
+        */
+      StaticGeometry();
+
+      /**
+        *   @brief Deconstructor
+        *   @details Deletes all StaticObjects
+        */
+      virtual ~StaticGeometry();
+
+      /**
+        *   @brief Copy constructor, makes a hard copy
+        *   @param geometry StaticGeometry to be copied
+        */
+      StaticGeometry(const StaticGeometry& geometry);
+
+      /**
+        *   @brief Assignment operator, makes a hard copy
+        *   @param geometry StaticGeometry to be copied
+        *   @return reference to this
+        */
+      StaticGeometry& operator=(const StaticGeometry& geometry);
+
+      /**
+        *   @brief Add StaticObject, marks hierarchy dirty
+        *   @param object to be added
+        *   @return true if object added, false if object is not a StaticObject
+        */
+      bool addObject(PhysicsObject* object);
+
+      /**
+        *   @brief Remove StaticObject and delete it, marks hierarchy dirty
+        *   @param object to be removed
+        *   @return true if object found and removed, otherwise false
+        */
+      bool removeObject(PhysicsObject* object);
+
+      /**
+        *   @brief Build the hierarchy from current object bounds
+        *   @details Needs to be called after objects are added, removed or moved
+        */
+      void rebuild();
+
+      /**
+        *   @brief Check whether hierarchy needs rebuild
+        *   @return true if objects have been added or removed after the latest rebuild
+        */
+      inline bool isDirty() const {
+        return dirty;
+      }
+
+      /**
+        *   @brief Find objects whose bounds overlap region
+        *   @details Safe to call from multiple threads at the same time
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) const;
+
+      /**
+        *   @brief Find objects whose bounds a line segment hits
+        *   @param from start point of the segment
+        *   @param to end point of the segment
+        *   @param hits pairs of hit distance and object are appended here, unsorted
+        */
+      void queryRay(const Vector2f from, const Vector2f to, std::vector<std::pair<float, PhysicsObject*>>& hits) const;
+
+      /**
+        *   @brief Get amount of objects
+        *   @return amount of StaticObjects
+        */
+      inline unsigned getObjectAmount() const {
+        return objects.size();
+      }
+
+      /**
+        *   @brief Get all objects, also those added after the latest rebuild
+        *   @return objects in the added order
+        */
+      inline const std::vector<PhysicsObject*>& getObjects() const {
+        return objects;
+      }
+
+      /**
+        *   @brief Get amount of hierarchy nodes
+        *   @return node amount of the latest rebuild
+        */
+      inline unsigned getNodeAmount() const {
+        return nodes.size();
+      }
+
+    private:
+      static const unsigned MaxDepth = 64; /**< Size of the traversal stack */
+
+      /**
+        *   @struct Item
+        *   @brief Object bounds stored in leaf order
+        */
+      struct Item {
+        Vector2f min; /**< smallest corner of the object */
+        Vector2f max; /**< biggest corner of the object */
+        PhysicsObject* object; /**< The object */
+      };
+
+      /**
+        *   @struct Node
+        *   @brief Node of the packed hierarchy
+        *   @details Nodes are stored depth first, so the left child of an internal
+        *   node is the next node and only the right child is stored
+        */
+      struct Node {
+        Vector2f min; /**< smallest corner of the node bounds */
+        Vector2f max; /**< biggest corner of the node bounds */
+        uint32_t first; /**< First item of a leaf, right child of an internal node */
+        uint32_t count; /**< Amount of items of a leaf, 0 for internal nodes */
+      };
+
+      /**
+        *   @brief Build subtree from items[begin, end)
+        *   @param begin first item
+        *   @param end item after the last item
+        *   @param depth depth of the subtree root
+        */
+      void Build(uint32_t begin, uint32_t end, unsigned depth);
+
+      /**
+        *   @brief Delete all objects
+        */
+      void Clear();
+
+      /**
+        *   @brief Copy objects, allocates new StaticObjects
+        *   @param geometry StaticGeometry to be copied
+        */
+      void Copy(const StaticGeometry& geometry);
+
+      std::vector<PhysicsObject*> objects; /**< Owned objects, PhysicsObject proxy is the index */
+      std::vector<Item> items; /**< Object bounds in leaf order */
+      std::vector<Node> nodes; /**< Packed hierarchy, the first node is the root */
+      bool dirty = false; /**< Whether rebuild is needed */
+  };
+
+} // end of namespace pe
@@ -0,0 +1,186 @@
+/**
+  *   @file SweepAndPrune.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class SweepAndPrune
+  */
+
+#pragma once
+
+#include "../utils/Vector2.hpp"
+#include "PhysicsObject.hpp"
+#include "DynamicObject.hpp"
+#include "StaticObject.hpp"
+#include "Broadphase.hpp"
+#include "ObjectBuckets.hpp"
+#include <vector>
+#include <cstdint>
+
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class SweepAndPrune
+    *   @brief Broadphase which sorts object bounds along x axis
+    *   @details Min and max x of every object are stored to one persistent
+    *   endpoint array. Objects move only a little between updates, so the array
+    *   is kept sorted with insertion sort which is close to linear time. Added
+    *   objects are sorted separately and merged, so bulk loads stay O(N log N). Sweeping
+    *   the array gives pairs overlapping on x axis, y overlap is checked from
+    *   the stored bounds. Works well when object sizes vary a lot because there
+    *   is no Cell size to tune. Objects are also stored to ObjectBuckets which
+    *   are used as Cells when objects are updated.
+    *   SweepAndPrune takes ownership of PhysicsObjects
+    */
+  class SweepAndPrune: public Broadphase
+  {
+    public:
+      /**
+        *   @brief Empty constructor
+        */
+      SweepAndPrune();
+
+      /**
+        *   @brief Deconstructor
+        *   @details Deletes all PhysicsObjects
+        */
+      virtual ~SweepAndPrune();
+
+      /**
+        *   @brief Copy constructor, makes a hard copy
+        *   @param sap SweepAndPrune to be copied
+        */
+      SweepAndPrune(const SweepAndPrune& sap);
+
+      /**
+        *   @brief Assignment operator, makes a hard copy
+        *   @param sap SweepAndPrune to be copied
+        *   @return reference to this
+        */
+      SweepAndPrune& operator=(const SweepAndPrune& sap);
+
+      /**
+        *   @brief Make a hard copy of SweepAndPrune
+        *   @return new SweepAndPrune, caller takes ownership
+        */
+      virtual Broadphase* clone() const override;
+
+      /**
+        *   @brief Add PhysicsObject
+        *   @details Endpoints are sorted during the next moveObjects or collectPairs
+        *   @param object to be added
+        *   @return true, object can always be added
+        */
+      virtual bool addObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Remove PhysicsObject and delete it
+        *   @details O(1), endpoints of the object are dropped during the next sort
+        *   @param object to be removed
+        *   @return true if object found and removed, otherwise false
+        */
+      virtual bool removeObject(PhysicsObject* object) override;
+
+      /**
+        *   @brief Update bounds of listed objects and sort endpoints
+        *   @param moved objects whose position may have changed
+        */
+      virtual void moveObjects(const std::vector<PhysicsObject*>& moved) override;
+      using Broadphase::moveObjects;
+
+      /**
+        *   @brief Append bucket Cells to cells
+        *   @param cells vector where Cells are appended
+        *   @param active_only if true, only buckets containing DynamicObjects are appended
+        */
+      virtual void collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) override;
+
+      /**
+        *   @brief Append pairs with overlapping bounds to pairs
+        *   @details Pairs where neither object is active are skipped, see isActive
+        *   @param pairs vector where pairs are appended
+        *   @return true, SweepAndPrune always produces pairs
+        */
+      virtual bool collectPairs(std::vector<struct ObjectPair>& pairs) override;
+
+      /**
+        *   @brief Find objects whose bounds overlap region
+        *   @details Binary searches the sorted endpoints, so only objects whose
+        *   min x is at most the widest object away from region are checked
+        *   @param min smallest corner of the region
+        *   @param max biggest corner of the region
+        *   @param objects found objects are appended here
+        */
+      virtual void queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) override;
+
+      /**
+        *   @brief Get amount of objects
+        *   @return amount of stored PhysicsObjects
+        */
+      inline unsigned getObjectAmount() const {
+        return endpoints.size() / 2 - removed_proxies.size();
+      }
+
+    private:
+      /**
+        *   @struct Proxy
+        *   @brief Stored bounds of one PhysicsObject
+        */
+      struct Proxy {
+        PhysicsObject* object = nullptr; /**< nullptr if Proxy is free */
+        Vector2f min; /**< min position of the object */
+        Vector2f max; /**< max position of the object */
+      };
+
+      /**
+        *   @struct Endpoint
+        *   @brief Min or max x of one Proxy
+        */
+      struct Endpoint {
+        float value; /**< x coordinate */
+        uint32_t proxy; /**< Proxy index, MinEndpoint bit set for min endpoints */
+      };
+
+      static const uint32_t MinEndpoint = 0x80000000; /**< Marks min endpoints */
+
+      /**
+        *   @brief Store object bounds to its Proxy
+        *   @param proxy Proxy to be updated
+        */
+      void UpdateBounds(Proxy& proxy);
+
+      /**
+        *   @brief Refresh endpoint values and sort them
+        *   @details Endpoints of removed proxies are dropped first and the
+        *   proxies are freed for reuse. Previously sorted endpoints are
+        *   refreshed with insertion sort, appended endpoints are sorted and
+        *   merged to them. Equal values keep their order
+        */
+      void SortEndpoints();
+
+      /**
+        *   @brief Delete all PhysicsObjects
+        */
+      void Clear();
+
+      /**
+        *   @brief Copy objects, allocates new PhysicsObjects
+        *   @param sap SweepAndPrune to be copied
+        */
+      void Copy(const SweepAndPrune& sap);
+
+      std::vector<Proxy> proxies; /**< Object bounds, indexed by PhysicsObject proxy */
+      std::vector<uint32_t> free_proxies; /**< Indices of free proxies */
+      std::vector<uint32_t> removed_proxies; /**< Removed proxies whose endpoints are still in endpoints */
+      std::vector<Endpoint> endpoints; /**< Min and max endpoints, sorted by value */
+      ObjectBuckets buckets; /**< Proxy index selects the bucket */
+      std::vector<uint32_t> open; /**< Proxies whose min endpoint has been swept but max not, reused by collectPairs */
+      bool sorted = true; /**< Whether endpoints are sorted */
+      size_t sorted_endpoints = 0; /**< Endpoints sorted by the latest SortEndpoints, the rest are appended */
+      float max_width = 0.f; /**< Widest proxy on x axis, recomputed by SortEndpoints */
+  };
+
+} // end of namespace pe
@@ -0,0 +1,104 @@
+/**
+  *   @file TaskScheduler.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class TaskScheduler
+  */
+
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <mutex>
+#include <memory>
+#include <functional>
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class TaskScheduler
+    *   @brief Work-stealing scheduler running indexed tasks on ThreadPool threads
+    *   @details Tasks 0 ... tasks - 1 are first divided evenly to per thread
+    *   deques. Each thread pops tasks from the front of its own deque. A thread
+    *   which runs out of tasks steals half of the remaining tasks from the back
+    *   of another thread's deque, so load balances even when task costs are
+    *   very uneven (e.g. objects bunched to a few grid cells)
+    */
+  class TaskScheduler
+  {
+    public:
+      /**
+        *   @brief Constructor
+        *   @param pool ThreadPool whose threads execute the tasks, not owned
+        */
+      TaskScheduler(ThreadPool* pool);
+
+      /**
+        *   @brief Copy constructor deleted
+        */
+      TaskScheduler(const TaskScheduler& scheduler) = delete;
+
+      /**
+        *   @brief Assignment operator deleted
+        */
+      TaskScheduler& operator=(const TaskScheduler& scheduler) = delete;
+
+      /**
+        *   @brief Run tasks and wait until all of them are finished
+        *   @param tasks amount of tasks
+        *   @param task function called once for each task index. The second
+        *   argument is the index of the executing thread, 0 ... getThreads() - 1
+        */
+      void run(unsigned tasks, const std::function<void(unsigned, unsigned)>& task);
+
+      /**
+        *   @brief Get amount of threads executing tasks
+        *   @return pool workers + calling thread
+        */
+      inline unsigned getThreads() const {
+        return pool->getWorkers() + 1;
+      }
+
+    private:
+      /**
+        *   @struct TaskQueue
+        *   @brief Deque of one thread, contains task indices [begin, end)
+        *   @remark Aligned to cache line to avoid false sharing between threads
+        */
+      struct alignas(64) TaskQueue {
+        std::mutex mutex; /**< Guards begin and end */
+        unsigned begin = 0; /**< Next task for the owner thread */
+        unsigned end = 0; /**< One past the last task, thieves take from here */
+      };
+
+      /**
+        *   @brief Pop task from the front of own deque
+        *   @param thread owner thread index
+        *   @param task popped task is stored here
+        *   @return true if task was popped, false if deque was empty
+        */
+      bool Pop(unsigned thread, unsigned& task);
+
+      /**
+        *   @brief Steal tasks from the back of other deques
+        *   @details Half of the victim's remaining tasks are moved to the
+        *   thief's own deque and the first of them is returned
+        *   @param thread thief thread index
+        *   @param task stolen task is stored here
+        *   @return true if something was stolen, false if all deques were empty
+        */
+      bool Steal(unsigned thread, unsigned& task);
+
+      /**
+        *   @brief Make sure there is one TaskQueue per thread
+        */
+      void ReserveQueues();
+
+      ThreadPool* pool; /**< Executing threads, not owned */
+      std::unique_ptr<TaskQueue[]> queues; /**< One deque per thread */
+      unsigned queue_amount = 0; /**< Size of queues */
+  };
+
+} // end of namespace pe
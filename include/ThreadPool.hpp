@@ -0,0 +1,108 @@
+/**
+  *   @file ThreadPool.hpp
+  *   @author Lauri Westerholm
+  *   @brief Header for class ThreadPool
+  */
+
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+/**
+  *   @namespace pe
+  *   @remark Stands for PhysicsEngine
+  */
+namespace pe {
+
+  /**
+    *   @class ThreadPool
+    *   @brief Persistent worker threads used by PhysicsWorld
+    *   @details Worker threads are created once and they are parked (waiting on
+    *   a condition variable) between jobs. run() wakes all workers, executes the
+    *   job also in the calling thread and returns only after every thread has
+    *   finished its part, i.e. each call to run() acts as a barrier
+    */
+  class ThreadPool
+  {
+    public:
+      /**
+        *   @brief Constructor
+        *   @param workers how many worker threads are created (0 is allowed,
+        *   then run() executes job only in the calling thread)
+        */
+      ThreadPool(unsigned workers);
+
+      /**
+        *   @brief Deconstructor
+        *   @details Wakes and joins all worker threads
+        */
+      virtual ~ThreadPool();
+
+      /**
+        *   @brief Copy constructor deleted, threads cannot be copied
+        */
+      ThreadPool(const ThreadPool& pool) = delete;
+
+      /**
+        *   @brief Assignment operator deleted, threads cannot be copied
+        */
+      ThreadPool& operator=(const ThreadPool& pool) = delete;
+
+      /**
+        *   @brief Run job in every worker thread and in the calling thread
+        *   @details Worker threads call job(0) ... job(workers - 1) and the
+        *   calling thread calls job(workers). Blocks until all calls have returned
+        *   @param job function called with the index of the executing thread
+        *   @remark Must not be called from inside a job
+        */
+      void run(const std::function<void(unsigned)>& job);
+
+      /**
+        *   @brief Change amount of worker threads
+        *   @details Joins old workers and creates new ones, so this should not
+        *   be called periodically
+        *   @param workers new amount of worker threads
+        */
+      void resize(unsigned workers);
+
+      /**
+        *   @brief Get amount of worker threads
+        *   @return workers.size()
+        */
+      inline unsigned getWorkers() const {
+        return workers.size();
+      }
+
+    private:
+      /**
+        *   @brief Main loop of a worker thread
+        *   @param index worker index passed to job
+        */
+      void WorkerLoop(unsigned index);
+
+      /**
+        *   @brief Create worker threads
+        *   @param amount how many workers are created
+        */
+      void Start(unsigned amount);
+
+      /**
+        *   @brief Stop and join all worker threads
+        */
+      void Stop();
+
+      std::vector<std::thread> workers; /**< Persistent worker threads */
+      std::mutex mutex; /**< Guards all members below */
+      std::condition_variable wake_condition; /**< Workers wait on this between jobs */
+      std::condition_variable done_condition; /**< run() waits on this for workers to finish */
+      const std::function<void(unsigned)>* job = nullptr; /**< Current job, valid only during run() */
+      unsigned long generation = 0; /**< Incremented for every new job */
+      unsigned pending = 0; /**< How many workers are still executing the current job */
+      bool stop = false; /**< Tells workers to exit */
+  };
+
+} // end of namespace pe
@@ -0,0 +1,362 @@
+/**
+  *   @file AABBTree.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class AABBTree
+  */
+
+#include "../include/AABBTree.hpp"
+#include <algorithm>
+
+namespace pe {
+
+  namespace {
+    // Perimeter of box, used as insertion cost
+    inline float Perimeter(const Vector2f min, const Vector2f max) {
+      return 2.f * ((max.getX() - min.getX()) + (max.getY() - min.getY()));
+    }
+
+    // Smallest corner of combined boxes
+    inline Vector2f CombineMin(const Vector2f a, const Vector2f b) {
+      return Vector2f(std::min(a.getX(), b.getX()), std::min(a.getY(), b.getY()));
+    }
+
+    // Biggest corner of combined boxes
+    inline Vector2f CombineMax(const Vector2f a, const Vector2f b) {
+      return Vector2f(std::max(a.getX(), b.getX()), std::max(a.getY(), b.getY()));
+    }
+
+    // Check whether boxes overlap
+    inline bool Overlap(const Vector2f min1, const Vector2f max1, const Vector2f min2, const Vector2f max2) {
+      return !((max1.getX() < min2.getX()) || (max2.getX() < min1.getX()) ||
+               (max1.getY() < min2.getY()) || (max2.getY() < min1.getY()));
+    }
+  } // end of anonymous namespace
+
+  // Empty constructor
+  AABBTree::AABBTree() {}
+
+  // Deconstructor
+  AABBTree::~AABBTree() {
+    Clear();
+  }
+
+  // Copy constructor
+  AABBTree::AABBTree(const AABBTree& tree) {
+    Copy(tree);
+  }
+
+  // Assignment operator
+  AABBTree& AABBTree::operator=(const AABBTree& tree) {
+    if (this != &tree) {
+      Clear();
+      Copy(tree);
+    }
+    return *this;
+  }
+
+  // Clone AABBTree
+  Broadphase* AABBTree::clone() const {
+    return new AABBTree(*this);
+  }
+
+  // Insert object to tree
+  bool AABBTree::addObject(PhysicsObject* object) {
+    int32_t leaf = AllocateNode();
+    nodes[leaf].object = object;
+    FatBounds(leaf);
+    InsertLeaf(leaf);
+    // bucket works as the home Cell of the object
+    buckets.add(object, leaf);
+    object->getProxy() = leaf;
+    object->setMoved(false);
+    leaves++;
+    return true;
+  }
+
+  // Remove object from tree
+  bool AABBTree::removeObject(PhysicsObject* object) {
+    uint32_t index = object->getProxy();
+    if ((index >= nodes.size()) || (nodes[index].object != object)) return false;
+    RemoveLeaf(index);
+    FreeNode(index);
+    buckets.remove(object);
+    PhysicsObject::destroy(object);
+    leaves--;
+    return true;
+  }
+
+  // Reinsert listed objects which left their fat boxes
+  void AABBTree::moveObjects(const std::vector<PhysicsObject*>& moved) {
+    for (auto object : moved) {
+      int32_t i = object->getProxy();
+      object->setMoved(false);
+      Vector2f min = object->getMinPosition();
+      Vector2f max = object->getMaxPosition();
+      if ((min.getX() >= nodes[i].min.getX()) && (min.getY() >= nodes[i].min.getY()) &&
+          (max.getX() <= nodes[i].max.getX()) && (max.getY() <= nodes[i].max.getY())) continue;
+      RemoveLeaf(i);
+      FatBounds(i);
+      InsertLeaf(i);
+    }
+  }
+
+  // Append bucket Cells to cells
+  void AABBTree::collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) {
+    buckets.collect(cells, active_only);
+  }
+
+  // Append overlapping pairs to pairs
+  bool AABBTree::collectPairs(std::vector<struct ObjectPair>& pairs) {
+    if (root == AABBTree::NullNode) return true;
+    for (int32_t leaf = 0; leaf < static_cast<int32_t>(nodes.size()); leaf++) {
+      const Node& query = nodes[leaf];
+      if ((query.object == nullptr) || !isActive(query.object)) continue;
+      stack.clear();
+      stack.push_back(root);
+      while (!stack.empty()) {
+        int32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = nodes[index];
+        if (!Overlap(query.min, query.max, node.min, node.max)) continue;
+        if (node.object == nullptr) {
+          stack.push_back(node.child1);
+          stack.push_back(node.child2);
+        } else if (index != leaf) {
+          // pair of active objects is found twice, keep the one found by the bigger index
+          if (isActive(node.object) && (index > leaf)) continue;
+          pairs.push_back(ObjectPair{node.object, query.object});
+        }
+      }
+    }
+    return true;
+  }
+
+  // Find objects overlapping region
+  void AABBTree::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    if (root == AABBTree::NullNode) return;
+    std::vector<int32_t> stack(1, root);
+    while (!stack.empty()) {
+      const Node& node = nodes[stack.back()];
+      stack.pop_back();
+      if (!Overlap(min, max, node.min, node.max)) continue;
+      if (node.object == nullptr) {
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+      } else if (Overlap(min, max, node.object->getMinPosition(), node.object->getMaxPosition())) {
+        // fat box overlapped, check also the real bounds
+        objects.push_back(node.object);
+      }
+    }
+  }
+
+  // Find objects hit by segment
+  void AABBTree::queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects) {
+    if (root == AABBTree::NullNode) return;
+    std::vector<std::pair<float, PhysicsObject*>> hits;
+    std::vector<int32_t> stack(1, root);
+    while (!stack.empty()) {
+      const Node& node = nodes[stack.back()];
+      stack.pop_back();
+      float distance;
+      if (!RayHit(from, to, node.min, node.max, distance)) continue;
+      if (node.object == nullptr) {
+        stack.push_back(node.child1);
+        stack.push_back(node.child2);
+      } else if (RayHit(from, to, node.object->getMinPosition(), node.object->getMaxPosition(), distance)) {
+        hits.push_back(std::make_pair(distance, node.object));
+      }
+    }
+    AppendHits(hits, objects);
+  }
+
+  // Allocate node, private method
+  int32_t AABBTree::AllocateNode() {
+    if (free_node == AABBTree::NullNode) {
+      nodes.push_back(Node());
+      return nodes.size() - 1;
+    }
+    int32_t index = free_node;
+    free_node = nodes[index].parent;
+    nodes[index] = Node();
+    return index;
+  }
+
+  // Free node, private method
+  void AABBTree::FreeNode(int32_t index) {
+    nodes[index].object = nullptr;
+    nodes[index].child1 = AABBTree::NullNode;
+    nodes[index].child2 = AABBTree::NullNode;
+    nodes[index].height = -1;
+    nodes[index].parent = free_node;
+    free_node = index;
+  }
+
+  // Compute fat box, private method
+  void AABBTree::FatBounds(int32_t leaf) {
+    Node& node = nodes[leaf];
+    Vector2f margin(AABBTree::FatMargin, AABBTree::FatMargin);
+    Vector2f min = node.object->getMinPosition() - margin;
+    Vector2f max = node.object->getMaxPosition() + margin;
+    // stretch towards movement, same velocity is used by CollisionDetection::objectsClose
+    Vector2f displacement = node.object->getPhysics().velocity * AABBTree::VelocityFactor;
+    node.min = min + Vector2f(std::min(displacement.getX(), 0.f), std::min(displacement.getY(), 0.f));
+    node.max = max + Vector2f(std::max(displacement.getX(), 0.f), std::max(displacement.getY(), 0.f));
+  }
+
+  // Insert leaf, private method
+  void AABBTree::InsertLeaf(int32_t leaf) {
+    if (root == AABBTree::NullNode) {
+      root = leaf;
+      nodes[root].parent = AABBTree::NullNode;
+      return;
+    }
+    // find the sibling which grows the total perimeter least
+    Vector2f leaf_min = nodes[leaf].min;
+    Vector2f leaf_max = nodes[leaf].max;
+    int32_t index = root;
+    while (nodes[index].object == nullptr) {
+      const Node& node = nodes[index];
+      float perimeter = Perimeter(node.min, node.max);
+      float combined = Perimeter(CombineMin(node.min, leaf_min), CombineMax(node.max, leaf_max));
+      // cost of creating a new parent for this node and the leaf
+      float cost = 2.f * combined;
+      // minimum cost of pushing the leaf further down the tree
+      float inheritance = 2.f * (combined - perimeter);
+      float child_cost[2];
+      int32_t children[2] = {node.child1, node.child2};
+      for (int i = 0; i < 2; i++) {
+        const Node& child = nodes[children[i]];
+        float child_combined = Perimeter(CombineMin(child.min, leaf_min), CombineMax(child.max, leaf_max));
+        if (child.object != nullptr) child_cost[i] = child_combined + inheritance;
+        else child_cost[i] = child_combined - Perimeter(child.min, child.max) + inheritance;
+      }
+      if ((cost < child_cost[0]) && (cost < child_cost[1])) break;
+      index = child_cost[0] < child_cost[1] ? children[0] : children[1];
+    }
+    int32_t sibling = index;
+    int32_t old_parent = nodes[sibling].parent;
+    int32_t new_parent = AllocateNode();
+    Node& parent = nodes[new_parent];
+    parent.parent = old_parent;
+    parent.min = CombineMin(leaf_min, nodes[sibling].min);
+    parent.max = CombineMax(leaf_max, nodes[sibling].max);
+    parent.height = nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    if (old_parent != AABBTree::NullNode) {
+      if (nodes[old_parent].child1 == sibling) nodes[old_parent].child1 = new_parent;
+      else nodes[old_parent].child2 = new_parent;
+    } else {
+      root = new_parent;
+    }
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+    Refit(new_parent);
+  }
+
+  // Remove leaf, private method
+  void AABBTree::RemoveLeaf(int32_t leaf) {
+    if (leaf == root) {
+      root = AABBTree::NullNode;
+      return;
+    }
+    int32_t parent = nodes[leaf].parent;
+    int32_t grand_parent = nodes[parent].parent;
+    int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+    if (grand_parent != AABBTree::NullNode) {
+      // sibling replaces parent
+      if (nodes[grand_parent].child1 == parent) nodes[grand_parent].child1 = sibling;
+      else nodes[grand_parent].child2 = sibling;
+      nodes[sibling].parent = grand_parent;
+      FreeNode(parent);
+      Refit(grand_parent);
+    } else {
+      root = sibling;
+      nodes[sibling].parent = AABBTree::NullNode;
+      FreeNode(parent);
+    }
+  }
+
+  // Refit boxes up to root, private method
+  void AABBTree::Refit(int32_t index) {
+    while (index != AABBTree::NullNode) {
+      index = Balance(index);
+      Node& node = nodes[index];
+      const Node& child1 = nodes[node.child1];
+      const Node& child2 = nodes[node.child2];
+      node.height = 1 + std::max(child1.height, child2.height);
+      node.min = CombineMin(child1.min, child2.min);
+      node.max = CombineMax(child1.max, child2.max);
+      index = node.parent;
+    }
+  }
+
+  // Rotate unbalanced node, private method
+  int32_t AABBTree::Balance(int32_t a) {
+    Node& A = nodes[a];
+    if ((A.object != nullptr) || (A.height < 2)) return a;
+    int32_t b = A.child1;
+    int32_t c = A.child2;
+    Node& B = nodes[b];
+    Node& C = nodes[c];
+    int32_t balance = C.height - B.height;
+    if ((balance <= 1) && (balance >= -1)) return a;
+    // the higher child is rotated up
+    int32_t up = balance > 1 ? c : b;
+    int32_t other = balance > 1 ? b : c;
+    Node& U = nodes[up];
+    Node& O = nodes[other];
+    int32_t f = U.child1;
+    int32_t g = U.child2;
+    Node& F = nodes[f];
+    Node& G = nodes[g];
+    U.child1 = a;
+    U.parent = A.parent;
+    A.parent = up;
+    if (U.parent != AABBTree::NullNode) {
+      if (nodes[U.parent].child1 == a) nodes[U.parent].child1 = up;
+      else nodes[U.parent].child2 = up;
+    } else {
+      root = up;
+    }
+    // the higher grandchild stays under up, the lower one replaces up under a
+    int32_t keep = F.height > G.height ? f : g;
+    int32_t move = F.height > G.height ? g : f;
+    U.child2 = keep;
+    if (balance > 1) A.child2 = move;
+    else A.child1 = move;
+    nodes[move].parent = a;
+    A.min = CombineMin(O.min, nodes[move].min);
+    A.max = CombineMax(O.max, nodes[move].max);
+    A.height = 1 + std::max(O.height, nodes[move].height);
+    U.min = CombineMin(A.min, nodes[keep].min);
+    U.max = CombineMax(A.max, nodes[keep].max);
+    U.height = 1 + std::max(A.height, nodes[keep].height);
+    return up;
+  }
+
+  // Delete all objects and nodes, private method
+  void AABBTree::Clear() {
+    for (auto& node : nodes) {
+      if (node.object != nullptr) PhysicsObject::destroy(node.object);
+    }
+    nodes.clear();
+    root = AABBTree::NullNode;
+    free_node = AABBTree::NullNode;
+    leaves = 0;
+    buckets.clear();
+  }
+
+  // Copy objects, private method
+  void AABBTree::Copy(const AABBTree& tree) {
+    for (auto& node : tree.nodes) {
+      if (node.object == nullptr) continue;
+      if (node.object->getObjectType() == ObjectType::DynamicObject) {
+        addObject(new DynamicObject(*static_cast<DynamicObject*>(node.object)));
+      } else {
+        addObject(new StaticObject(*static_cast<StaticObject*>(node.object)));
+      }
+    }
+  }
+
+} // end of namespace pe
@@ -0,0 +1,282 @@
+/**
+  *   @file BodyStore.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class BodyStore
+  */
+
+#include "../include/BodyStore.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace pe {
+
+  // Static member initializations
+  enum Kernel::Kernel BodyStore::ActiveKernel = BodyStore::BestKernel();
+  bool BodyStore::Deterministic = true;
+
+  // Empty constructor
+  BodyStore::BodyStore() {}
+
+  // Add DynamicObject
+  void BodyStore::add(DynamicObject* object, float elapsed_time) {
+    if (amount == objects.size()) Grow();
+    PhysicsProperties& physics = object->getPhysics();
+    object->beginUpdate();
+    if (physics.advanceResistance()) {
+      // objects mostly share resistance_factor, so multipliers are reused
+      if (!resistance_cached || (physics.resistance_factor != cached_resistance) || (elapsed_time != cached_time)) {
+        PhysicsProperties::resistanceMultipliers(elapsed_time, physics.resistance_factor, cached_velocity_factor, cached_acceloration_factor);
+        cached_resistance = physics.resistance_factor;
+        cached_time = elapsed_time;
+        resistance_cached = true;
+      }
+      velocity_resistance[amount] = cached_velocity_factor;
+      acceloration_resistance[amount] = cached_acceloration_factor;
+    } else {
+      velocity_resistance[amount] = 1.f;
+      acceloration_resistance[amount] = 1.f;
+    }
+    objects[amount] = object;
+    position_x[amount] = physics.position.getX();
+    position_y[amount] = physics.position.getY();
+    velocity_x[amount] = physics.velocity.getX();
+    velocity_y[amount] = physics.velocity.getY();
+    acceloration_x[amount] = physics.acceloration.getX();
+    acceloration_y[amount] = physics.acceloration.getY();
+    amount++;
+  }
+
+  // Integrate all bodies
+  void BodyStore::integrate(float elapsed_time) {
+    unsigned begin = 0;
+    if (BodyStore::ActiveKernel == Kernel::AVX2) begin = IntegrateAVX2(amount, elapsed_time);
+    else if (BodyStore::ActiveKernel == Kernel::SSE) begin = IntegrateSSE(amount, elapsed_time);
+    // remaining bodies which don't fill a whole register
+    IntegrateScalar(begin, amount, elapsed_time);
+  }
+
+  // Select Kernel
+  bool BodyStore::setKernel(enum Kernel::Kernel kernel) {
+    if (!isSupported(kernel)) return false;
+    BodyStore::ActiveKernel = kernel;
+    return true;
+  }
+
+  // Check Kernel support
+  bool BodyStore::isSupported(enum Kernel::Kernel kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init(); // needed when called before constructors
+    if (kernel == Kernel::AVX2) return __builtin_cpu_supports("avx2");
+    if (kernel == Kernel::SSE) return __builtin_cpu_supports("sse2");
+    return true;
+#else
+    return kernel == Kernel::Scalar;
+#endif
+  }
+
+  // Set deterministic mode
+  void BodyStore::setDeterministic(bool deterministic) {
+    BodyStore::Deterministic = deterministic;
+  }
+
+  // Find fastest Kernel, private method
+  enum Kernel::Kernel BodyStore::BestKernel() {
+    if (isSupported(Kernel::AVX2)) return Kernel::AVX2;
+    if (isSupported(Kernel::SSE)) return Kernel::SSE;
+    return Kernel::Scalar;
+  }
+
+  // Integrate one body at a time, private method
+  void BodyStore::IntegrateScalar(unsigned begin, unsigned end, float elapsed_time) {
+    const float gravity_x = PhysicsProperties::GravityX;
+    const float gravity_y = PhysicsProperties::GravityY;
+    // plain arrays without aliasing
+    float* __restrict px = position_x.data();
+    float* __restrict py = position_y.data();
+    float* __restrict vx = velocity_x.data();
+    float* __restrict vy = velocity_y.data();
+    float* __restrict ax = acceloration_x.data();
+    float* __restrict ay = acceloration_y.data();
+    float* __restrict dx = delta_x.data();
+    float* __restrict dy = delta_y.data();
+    float* __restrict cx = collision_velocity_x.data();
+    float* __restrict cy = collision_velocity_y.data();
+    const float* __restrict vr = velocity_resistance.data();
+    const float* __restrict ar = acceloration_resistance.data();
+    if (BodyStore::Deterministic) {
+      // operations in the same order as in DynamicObject::updatePhysics
+      for (unsigned i = begin; i < end; i++) {
+        dx[i] = vx[i] * elapsed_time + 0.5f * (ax[i] + gravity_x) * elapsed_time * elapsed_time;
+        dy[i] = vy[i] * elapsed_time + 0.5f * (ay[i] + gravity_y) * elapsed_time * elapsed_time;
+        px[i] = px[i] + dx[i];
+        py[i] = py[i] + dy[i];
+        vx[i] = vx[i] * vr[i];
+        vy[i] = vy[i] * vr[i];
+        ax[i] = ax[i] * ar[i];
+        ay[i] = ay[i] * ar[i];
+        cx[i] = dx[i] / elapsed_time;
+        cy[i] = dy[i] / elapsed_time;
+      }
+      return;
+    }
+    const float half_squared = 0.5f * elapsed_time * elapsed_time;
+    const float inverse = 1.f / elapsed_time;
+    for (unsigned i = begin; i < end; i++) {
+      dx[i] = vx[i] * elapsed_time + (ax[i] + gravity_x) * half_squared;
+      dy[i] = vy[i] * elapsed_time + (ay[i] + gravity_y) * half_squared;
+      px[i] = px[i] + dx[i];
+      py[i] = py[i] + dy[i];
+      vx[i] = vx[i] * vr[i];
+      vy[i] = vy[i] * vr[i];
+      ax[i] = ax[i] * ar[i];
+      ay[i] = ay[i] * ar[i];
+      cx[i] = dx[i] * inverse;
+      cy[i] = dy[i] * inverse;
+    }
+  }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+  // Integrate four bodies at a time, private method
+  __attribute__((target("sse2")))
+  unsigned BodyStore::IntegrateSSE(unsigned end, float elapsed_time) {
+    const __m128 time = _mm_set1_ps(elapsed_time);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 half_squared = _mm_set1_ps(0.5f * elapsed_time * elapsed_time);
+    const __m128 inverse = _mm_set1_ps(1.f / elapsed_time);
+    const __m128 gravity[2] = {_mm_set1_ps(PhysicsProperties::GravityX), _mm_set1_ps(PhysicsProperties::GravityY)};
+    float* position[2] = {position_x.data(), position_y.data()};
+    float* velocity[2] = {velocity_x.data(), velocity_y.data()};
+    float* acceloration[2] = {acceloration_x.data(), acceloration_y.data()};
+    float* delta[2] = {delta_x.data(), delta_y.data()};
+    float* collision_velocity[2] = {collision_velocity_x.data(), collision_velocity_y.data()};
+    const bool deterministic = BodyStore::Deterministic;
+    unsigned i = 0;
+    for (; i + 4 <= end; i += 4) {
+      const __m128 vr = _mm_loadu_ps(velocity_resistance.data() + i);
+      const __m128 ar = _mm_loadu_ps(acceloration_resistance.data() + i);
+      for (unsigned axis = 0; axis < 2; axis++) {
+        __m128 p = _mm_loadu_ps(position[axis] + i);
+        __m128 v = _mm_loadu_ps(velocity[axis] + i);
+        __m128 a = _mm_loadu_ps(acceloration[axis] + i);
+        __m128 d, c;
+        if (deterministic) {
+          // v * t + 0.5 * (a + g) * t * t, evaluated left to right
+          d = _mm_add_ps(_mm_mul_ps(v, time), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(half, _mm_add_ps(a, gravity[axis])), time), time));
+          c = _mm_div_ps(d, time);
+        } else {
+          d = _mm_add_ps(_mm_mul_ps(v, time), _mm_mul_ps(_mm_add_ps(a, gravity[axis]), half_squared));
+          c = _mm_mul_ps(d, inverse);
+        }
+        _mm_storeu_ps(position[axis] + i, _mm_add_ps(p, d));
+        _mm_storeu_ps(velocity[axis] + i, _mm_mul_ps(v, vr));
+        _mm_storeu_ps(acceloration[axis] + i, _mm_mul_ps(a, ar));
+        _mm_storeu_ps(delta[axis] + i, d);
+        _mm_storeu_ps(collision_velocity[axis] + i, c);
+      }
+    }
+    return i;
+  }
+
+  // Integrate eight bodies at a time, private method
+  __attribute__((target("avx2")))
+  unsigned BodyStore::IntegrateAVX2(unsigned end, float elapsed_time) {
+    const __m256 time = _mm256_set1_ps(elapsed_time);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 half_squared = _mm256_set1_ps(0.5f * elapsed_time * elapsed_time);
+    const __m256 inverse = _mm256_set1_ps(1.f / elapsed_time);
+    const __m256 gravity[2] = {_mm256_set1_ps(PhysicsProperties::GravityX), _mm256_set1_ps(PhysicsProperties::GravityY)};
+    float* position[2] = {position_x.data(), position_y.data()};
+    float* velocity[2] = {velocity_x.data(), velocity_y.data()};
+    float* acceloration[2] = {acceloration_x.data(), acceloration_y.data()};
+    float* delta[2] = {delta_x.data(), delta_y.data()};
+    float* collision_velocity[2] = {collision_velocity_x.data(), collision_velocity_y.data()};
+    const bool deterministic = BodyStore::Deterministic;
+    unsigned i = 0;
+    for (; i + 8 <= end; i += 8) {
+      const __m256 vr = _mm256_loadu_ps(velocity_resistance.data() + i);
+      const __m256 ar = _mm256_loadu_ps(acceloration_resistance.data() + i);
+      for (unsigned axis = 0; axis < 2; axis++) {
+        __m256 p = _mm256_loadu_ps(position[axis] + i);
+        __m256 v = _mm256_loadu_ps(velocity[axis] + i);
+        __m256 a = _mm256_loadu_ps(acceloration[axis] + i);
+        __m256 d, c;
+        if (deterministic) {
+          // v * t + 0.5 * (a + g) * t * t, evaluated left to right
+          d = _mm256_add_ps(_mm256_mul_ps(v, time), _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(half, _mm256_add_ps(a, gravity[axis])), time), time));
+          c = _mm256_div_ps(d, time);
+        } else {
+          d = _mm256_add_ps(_mm256_mul_ps(v, time), _mm256_mul_ps(_mm256_add_ps(a, gravity[axis]), half_squared));
+          c = _mm256_mul_ps(d, inverse);
+        }
+        _mm256_storeu_ps(position[axis] + i, _mm256_add_ps(p, d));
+        _mm256_storeu_ps(velocity[axis] + i, _mm256_mul_ps(v, vr));
+        _mm256_storeu_ps(acceloration[axis] + i, _mm256_mul_ps(a, ar));
+        _mm256_storeu_ps(delta[axis] + i, d);
+        _mm256_storeu_ps(collision_velocity[axis] + i, c);
+      }
+    }
+    return i;
+  }
+
+#else
+
+  // SSE is not available, private method
+  unsigned BodyStore::IntegrateSSE(__attribute__((unused)) unsigned end, __attribute__((unused)) float elapsed_time) {
+    return 0;
+  }
+
+  // AVX2 is not available, private method
+  unsigned BodyStore::IntegrateAVX2(__attribute__((unused)) unsigned end, __attribute__((unused)) float elapsed_time) {
+    return 0;
+  }
+
+#endif
+
+  // Store state back to objects
+  void BodyStore::store(std::vector<PhysicsObject*>& moved) {
+    for (unsigned i = 0; i < amount; i++) {
+      DynamicObject* object = objects[i];
+      PhysicsProperties& physics = object->getPhysics();
+      Vector2f position(position_x[i], position_y[i]);
+      // moved is also set by setPosition and collision response
+      if (object->getMoved() || !(physics.position == position)) {
+        object->setMoved(true);
+        moved.push_back(object);
+      }
+      physics.position.update(position_x[i], position_y[i]);
+      physics.velocity.update(velocity_x[i], velocity_y[i]);
+      physics.acceloration.update(acceloration_x[i], acceloration_y[i]);
+      physics.collision_velocity.update(collision_velocity_x[i], collision_velocity_y[i]);
+      object->endUpdate(Vector2f(delta_x[i], delta_y[i]));
+      object->updateTransform();
+    }
+    clear();
+  }
+
+  // Remove all bodies
+  void BodyStore::clear() {
+    amount = 0;
+  }
+
+  // Double the capacity of the arrays, private method
+  void BodyStore::Grow() {
+    unsigned capacity = 2 * amount;
+    if (capacity < BodyStore::MinCapacity) capacity = BodyStore::MinCapacity;
+    objects.resize(capacity);
+    position_x.resize(capacity);
+    position_y.resize(capacity);
+    velocity_x.resize(capacity);
+    velocity_y.resize(capacity);
+    acceloration_x.resize(capacity);
+    acceloration_y.resize(capacity);
+    delta_x.resize(capacity);
+    delta_y.resize(capacity);
+    collision_velocity_x.resize(capacity);
+    collision_velocity_y.resize(capacity);
+    velocity_resistance.resize(capacity);
+    acceloration_resistance.resize(capacity);
+  }
+
+} // end of namespace pe
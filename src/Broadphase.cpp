@@ -0,0 +1,113 @@
+/**
+  *   @file Broadphase.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains default implementations of Broadphase queries
+  */
+
+#include "../include/Broadphase.hpp"
+#include <cmath>
+
+namespace pe {
+
+  // Add objects one at a time
+  unsigned Broadphase::addObjects(PhysicsObject* const* objects, unsigned count) {
+    unsigned added = 0;
+    for (unsigned i = 0; i < count; i++) {
+      if (addObject(objects[i])) added++;
+    }
+    return added;
+  }
+
+  // Move objects whose moved flag is set
+  void Broadphase::moveObjects() {
+    std::vector<Cell<PhysicsObject*>*> cells;
+    collectCells(cells, false);
+    std::vector<PhysicsObject*> moved;
+    for (auto cell : cells) {
+      for (auto object : cell->entities) {
+        if (object->getMoved() && isHomeCell(cell, object)) moved.push_back(object);
+      }
+    }
+    moveObjects(moved);
+  }
+
+  // Find objects overlapping region
+  void Broadphase::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    std::vector<Cell<PhysicsObject*>*> cells;
+    collectCells(cells, false);
+    for (auto cell : cells) {
+      for (auto object : cell->entities) {
+        if (!isHomeCell(cell, object)) continue;
+        Vector2f object_min = object->getMinPosition();
+        Vector2f object_max = object->getMaxPosition();
+        if ((object_max.getX() < min.getX()) || (max.getX() < object_min.getX()) ||
+            (object_max.getY() < min.getY()) || (max.getY() < object_min.getY())) continue;
+        objects.push_back(object);
+      }
+    }
+  }
+
+  // Find objects hit by segment
+  void Broadphase::queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects) {
+    std::vector<Cell<PhysicsObject*>*> cells;
+    collectCells(cells, false);
+    std::vector<std::pair<float, PhysicsObject*>> hits;
+    for (auto cell : cells) {
+      for (auto object : cell->entities) {
+        float distance;
+        if (isHomeCell(cell, object) && RayHit(from, to, object->getMinPosition(), object->getMaxPosition(), distance)) {
+          hits.push_back(std::make_pair(distance, object));
+        }
+      }
+    }
+    AppendHits(hits, objects);
+  }
+
+  // Slab test between segment and bounds
+  bool Broadphase::RayHit(const Vector2f from, const Vector2f to, const Vector2f min, const Vector2f max, float& distance) {
+    float enter = 0.f;
+    float exit = 1.f;
+    const float start[] = {from.getX(), from.getY()};
+    const float delta[] = {to.getX() - from.getX(), to.getY() - from.getY()};
+    const float low[] = {min.getX(), min.getY()};
+    const float high[] = {max.getX(), max.getY()};
+    for (int axis = 0; axis < 2; axis++) {
+      if (std::abs(delta[axis]) < 1e-12f) {
+        // parallel to the slab
+        if ((start[axis] < low[axis]) || (start[axis] > high[axis])) return false;
+        continue;
+      }
+      float t1 = (low[axis] - start[axis]) / delta[axis];
+      float t2 = (high[axis] - start[axis]) / delta[axis];
+      if (t1 > t2) std::swap(t1, t2);
+      enter = std::max(enter, t1);
+      exit = std::min(exit, t2);
+      if (enter > exit) return false;
+    }
+    distance = enter;
+    return true;
+  }
+
+  // Append objects of one Cell overlapping region
+  void Broadphase::QueryCell(const Cell<PhysicsObject*>* cell, const CellRange& region, const Vector2f min, const Vector2f max,
+                             std::vector<PhysicsObject*>& objects) {
+    for (auto object : cell->entities) {
+      const CellRange& range = object->getCellRange();
+      if ((std::max(range.min_x, region.min_x) != cell->x) || (std::max(range.min_y, region.min_y) != cell->y)) continue;
+      Vector2f object_min = object->getMinPosition();
+      Vector2f object_max = object->getMaxPosition();
+      if ((object_max.getX() < min.getX()) || (max.getX() < object_min.getX()) ||
+          (object_max.getY() < min.getY()) || (max.getY() < object_min.getY())) continue;
+      objects.push_back(object);
+    }
+  }
+
+  // Append sorted hits
+  void Broadphase::AppendHits(std::vector<std::pair<float, PhysicsObject*>>& hits, std::vector<PhysicsObject*>& objects) {
+    std::sort(hits.begin(), hits.end(), [] (const std::pair<float, PhysicsObject*>& a, const std::pair<float, PhysicsObject*>& b) {
+      return a.first < b.first;
+    });
+    for (auto& hit : hits) objects.push_back(hit.second);
+  }
+
+} // end of namespace pe
@@ -5,6 +5,10 @@
   */
 
 #include "../include/CollisionDetection.hpp"
+#include "../include/ContactCache.hpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 
 namespace pe {
@@ -13,37 +17,136 @@ namespace pe {
 
     // Calculate possible collision between objects
     bool calculateCollision(PhysicsObject* obj1, PhysicsObject* obj2) {
+      struct MTV mtv;
+      if (!detectCollision(obj1, obj2, mtv)) return false;
+      resolveCollision(obj1, obj2, mtv);
+      return true;
+    }
 
+    // Detect collision without modifying objects
+    bool detectCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv, const ContactCache* cache) {
+
+      if (isAxisAlignedBox(obj1) && isAxisAlignedBox(obj2)) return detectBoxCollision(obj1, obj2, mtv);
       // check if objects are even relatively close to one another
       if ((!objectsClose(obj1, obj2)) || (!canCollide(obj1, obj2))) return false;
+      // touching pair which hasn't moved relative to each other has the same result
+      if ((cache != nullptr) && cache->reuse(obj1, obj2, mtv)) return true;
 
       // objects could collide, calculate possible collisions
       Shape* shape1 = obj1->getShape();
       Shape* shape2 = obj2->getShape();
-      struct MTV mtv;
+      mtv = MTV();
       // for obj1 axis
-      std::vector<Vector2f>& axis = shape1->getAxis();
-      for (unsigned i = 0; i < axis.size(); i++) {
+      std::vector<Vector2f>& axis1 = shape1->getAxis();
+      for (unsigned i = 0; i < axis1.size(); i++) {
         // project both Shapes
-        struct Projection proj1 = ProjectShape(axis[i], obj1->getPhysics().position, shape1, obj1->getPhysics().angle);
-        struct Projection proj2 = ProjectShape(axis[i], obj2->getPhysics().position, shape2, obj2->getPhysics().angle);
+        struct Projection proj1 = ProjectObject(axis1[i], obj1);
+        struct Projection proj2 = ProjectObject(axis1[i], obj2);
         if (! overlap(proj1, proj2)) return false; // one projection which won't overlap is enough
-        mtv = StoreMTV(mtv, axis[i], proj1, proj2);
+        mtv = StoreMTV(mtv, axis1[i], proj1, proj2);
       }
       // for obj2 axis
-      axis = shape2->getAxis();
-      for (unsigned i = 0; i < axis.size(); i++) {
+      std::vector<Vector2f>& axis2 = shape2->getAxis();
+      for (unsigned i = 0; i < axis2.size(); i++) {
         // project both Shapes
-        struct Projection proj1 = ProjectShape(axis[i], obj1->getPhysics().position, shape1, obj1->getPhysics().angle);
-        struct Projection proj2 = ProjectShape(axis[i], obj2->getPhysics().position, shape2, obj2->getPhysics().angle);
+        struct Projection proj1 = ProjectObject(axis2[i], obj1);
+        struct Projection proj2 = ProjectObject(axis2[i], obj2);
         if (! overlap(proj1, proj2)) return false; // one projection which won't overlap is enough
-        mtv = StoreMTV(mtv, axis[i], proj1, proj2);
+        mtv = StoreMTV(mtv, axis2[i], proj1, proj2);
       }
       // all projections overlap, collision detected
+      return true;
+    }
+
+    // Detect collisions of many pairs
+    void detectCollisions(const struct ObjectPair* pairs, unsigned count, std::vector<std::pair<unsigned, struct MTV>>& hits,
+                          const ContactCache* cache) {
+      unsigned boxes[4];
+      unsigned amount = 0;
+      for (unsigned i = 0; i < count; i++) {
+        PhysicsObject* obj1 = pairs[i].first;
+        PhysicsObject* obj2 = pairs[i].second;
+        if (isAxisAlignedBox(obj1) && isAxisAlignedBox(obj2)) {
+          if (!canCollide(obj1, obj2)) continue;
+          boxes[amount++] = i;
+          if (amount == 4) {
+            DetectBoxBatch(pairs, boxes, amount, hits);
+            amount = 0;
+          }
+          continue;
+        }
+        struct MTV mtv;
+        if (detectCollision(obj1, obj2, mtv, cache)) hits.push_back(std::make_pair(i, mtv));
+      }
+      if (amount) DetectBoxBatch(pairs, boxes, amount, hits);
+    }
+
+    // Detect collision between axis aligned boxes
+    bool detectBoxCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv) {
+      if (!canCollide(obj1, obj2)) return false;
+      Vector2f min1 = obj1->getMinPosition();
+      Vector2f max1 = obj1->getMaxPosition();
+      Vector2f min2 = obj2->getMinPosition();
+      Vector2f max2 = obj2->getMaxPosition();
+#if defined(__x86_64__) || defined(__i386__)
+      // both projections of both axes in one register: max1 - min2 and max2 - min1
+      __m128 distance = _mm_sub_ps(_mm_setr_ps(max1.getX(), max1.getY(), max2.getX(), max2.getY()),
+                                   _mm_setr_ps(min2.getX(), min2.getY(), min1.getX(), min1.getY()));
+      if (_mm_movemask_ps(_mm_cmplt_ps(distance, _mm_setzero_ps()))) return false;
+      float overlap[4];
+      _mm_storeu_ps(overlap, _mm_min_ps(distance, _mm_movehl_ps(distance, distance)));
+      float overlap_x = overlap[0];
+      float overlap_y = overlap[1];
+#else
+      float distance[4] = {max1.getX() - min2.getX(), max1.getY() - min2.getY(), max2.getX() - min1.getX(), max2.getY() - min1.getY()};
+      if ((distance[0] < 0.f) || (distance[1] < 0.f) || (distance[2] < 0.f) || (distance[3] < 0.f)) return false;
+      float overlap_x = MIN(distance[0], distance[2]);
+      float overlap_y = MIN(distance[1], distance[3]);
+#endif
+      mtv = MTV();
+      StoreBoxMTV(mtv, obj1, overlap_x, overlap_y);
+      return true;
+    }
+
+    // Find time of impact of a moving object
+    bool sweepCollision(PhysicsObject* obj1, Vector2f motion, PhysicsObject* obj2, float& toi) {
+      if ((obj1 == obj2) || !canCollide(obj1, obj2)) return false;
+      float enter = -std::numeric_limits<float>::max();
+      float exit = std::numeric_limits<float>::max();
+      for (auto shape : {obj1->getShape(), obj2->getShape()}) {
+        for (auto& axis : shape->getAxis()) {
+          float speed = dotProduct(motion, axis);
+          struct Projection proj1 = ProjectObject(axis, obj1);
+          proj1.min -= speed;
+          proj1.max -= speed;
+          struct Projection proj2 = ProjectObject(axis, obj2);
+          if (!SweepAxis(proj1, proj2, speed, enter, exit)) return false;
+        }
+      }
+      // overlap at the start is a regular contact
+      if ((enter < 0.f) || (enter > 1.f)) return false;
+      toi = enter;
+      return true;
+    }
+
+    // Narrow time interval of overlapping projections
+    bool SweepAxis(const struct Projection& proj1, const struct Projection& proj2, float speed, float& enter, float& exit) {
+      if (speed == 0.f) {
+        // projections stay put, they overlap during the whole step or never
+        return (proj1.max > proj2.min) && (proj2.max > proj1.min);
+      }
+      float begin = (speed > 0.f ? proj2.min - proj1.max : proj2.max - proj1.min) / speed;
+      float end = (speed > 0.f ? proj2.max - proj1.min : proj2.min - proj1.max) / speed;
+      if (begin > enter) enter = begin;
+      exit = MIN(exit, end);
+      return enter < exit;
+    }
+
+    // Apply collision response
+    void resolveCollision(PhysicsObject* obj1, PhysicsObject* obj2, struct MTV& mtv) {
       std::deque<PhysicsObject*> collided = GetCollisionResult(obj1, obj2);
       // move collided according to MTV
       collideObjects(collided, mtv);
-      return true;
     }
 
     //  Check if PhysicsObjects are close
@@ -70,8 +173,8 @@ namespace pe {
     struct Projection ProjectShape(Vector2f axis, Vector2f position, Shape* shape, float object_angle) {
       // init min and max
       float min = std::numeric_limits<float>::max();
-      float max = std::numeric_limits<float>::min();
-      std::deque<Vector2f> edges = shape->getFrame();
+      float max = std::numeric_limits<float>::lowest();
+      const std::deque<Vector2f>& edges = shape->getFrame();
       for (int i = 0; i < shape->getEdges(); i++) {
         // edge[i] is just a static point, position tells where it's relating to PhysicsWorld origin
         Vector2f edge = edges[i] + position;
@@ -86,6 +189,29 @@ namespace pe {
       return projection;
     }
 
+    // Project world space vertices on axis
+    struct Projection ProjectVertices(Vector2f axis, const std::vector<Vector2f>& vertices) {
+      // same init as in ProjectShape so that results match
+      float min = std::numeric_limits<float>::max();
+      float max = std::numeric_limits<float>::lowest();
+      for (auto& vertex : vertices) {
+        float dot = dotProduct(axis, vertex);
+        if (dot < min) min = dot;
+        if (dot > max) max = dot;
+      }
+      struct Projection projection;
+      projection.min = min;
+      projection.max = max;
+      return projection;
+    }
+
+    // Project PhysicsObject on axis
+    struct Projection ProjectObject(Vector2f axis, PhysicsObject* object) {
+      if (object->isTransformValid()) return ProjectVertices(axis, object->getWorldVertices());
+      // position or angle modified directly through getPhysics()
+      return ProjectShape(axis, object->getPhysics().position, object->getShape(), object->getPhysics().angle);
+    }
+
     // Check if Projections overlap
     bool overlap(struct Projection& proj1, struct Projection& proj2) {
       return !(proj1.max < proj2.min || proj2.max < proj1.min);
@@ -147,6 +273,66 @@ namespace pe {
       }
     }
 
+    // Detect collisions of up to four box pairs
+    void DetectBoxBatch(const struct ObjectPair* pairs, const unsigned* indices, unsigned amount, std::vector<std::pair<unsigned, struct MTV>>& hits) {
+      // one lane per pair, unused lanes are copies of the first pair
+      float max1_x[4], max1_y[4], max2_x[4], max2_y[4], min1_x[4], min1_y[4], min2_x[4], min2_y[4];
+      for (unsigned lane = 0; lane < 4; lane++) {
+        const struct ObjectPair& pair = pairs[indices[lane < amount ? lane : 0]];
+        Vector2f min1 = pair.first->getMinPosition();
+        Vector2f max1 = pair.first->getMaxPosition();
+        Vector2f min2 = pair.second->getMinPosition();
+        Vector2f max2 = pair.second->getMaxPosition();
+        min1_x[lane] = min1.getX();
+        min1_y[lane] = min1.getY();
+        max1_x[lane] = max1.getX();
+        max1_y[lane] = max1.getY();
+        min2_x[lane] = min2.getX();
+        min2_y[lane] = min2.getY();
+        max2_x[lane] = max2.getX();
+        max2_y[lane] = max2.getY();
+      }
+      float overlap_x[4], overlap_y[4];
+      int separated;
+#if defined(__x86_64__) || defined(__i386__)
+      __m128 distance1_x = _mm_sub_ps(_mm_loadu_ps(max1_x), _mm_loadu_ps(min2_x));
+      __m128 distance1_y = _mm_sub_ps(_mm_loadu_ps(max1_y), _mm_loadu_ps(min2_y));
+      __m128 distance2_x = _mm_sub_ps(_mm_loadu_ps(max2_x), _mm_loadu_ps(min1_x));
+      __m128 distance2_y = _mm_sub_ps(_mm_loadu_ps(max2_y), _mm_loadu_ps(min1_y));
+      __m128 zero = _mm_setzero_ps();
+      separated = _mm_movemask_ps(_mm_or_ps(_mm_or_ps(_mm_cmplt_ps(distance1_x, zero), _mm_cmplt_ps(distance1_y, zero)),
+                                            _mm_or_ps(_mm_cmplt_ps(distance2_x, zero), _mm_cmplt_ps(distance2_y, zero))));
+      _mm_storeu_ps(overlap_x, _mm_min_ps(distance1_x, distance2_x));
+      _mm_storeu_ps(overlap_y, _mm_min_ps(distance1_y, distance2_y));
+#else
+      separated = 0;
+      for (unsigned lane = 0; lane < 4; lane++) {
+        float distance[4] = {max1_x[lane] - min2_x[lane], max1_y[lane] - min2_y[lane], max2_x[lane] - min1_x[lane], max2_y[lane] - min1_y[lane]};
+        if ((distance[0] < 0.f) || (distance[1] < 0.f) || (distance[2] < 0.f) || (distance[3] < 0.f)) separated |= 1 << lane;
+        overlap_x[lane] = MIN(distance[0], distance[2]);
+        overlap_y[lane] = MIN(distance[1], distance[3]);
+      }
+#endif
+      for (unsigned lane = 0; lane < amount; lane++) {
+        if (separated & (1 << lane)) continue;
+        struct MTV mtv;
+        StoreBoxMTV(mtv, pairs[indices[lane]].first, overlap_x[lane], overlap_y[lane]);
+        hits.push_back(std::make_pair(indices[lane], mtv));
+      }
+    }
+
+    // Store MTV of a box pair
+    void StoreBoxMTV(struct MTV& mtv, PhysicsObject* obj1, float overlap_x, float overlap_y) {
+      // box axes are (-1, 0) and (0, 1), order comes from the Shape
+      for (auto& axis : obj1->getShape()->getAxis()) {
+        float overlap = axis.getX() != 0.f ? overlap_x : overlap_y;
+        if (overlap < mtv.amount) {
+          mtv.axis = axis;
+          mtv.amount = overlap;
+        }
+      }
+    }
+
     // Set correct collision direction for objecs, this is the dir where object should move after collision
     void setCollisionDirections(PhysicsObject* obj1, PhysicsObject* obj2) {
       if (obj1->getPrevPosition().getX() < obj2->getPrevPosition().getX()) {
@@ -166,5 +352,129 @@ namespace pe {
       }
     }
 
+    // Find contact points of a collided pair
+    unsigned findManifold(PhysicsObject* obj1, PhysicsObject* obj2, const struct MTV& mtv, struct Manifold& manifold) {
+      std::vector<Vector2f> scratch1, scratch2;
+      return findManifold(obj1, obj2, mtv, manifold, scratch1, scratch2);
+    }
+
+    // Find contact points of a collided pair using caller owned buffers
+    unsigned findManifold(PhysicsObject* obj1, PhysicsObject* obj2, const struct MTV& mtv, struct Manifold& manifold,
+                          std::vector<Vector2f>& scratch1, std::vector<Vector2f>& scratch2) {
+      const std::vector<Vector2f>& vertices1 = ObjectVertices(obj1, scratch1);
+      const std::vector<Vector2f>& vertices2 = ObjectVertices(obj2, scratch2);
+      manifold.count = 0;
+      if (vertices1.size() < 2 || vertices2.size() < 2) return 0;
+      // MTV axis has no sign, orient it from obj1 towards obj2
+      Vector2f center1, center2;
+      for (auto& vertex : vertices1) center1 += vertex;
+      for (auto& vertex : vertices2) center2 += vertex;
+      center1 *= 1.f / vertices1.size();
+      center2 *= 1.f / vertices2.size();
+      Vector2f normal = mtv.axis;
+      normal.normalize();
+      if (dotProduct(normal, center2 - center1) < 0.f) normal *= -1.f;
+      manifold.normal = normal;
+
+      struct Edge edge1 = BestEdge(vertices1, normal);
+      struct Edge edge2 = BestEdge(vertices2, -1.f * normal);
+      Vector2f direction1 = edge1.end - edge1.begin;
+      Vector2f direction2 = edge2.end - edge2.begin;
+      direction1.normalize();
+      direction2.normalize();
+      // reference edge is the one more perpendicular to the normal
+      bool flip = std::abs(dotProduct(direction1, normal)) > std::abs(dotProduct(direction2, normal));
+      struct Edge& reference = flip ? edge2 : edge1;
+      struct Edge& incident = flip ? edge1 : edge2;
+      Vector2f reference_direction = flip ? direction2 : direction1;
+      Vector2f reference_normal = flip ? -1.f * normal : normal;
+
+      Vector2f clipped[2] = {incident.begin, incident.end};
+      if (!ClipSegment(clipped, reference_direction, dotProduct(reference_direction, reference.begin)) ||
+          !ClipSegment(clipped, -1.f * reference_direction, -dotProduct(reference_direction, reference.end))) {
+        clipped[0] = incident.max;
+        clipped[1] = incident.max;
+      }
+      float face = dotProduct(reference_normal, reference.max);
+      for (uint32_t i = 0; i < 2; i++) {
+        float depth = face - dotProduct(reference_normal, clipped[i]);
+        if (depth < 0.f) continue;
+        if ((manifold.count == 1) && (clipped[i] == manifold.points[0].point)) continue;
+        struct ContactPoint& point = manifold.points[manifold.count++];
+        point = ContactPoint();
+        point.point = clipped[i];
+        point.depth = depth;
+        point.feature = (static_cast<uint32_t>(flip) << 31) | (reference.index << 16) | (incident.index << 1) | i;
+      }
+      if (manifold.count == 0) {
+        // numerically degenerate contact, use the deepest vertex
+        struct ContactPoint& point = manifold.points[manifold.count++];
+        point = ContactPoint();
+        point.point = incident.max;
+        point.depth = mtv.amount;
+        point.feature = (static_cast<uint32_t>(flip) << 31) | (reference.index << 16) | (incident.index << 1);
+      }
+      return manifold.count;
+    }
+
+    // Get world space vertices of an object
+    const std::vector<Vector2f>& ObjectVertices(PhysicsObject* object, std::vector<Vector2f>& scratch) {
+      if (object->isTransformValid()) return object->getWorldVertices();
+      // same transform as PhysicsObject::updateTransform and ProjectShape
+      Shape* shape = object->getShape();
+      const std::deque<Vector2f>& frame = shape->getFrame();
+      scratch.resize(shape->getEdges());
+      for (unsigned i = 0; i < scratch.size(); i++) {
+        scratch[i] = frame[i] + object->getPhysics().position;
+        scratch[i].rotate(object->getPhysics().angle);
+      }
+      return scratch;
+    }
+
+    // Find edge most perpendicular to direction
+    struct Edge BestEdge(const std::vector<Vector2f>& vertices, Vector2f direction) {
+      unsigned size = vertices.size();
+      unsigned best = 0;
+      float max = std::numeric_limits<float>::lowest();
+      for (unsigned i = 0; i < size; i++) {
+        float projection = dotProduct(direction, vertices[i]);
+        if (projection > max) {
+          max = projection;
+          best = i;
+        }
+      }
+      unsigned previous = best == 0 ? size - 1 : best - 1;
+      unsigned next = best + 1 == size ? 0 : best + 1;
+      Vector2f left = vertices[best] - vertices[next];
+      Vector2f right = vertices[best] - vertices[previous];
+      left.normalize();
+      right.normalize();
+      struct Edge edge;
+      edge.max = vertices[best];
+      if (std::abs(dotProduct(right, direction)) <= std::abs(dotProduct(left, direction))) {
+        edge.begin = vertices[previous];
+        edge.end = vertices[best];
+        edge.index = previous;
+      } else {
+        edge.begin = vertices[best];
+        edge.end = vertices[next];
+        edge.index = best;
+      }
+      return edge;
+    }
+
+    // Clip segment to half plane
+    bool ClipSegment(Vector2f* points, Vector2f direction, float offset) {
+      float distance0 = dotProduct(direction, points[0]) - offset;
+      float distance1 = dotProduct(direction, points[1]) - offset;
+      if ((distance0 < 0.f) && (distance1 < 0.f)) return false;
+      if ((distance0 < 0.f) || (distance1 < 0.f)) {
+        Vector2f intersection = points[0] + (distance0 / (distance0 - distance1)) * (points[1] - points[0]);
+        if (distance0 < 0.f) points[0] = intersection;
+        else points[1] = intersection;
+      }
+      return true;
+    }
+
   }// end of namespace CollisionDetection
 }// end of namespace pe
@@ -0,0 +1,122 @@
+/**
+  *   @file ContactCache.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class ContactCache
+  */
+
+#include "../include/ContactCache.hpp"
+#include "../include/Broadphase.hpp"
+
+namespace pe {
+
+  // Start collecting contacts of a step
+  void ContactCache::beginStep() {
+    events.clear();
+  }
+
+  // Add contact of the current step
+  void ContactCache::addContact(PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv) {
+    uint64_t key = PairKey(obj1, obj2);
+    auto found = index.find(key);
+    if (found == index.end()) {
+      index.emplace(key, pairs.size());
+      pairs.push_back(CachedPair());
+      pairs.back().key = key;
+      pairs.back().first = nullptr;
+      Store(pairs.back(), obj1, obj2, mtv);
+      events.push_back(ContactEvent{obj1, obj2, ContactState::Begin, mtv});
+      return;
+    }
+    CachedPair& pair = pairs[found->second];
+    // the same pair may be found only once per step, but be defensive
+    if (pair.step == step) return;
+    Store(pair, obj1, obj2, mtv);
+    events.push_back(ContactEvent{obj1, obj2, ContactState::Persist, mtv});
+  }
+
+  // Report pairs which weren't added as ended
+  void ContactCache::endStep() {
+    for (unsigned i = 0; i < pairs.size();) {
+      CachedPair& pair = pairs[i];
+      // removed objects are already freed, so only the ids of the key are read
+      if (!removed.empty() && (removed.count(pair.key >> 32) || removed.count(pair.key & 0xFFFFFFFF))) {
+        RemovePair(i);
+      } else if (pair.step == step) {
+        i++;
+      } else if (!isActive(pair.first) && !isActive(pair.second)) {
+        // neither object was checked, the pair still touches
+        pair.step = step;
+        i++;
+      } else {
+        events.push_back(ContactEvent{pair.first, pair.second, ContactState::End, pair.mtv});
+        RemovePair(i);
+      }
+    }
+    removed.clear();
+    step++;
+  }
+
+  // Drop pairs of a removed object
+  void ContactCache::removeObject(PhysicsObject* object) {
+    removed.insert(object->getId());
+  }
+
+  // Remove all pairs
+  void ContactCache::clear() {
+    pairs.clear();
+    index.clear();
+    removed.clear();
+    events.clear();
+  }
+
+  // Get cached result of an unchanged pair
+  bool ContactCache::reuse(PhysicsObject* obj1, PhysicsObject* obj2, struct CollisionDetection::MTV& mtv) const {
+    auto found = index.find(PairKey(obj1, obj2));
+    if (found == index.end()) return false;
+    const CachedPair& pair = pairs[found->second];
+    // previous step only, objects in the same order
+    if ((pair.step + 1 != step) || (pair.first != obj1)) return false;
+    if ((pair.first_shape != obj1->getShape()) || (pair.second_shape != obj2->getShape())) return false;
+    const PhysicsProperties& physics1 = obj1->getPhysics();
+    const PhysicsProperties& physics2 = obj2->getPhysics();
+    if ((physics1.angle != pair.first_angle) || (physics2.angle != pair.second_angle) ||
+        !(physics2.position - physics1.position == pair.relative)) return false;
+    mtv = pair.mtv;
+    return true;
+  }
+
+  // Get stored Manifold of a pair
+  struct CollisionDetection::Manifold* ContactCache::getManifold(PhysicsObject* obj1, PhysicsObject* obj2) {
+    auto found = index.find(PairKey(obj1, obj2));
+    if (found == index.end()) return nullptr;
+    CachedPair& pair = pairs[found->second];
+    if ((pair.step + 1 != step) || (pair.first != obj1)) return nullptr;
+    return &pair.manifold;
+  }
+
+  // Store contact transform of a pair, private method
+  void ContactCache::Store(struct CachedPair& pair, PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv) {
+    // impulses are along the normal from first to second
+    if (pair.first != obj1) pair.manifold.count = 0;
+    pair.first = obj1;
+    pair.second = obj2;
+    pair.first_shape = obj1->getShape();
+    pair.second_shape = obj2->getShape();
+    pair.relative = obj2->getPhysics().position - obj1->getPhysics().position;
+    pair.first_angle = obj1->getPhysics().angle;
+    pair.second_angle = obj2->getPhysics().angle;
+    pair.mtv = mtv;
+    pair.step = step;
+  }
+
+  // Remove pair with swap-remove, private method
+  void ContactCache::RemovePair(unsigned i) {
+    index.erase(pairs[i].key);
+    if (i + 1 != pairs.size()) {
+      pairs[i] = pairs.back();
+      index[pairs[i].key] = i;
+    }
+    pairs.pop_back();
+  }
+
+} // end of namespace pe
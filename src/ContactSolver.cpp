@@ -0,0 +1,317 @@
+/**
+  *   @file ContactSolver.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class ContactSolver
+  */
+
+#include "../include/ContactSolver.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace pe {
+
+  // Static member initializations
+  unsigned ContactSolver::VelocityIterations = 8;
+  unsigned ContactSolver::PositionIterations = 3;
+  float ContactSolver::Friction = 0.3f;
+  bool ContactSolver::WarmStarting = true;
+  float ContactSolver::RestitutionThreshold = 10.f;
+  unsigned ContactSolver::ColouringLimit = 1024;
+  const unsigned ContactSolver::Colours = 64;
+  const unsigned ContactSolver::BatchSize = 128;
+  const float ContactSolver::Tolerance = 0.001f;
+  const float ContactSolver::Baumgarte = 0.2f;
+  const float ContactSolver::Slop = 0.01f;
+
+  // Set iteration counts
+  void ContactSolver::setIterations(unsigned velocity, unsigned position) {
+    ContactSolver::VelocityIterations = velocity > 0 ? velocity : 1;
+    ContactSolver::PositionIterations = position;
+  }
+
+  // Set friction coefficient
+  void ContactSolver::setFriction(float friction) {
+    ContactSolver::Friction = std::abs(friction);
+  }
+
+  // Set warm starting
+  void ContactSolver::setWarmStarting(bool warm_starting) {
+    ContactSolver::WarmStarting = warm_starting;
+  }
+
+  // Set restitution threshold
+  void ContactSolver::setRestitutionThreshold(float velocity) {
+    ContactSolver::RestitutionThreshold = velocity;
+  }
+
+  // Set colouring limit
+  void ContactSolver::setColouringLimit(unsigned contacts) {
+    ContactSolver::ColouringLimit = contacts;
+  }
+
+  // Empty constructor
+  ContactSolver::ContactSolver() {}
+
+  // Add collided pair
+  void ContactSolver::add(PhysicsObject* obj1, PhysicsObject* obj2, const struct CollisionDetection::MTV& mtv,
+                          struct CollisionDetection::Manifold* cached) {
+    // only objects with the same or greater collision mask push an object
+    uint8_t mask1 = obj1->getCollisionMask();
+    uint8_t mask2 = obj2->getCollisionMask();
+    bool pushed1 = (obj1->getObjectType() == ObjectType::DynamicObject) && (mask1 <= mask2);
+    bool pushed2 = (obj2->getObjectType() == ObjectType::DynamicObject) && (mask2 <= mask1);
+    if (!pushed1 && !pushed2) return;
+    struct Constraint constraint;
+    constraint.body1 = Body(obj1);
+    constraint.body2 = Body(obj2);
+    constraint.inverse_mass1 = pushed1 ? bodies[constraint.body1].inverse_mass : 0.f;
+    constraint.inverse_mass2 = pushed2 ? bodies[constraint.body2].inverse_mass : 0.f;
+    float inverse_mass = constraint.inverse_mass1 + constraint.inverse_mass2;
+    if (!(inverse_mass > 0.f)) return;
+    constraint.normal_mass = 1.f / inverse_mass;
+    // elasticity is only defined for DynamicObjects
+    constraint.restitution = std::max(pushed1 ? obj1->getElasticity() : 0.f, pushed2 ? obj2->getElasticity() : 0.f);
+    constraint.mtv = mtv;
+    constraint.cached = cached;
+    constraints.push_back(constraint);
+  }
+
+  // Solve added contacts
+  void ContactSolver::solve(ThreadPool* pool) {
+    iterations = 0;
+    colours = 0;
+    if (constraints.empty()) {
+      clear();
+      return;
+    }
+    bool colouring = (ContactSolver::ColouringLimit > 0) && (constraints.size() >= ContactSolver::ColouringLimit);
+    if (!colouring) pool = nullptr;
+    // manifolds are found before any velocity changes
+    unsigned threads = pool != nullptr ? pool->getWorkers() + 1 : 1;
+    if (vertex_buffers.size() < 2 * threads) vertex_buffers.resize(2 * threads);
+    Run(pool, constraints.size(), [this] (unsigned begin, unsigned end, unsigned thread) {
+      for (unsigned i = begin; i < end; i++) Prepare(constraints[i], thread);
+    });
+    if (colouring) Colour();
+    if (ContactSolver::WarmStarting) SolveColours(pool, SolverPass::WarmStart);
+    while (iterations < ContactSolver::VelocityIterations) {
+      iterations++;
+      if (SolveColours(pool, SolverPass::Velocity) < ContactSolver::Tolerance) break;
+    }
+    for (unsigned i = 0; i < ContactSolver::PositionIterations; i++) SolveColours(pool, SolverPass::Position);
+    Run(pool, bodies.size(), [this] (unsigned begin, unsigned end, unsigned) {
+      for (unsigned i = begin; i < end; i++) Store(bodies[i]);
+    });
+    Run(pool, constraints.size(), [this] (unsigned begin, unsigned end, unsigned) {
+      for (unsigned i = begin; i < end; i++) {
+        struct Constraint& constraint = constraints[i];
+        if ((constraint.cached != nullptr) && (constraint.manifold.count > 0)) *constraint.cached = constraint.manifold;
+      }
+    });
+    clear();
+  }
+
+  // Remove added contacts
+  void ContactSolver::clear() {
+    bodies.clear();
+    constraints.clear();
+    body_index.clear();
+  }
+
+  // Get index of object in bodies, private method
+  unsigned ContactSolver::Body(PhysicsObject* object) {
+    auto found = body_index.find(object);
+    if (found != body_index.end()) return found->second;
+    struct SolverBody body;
+    body.object = object;
+    if (object->getObjectType() == ObjectType::DynamicObject) {
+      // velocity of the latest integration, includes gravity of the step
+      body.velocity = object->getPhysics().collision_velocity;
+      body.integrated = body.velocity;
+      body.inverse_mass = object->getPhysics().inverse_mass;
+    } else {
+      body.inverse_mass = 0.f;
+    }
+    body_index.emplace(object, bodies.size());
+    bodies.push_back(body);
+    return bodies.size() - 1;
+  }
+
+  // Find contact points and restitution targets, private method
+  void ContactSolver::Prepare(struct Constraint& constraint, unsigned thread) {
+    struct SolverBody& body1 = bodies[constraint.body1];
+    struct SolverBody& body2 = bodies[constraint.body2];
+    // pairs without contact points are kept, they don't apply impulses
+    CollisionDetection::findManifold(body1.object, body2.object, constraint.mtv, constraint.manifold,
+                                     vertex_buffers[2 * thread], vertex_buffers[2 * thread + 1]);
+    Vector2f normal = constraint.manifold.normal;
+    constraint.tangent = Vector2f(-normal.getY(), normal.getX());
+    float approach = dotProduct(body2.velocity - body1.velocity, normal);
+    struct CollisionDetection::Manifold* cached = constraint.cached;
+    for (unsigned i = 0; i < constraint.manifold.count; i++) {
+      constraint.bias[i] = approach < -ContactSolver::RestitutionThreshold ? -constraint.restitution * approach : 0.f;
+      if (!ContactSolver::WarmStarting || (cached == nullptr)) continue;
+      // match points of the previous step by the edges which produced them
+      struct CollisionDetection::ContactPoint& point = constraint.manifold.points[i];
+      for (unsigned j = 0; j < cached->count; j++) {
+        if (cached->points[j].feature == point.feature) {
+          point.normal_impulse = cached->points[j].normal_impulse;
+          point.tangent_impulse = cached->points[j].tangent_impulse;
+          break;
+        }
+      }
+    }
+  }
+
+  // Apply cached impulses, private method
+  void ContactSolver::WarmStart(struct Constraint& constraint) {
+    struct SolverBody& body1 = bodies[constraint.body1];
+    struct SolverBody& body2 = bodies[constraint.body2];
+    for (unsigned i = 0; i < constraint.manifold.count; i++) {
+      struct CollisionDetection::ContactPoint& point = constraint.manifold.points[i];
+      Vector2f impulse = point.normal_impulse * constraint.manifold.normal + point.tangent_impulse * constraint.tangent;
+      // objects which aren't pushed may be shared by concurrent constraints
+      if (constraint.inverse_mass1 > 0.f) body1.velocity -= constraint.inverse_mass1 * impulse;
+      if (constraint.inverse_mass2 > 0.f) body2.velocity += constraint.inverse_mass2 * impulse;
+    }
+  }
+
+  // Solve impulses of a constraint once, private method
+  float ContactSolver::SolveVelocity(struct Constraint& constraint) {
+    float max_change = 0.f;
+    struct SolverBody& body1 = bodies[constraint.body1];
+    struct SolverBody& body2 = bodies[constraint.body2];
+    Vector2f normal = constraint.manifold.normal;
+    float inverse_mass = constraint.inverse_mass1 + constraint.inverse_mass2;
+    Vector2f velocity1 = body1.velocity;
+    Vector2f velocity2 = body2.velocity;
+    for (unsigned i = 0; i < constraint.manifold.count; i++) {
+      struct CollisionDetection::ContactPoint& point = constraint.manifold.points[i];
+      // friction first, limited by the current normal impulse
+      float limit = ContactSolver::Friction * point.normal_impulse;
+      float tangent_velocity = dotProduct(velocity2 - velocity1, constraint.tangent);
+      float tangent_impulse = std::max(-limit, std::min(point.tangent_impulse - constraint.normal_mass * tangent_velocity, limit));
+      float change = tangent_impulse - point.tangent_impulse;
+      point.tangent_impulse = tangent_impulse;
+      Vector2f impulse = change * constraint.tangent;
+      velocity1 -= constraint.inverse_mass1 * impulse;
+      velocity2 += constraint.inverse_mass2 * impulse;
+      max_change = std::max(max_change, std::abs(change) * inverse_mass);
+      // accumulated normal impulse may only push objects apart
+      float normal_velocity = dotProduct(velocity2 - velocity1, normal);
+      float normal_impulse = std::max(point.normal_impulse - constraint.normal_mass * (normal_velocity - constraint.bias[i]), 0.f);
+      change = normal_impulse - point.normal_impulse;
+      point.normal_impulse = normal_impulse;
+      impulse = change * normal;
+      velocity1 -= constraint.inverse_mass1 * impulse;
+      velocity2 += constraint.inverse_mass2 * impulse;
+      max_change = std::max(max_change, std::abs(change) * inverse_mass);
+    }
+    // objects which aren't pushed may be shared by concurrent constraints
+    if (constraint.inverse_mass1 > 0.f) body1.velocity = velocity1;
+    if (constraint.inverse_mass2 > 0.f) body2.velocity = velocity2;
+    return max_change;
+  }
+
+  // Push objects of a constraint apart once, private method
+  void ContactSolver::SolvePosition(struct Constraint& constraint) {
+    if (constraint.manifold.count == 0) return;
+    struct SolverBody& body1 = bodies[constraint.body1];
+    struct SolverBody& body2 = bodies[constraint.body2];
+    Vector2f normal = constraint.manifold.normal;
+    // objects don't rotate, so the deepest point tells the whole overlap
+    float depth = constraint.manifold.points[0].depth;
+    if ((constraint.manifold.count == 2) && (constraint.manifold.points[1].depth > depth)) depth = constraint.manifold.points[1].depth;
+    depth -= dotProduct(body2.correction - body1.correction, normal);
+    float amount = ContactSolver::Baumgarte * (depth - ContactSolver::Slop);
+    if (amount <= 0.f) return;
+    Vector2f correction = amount * constraint.normal_mass * normal;
+    if (constraint.inverse_mass1 > 0.f) body1.correction -= constraint.inverse_mass1 * correction;
+    if (constraint.inverse_mass2 > 0.f) body2.correction += constraint.inverse_mass2 * correction;
+  }
+
+  // Store result of a body, private method
+  void ContactSolver::Store(struct SolverBody& body) {
+    if (body.object->getObjectType() != ObjectType::DynamicObject) return;
+    PhysicsProperties& physics = body.object->getPhysics();
+    // velocity excludes the gravity of the step, so only the change is applied
+    Vector2f change = body.velocity - body.integrated;
+    physics.velocity += change;
+    physics.collision_velocity = body.velocity;
+    physics.movePosition(body.correction);
+    body.object->updateTransform();
+    // response moves objects, next update adds them to moved
+    body.object->setMoved(true);
+  }
+
+  // Order constraints by colour, private method
+  void ContactSolver::Colour() {
+    colour_masks.assign(bodies.size(), 0);
+    constraint_colours.resize(constraints.size());
+    colour_offsets.assign(ContactSolver::Colours + 2, 0);
+    for (unsigned i = 0; i < constraints.size(); i++) {
+      unsigned body1 = constraints[i].body1;
+      unsigned body2 = constraints[i].body2;
+      // unpushable objects are only read, also by constraints of the same colour
+      bool dynamic1 = bodies[body1].inverse_mass > 0.f;
+      bool dynamic2 = bodies[body2].inverse_mass > 0.f;
+      uint64_t used = (dynamic1 ? colour_masks[body1] : 0) | (dynamic2 ? colour_masks[body2] : 0);
+      unsigned colour = 0;
+      while ((colour < ContactSolver::Colours) && (used & (uint64_t(1) << colour))) colour++;
+      if (colour < ContactSolver::Colours) {
+        uint64_t bit = uint64_t(1) << colour;
+        if (dynamic1) colour_masks[body1] |= bit;
+        if (dynamic2) colour_masks[body2] |= bit;
+        colours = std::max(colours, colour + 1);
+      }
+      constraint_colours[i] = colour;
+      colour_offsets[colour + 1]++;
+    }
+    for (unsigned colour = 0; colour <= ContactSolver::Colours; colour++) colour_offsets[colour + 1] += colour_offsets[colour];
+    // stable placement keeps the added order inside each colour
+    coloured.resize(constraints.size());
+    std::vector<unsigned> next(colour_offsets.begin(), colour_offsets.end() - 1);
+    for (unsigned i = 0; i < constraints.size(); i++) coloured[next[constraint_colours[i]]++] = i;
+  }
+
+  // Run one pass over a constraint, private method
+  float ContactSolver::Solve(struct Constraint& constraint, SolverPass::SolverPass pass) {
+    if (pass == SolverPass::Velocity) return SolveVelocity(constraint);
+    if (pass == SolverPass::WarmStart) WarmStart(constraint);
+    else SolvePosition(constraint);
+    return 0.f;
+  }
+
+  // Run one pass in colour order, private method
+  float ContactSolver::SolveColours(ThreadPool* pool, SolverPass::SolverPass pass) {
+    if (colours == 0) {
+      // constraints which aren't coloured are solved in the added order
+      float max_change = 0.f;
+      if (pass == SolverPass::Velocity) {
+        for (auto& constraint : constraints) max_change = std::max(max_change, SolveVelocity(constraint));
+      } else if (pass == SolverPass::WarmStart) {
+        for (auto& constraint : constraints) WarmStart(constraint);
+      } else {
+        for (auto& constraint : constraints) SolvePosition(constraint);
+      }
+      return max_change;
+    }
+    unsigned threads = pool != nullptr ? pool->getWorkers() + 1 : 1;
+    thread_changes.assign(threads, 0.f);
+    for (unsigned colour = 0; colour <= ContactSolver::Colours; colour++) {
+      unsigned begin = colour_offsets[colour];
+      unsigned amount = colour_offsets[colour + 1] - begin;
+      if (amount == 0) continue;
+      // constraints without a colour may share objects
+      Run(colour < ContactSolver::Colours ? pool : nullptr, amount, [this, begin, pass] (unsigned first, unsigned last, unsigned thread) {
+        float max_change = thread_changes[thread];
+        for (unsigned i = begin + first; i < begin + last; i++) {
+          max_change = std::max(max_change, Solve(constraints[coloured[i]], pass));
+        }
+        thread_changes[thread] = max_change;
+      });
+    }
+    return *std::max_element(thread_changes.begin(), thread_changes.end());
+  }
+
+} // end of namespace pe
@@ -22,11 +22,13 @@ namespace pe {
   void DynamicObject::setForce(Vector2f force) {
     force *= physics.inverse_mass; // acceloration caused by the force
     physics.acceloration = physics.acceloration + force;
+    wake();
   }
 
   // setVelocity implementation
   void DynamicObject::setVelocity(Vector2f velocity) {
     physics.velocity = velocity;
+    wake();
   }
 
   // collisionAction implementation
@@ -58,23 +60,22 @@ namespace pe {
       physics.setPosition(getPrevPosition());
       updatesFromPrevCollision++; // this need to be adjusted to indicate that prevPosition can be again updated
     }
+    updateTransform();
   }
 
   // updatePhysics implementation
   void DynamicObject::updatePhysics(float elapsed_time) {
+    beginUpdate();
     // apply gravity to the object
-    if (updatesFromPrevCollision < std::numeric_limits<unsigned>::max()) updatesFromPrevCollision++;
     float delta_x = physics.velocity.getX() * elapsed_time +
     0.5f * (physics.acceloration.getX() + PhysicsProperties::GravityX) * elapsed_time * elapsed_time;
     float delta_y = physics.velocity.getY() * elapsed_time +
     0.5f * (physics.acceloration.getY() + PhysicsProperties::GravityY) * elapsed_time * elapsed_time;
-    if (updatesFromPrevCollision > 1) prevPosition = physics.position;
     physics.movePosition(Vector2f(delta_x, delta_y));
     // decrease acceloration and velocity based on physics.resistance_factor
     physics.applyResistance(elapsed_time);
     physics.collision_velocity.update(delta_x / elapsed_time, delta_y / elapsed_time);
-    inverse_direction = Vector2f(-delta_x, -delta_y);
-    alreadyCollided = false;
+    endUpdate(Vector2f(delta_x, delta_y));
   }
 
   // setCollisionDirection implementation
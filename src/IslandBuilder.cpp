@@ -0,0 +1,109 @@
+/**
+  *   @file IslandBuilder.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class IslandBuilder
+  */
+
+#include "../include/IslandBuilder.hpp"
+
+namespace pe {
+
+  // Static member initializations
+  const unsigned IslandBuilder::NoNode = 0xFFFFFFFF;
+
+  // Add contact
+  void IslandBuilder::addContact(PhysicsObject* obj1, PhysicsObject* obj2) {
+    unsigned node1 = Node(obj1);
+    unsigned node2 = Node(obj2);
+    if ((node1 != IslandBuilder::NoNode) && (node2 != IslandBuilder::NoNode)) Union(node1, node2);
+    contacts.push_back(std::make_pair(node1, node2));
+  }
+
+  // Partition contacts to islands
+  void IslandBuilder::build() {
+    contact_offsets.clear();
+    object_offsets.clear();
+    island_contacts.clear();
+    island_objects.clear();
+    root_island.assign(parents.size(), IslandBuilder::NoNode);
+    // islands are numbered by their first contact and contacts are counted
+    contact_island.assign(contacts.size(), IslandBuilder::NoNode);
+    contact_offsets.push_back(0);
+    for (unsigned i = 0; i < contacts.size(); i++) {
+      unsigned node = contacts[i].first != IslandBuilder::NoNode ? contacts[i].first : contacts[i].second;
+      // contacts without DynamicObjects belong to no island
+      if (node == IslandBuilder::NoNode) continue;
+      unsigned root = Find(node);
+      if (root_island[root] == IslandBuilder::NoNode) {
+        root_island[root] = contact_offsets.size() - 1;
+        contact_offsets.push_back(0);
+      }
+      contact_island[i] = root_island[root];
+      contact_offsets[contact_island[i] + 1]++;
+    }
+    unsigned islands = contact_offsets.size() - 1;
+    object_offsets.assign(islands + 1, 0);
+    for (unsigned node = 0; node < parents.size(); node++) object_offsets[root_island[Find(node)] + 1]++;
+    for (unsigned i = 0; i < islands; i++) {
+      contact_offsets[i + 1] += contact_offsets[i];
+      object_offsets[i + 1] += object_offsets[i];
+    }
+    // stable placement keeps the added order inside each island
+    std::vector<unsigned> next(contact_offsets.begin(), contact_offsets.end() - 1);
+    island_contacts.resize(contact_offsets.back());
+    for (unsigned i = 0; i < contacts.size(); i++) {
+      if (contact_island[i] != IslandBuilder::NoNode) island_contacts[next[contact_island[i]]++] = i;
+    }
+    next.assign(object_offsets.begin(), object_offsets.end() - 1);
+    island_objects.resize(object_offsets.back());
+    for (unsigned node = 0; node < parents.size(); node++) {
+      island_objects[next[root_island[Find(node)]]++] = objects[node];
+    }
+  }
+
+  // Remove contacts and islands
+  void IslandBuilder::clear() {
+    contacts.clear();
+    objects.clear();
+    parents.clear();
+    sizes.clear();
+    node_index.clear();
+    island_contacts.clear();
+    contact_offsets.clear();
+    island_objects.clear();
+    object_offsets.clear();
+  }
+
+  // Get union-find index of an object, private method
+  unsigned IslandBuilder::Node(PhysicsObject* object) {
+    if (object->getObjectType() != ObjectType::DynamicObject) return IslandBuilder::NoNode;
+    auto found = node_index.find(object);
+    if (found != node_index.end()) return found->second;
+    unsigned node = parents.size();
+    node_index.emplace(object, node);
+    objects.push_back(object);
+    parents.push_back(node);
+    sizes.push_back(1);
+    return node;
+  }
+
+  // Find root of a node, private method
+  unsigned IslandBuilder::Find(unsigned node) {
+    while (parents[node] != node) {
+      parents[node] = parents[parents[node]];
+      node = parents[node];
+    }
+    return node;
+  }
+
+  // Join sets of two nodes, private method
+  void IslandBuilder::Union(unsigned node1, unsigned node2) {
+    unsigned root1 = Find(node1);
+    unsigned root2 = Find(node2);
+    if (root1 == root2) return;
+    if (sizes[root1] < sizes[root2]) std::swap(root1, root2);
+    parents[root2] = root1;
+    sizes[root1] += sizes[root2];
+  }
+
+} // end of namespace pe
@@ -0,0 +1,42 @@
+/**
+  *   @file ObjectBuckets.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class ObjectBuckets
+  */
+
+#include "../include/ObjectBuckets.hpp"
+
+namespace pe {
+
+  // Add object to bucket
+  void ObjectBuckets::add(PhysicsObject* object, uint32_t index) {
+    uint32_t bucket = index / ObjectBuckets::BucketSize;
+    while (buckets.size() <= bucket) {
+      buckets.push_back(Cell<PhysicsObject*>());
+      buckets.back().x = buckets.size() - 1;
+    }
+    CellRange range;
+    range.min_x = range.max_x = bucket;
+    range.min_y = range.max_y = 0;
+    setCellRange(object, range);
+    insertToCell(&buckets[bucket], object);
+  }
+
+  // Remove object from bucket
+  void ObjectBuckets::remove(PhysicsObject* object) {
+    removeFromCell(&buckets[object->getCellRange().min_x], object);
+  }
+
+  // Append buckets to cells
+  void ObjectBuckets::collect(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) {
+    for (auto& bucket : buckets) {
+      if (active_only ? bucket.active_cell : !bucket.entities.empty()) cells.push_back(&bucket);
+    }
+  }
+
+  // Remove all buckets
+  void ObjectBuckets::clear() {
+    buckets.clear();
+  }
+
+} // end of namespace pe
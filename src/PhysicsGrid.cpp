@@ -6,11 +6,13 @@
 
 
 #include "../include/PhysicsGrid.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace pe {
 
   // Empty constructor
-  PhysicsGrid::PhysicsGrid(): loose_cell(new Cell<PhysicsObject*>()) {}
+  PhysicsGrid::PhysicsGrid() {}
 
   // Deconstructor
   PhysicsGrid::~PhysicsGrid() {
@@ -24,211 +26,276 @@ namespace pe {
 
   // Assignment operator
   PhysicsGrid& PhysicsGrid::operator=(const PhysicsGrid& grid) {
+    if (this == &grid) return *this;
     // delete old objects
     Clear();
     Copy(grid);
     return *this;
   }
 
+  // Clone PhysicsGrid
+  Broadphase* PhysicsGrid::clone() const {
+    return new PhysicsGrid(*this);
+  }
+
   // Clear whole Grid, notice this is a private method
   void PhysicsGrid::Clear() {
-    // delete all Cells and memory allocated for them
-    for (auto it = cells.begin(); it != cells.end(); it++) {
-      for(auto it2 = it->begin(); it2 != it->end(); it2++) {
-        // delete all PhysicsObject pointers
-        for (auto object = (*it2)->entities.begin(); object != (*it2)->entities.end();) {
-          delete *object;
-          object = (*it2)->entities.erase(object);
-        }
-        delete *it2; // delete Cell
-      }
-      it->clear();
-    }
-    cells.clear();
-    // delete also PhysicsObjects from loose_cell
-    if (loose_cell != nullptr) {
-      for (auto it = loose_cell->entities.begin(); it != loose_cell->entities.end();) {
-        delete *it;
-        it = loose_cell->entities.erase(it);
+    // collect each object only once from its home Cell, other Cells of a
+    // straddling object still read its CellRange so deletion waits until all are visited
+    std::vector<PhysicsObject*> objects;
+    for (unsigned i = 0; i < cell_capacity; i++) {
+      for (auto object : cell_array[i].entities) {
+        if (isHomeCell(&cell_array[i], object)) objects.push_back(object);
       }
-      delete loose_cell;
     }
+    for (auto object : objects) PhysicsObject::destroy(object);
+    // delete all Cells and memory allocated for them
+    grid_columns = 0;
+    grid_rows = 0;
+    cell_capacity = 0;
+    delete[] cell_array;
+    cell_array = nullptr;
   }
 
   // Copy whole Grid, hard copy, private method
   void PhysicsGrid::Copy(const PhysicsGrid& grid) {
-    gridWidth = grid.gridWidth;
-    gridHeight = grid.gridHeight;
-    gridCellSize = grid.gridCellSize;
-
-    for (auto it = grid.cells.begin(); it != grid.cells.end(); it++) {
-      cells.push_back(std::vector<Cell<PhysicsObject*>*>());
-      for (auto it2 = it->begin(); it2 != it->end(); it2++) {
-        Cell<PhysicsObject*>* cell = new Cell<PhysicsObject*>;
-        for (auto object = (*it2)->entities.begin(); object != (*it2)->entities.end(); object++) {
-          if ((*object)->getObjectType() == ObjectType::DynamicObject) {
-            DynamicObject* dyn = static_cast<DynamicObject*> (*object);
-            cell->entities.push_back(new DynamicObject(*dyn));
-          } else {
-            StaticObject* stat = static_cast<StaticObject*> (*object);
-            cell->entities.push_back(new StaticObject(*stat));
-          }
-        }
-        cells.back().push_back(cell);
-      }
-
-    }
-    // copy also loose_cell content
-    if (grid.loose_cell != nullptr) {
-      loose_cell = new Cell<PhysicsObject*>();
-      for (auto& entity : grid.loose_cell->entities) {
-        if (entity->getObjectType() == ObjectType::DynamicObject) {
-          DynamicObject* dyn = static_cast<DynamicObject*> (entity);
-          loose_cell->entities.push_back(new DynamicObject(*dyn));
+    if (grid.cell_array == nullptr) return;
+    addCells(grid.gridWidth, grid.gridHeight, grid.gridCellSize, grid.cell_order);
+    for (unsigned i = 0; i < grid.cell_capacity; i++) {
+      const Cell<PhysicsObject*>* cell = &grid.cell_array[i];
+      for (auto object : cell->entities) {
+        // copy each object only once and insert it to all its Cells
+        if (!isHomeCell(cell, object)) continue;
+        if (object->getObjectType() == ObjectType::DynamicObject) {
+          InsertObject(new DynamicObject(*static_cast<DynamicObject*>(object)));
         } else {
-          StaticObject* stat = static_cast<StaticObject*> (entity);
-          loose_cell->entities.push_back(new StaticObject(*stat));
+          InsertObject(new StaticObject(*static_cast<StaticObject*>(object)));
         }
       }
     }
   }
 
-  // Activate / deactivate Cell, private method
-  bool PhysicsGrid::ActivateCell(Cell<PhysicsObject*>* cell) {
-    for (auto &it : cell->entities) {
-      if (it->getObjectType() == ObjectType::DynamicObject) {
-        cell->active_cell = true;
-        return true;
+  // Insert object to all overlapped Cells, private method
+  void PhysicsGrid::InsertObject(PhysicsObject* object) {
+    CellRange range = GetCellRange(object);
+    setCellRange(object, range);
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+      for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        insertToCell(CellAt(x, y), object);
       }
     }
-    cell->active_cell = false;
-    return false;
+    object->setMoved(false);
   }
 
-  // Try to insert object to cell, private method
-  bool PhysicsGrid::insertObject(PhysicsObject* object) {
-    Cell<PhysicsObject*>* cell1 = GetCorrectCell(object->getMinPosition());
-    Cell<PhysicsObject*>* cell2 = GetCorrectCell(object->getMaxPosition());
-    if ((cell1 == cell2) && (cell1 != nullptr)) {
-      // PhysicsObject is completely inside one Cell
-      cell1->entities.push_back(object);
-      object->setMoved(false);
-      if (object->getObjectType() == ObjectType::DynamicObject) {
-        cell1->active_cell = true;
+  // Remove object from its Cells, private method
+  void PhysicsGrid::RemoveFromCells(PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+      for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        removeFromCell(CellAt(x, y), object);
       }
-      return true;
     }
-    return false;
   }
 
-  // Move loose_cell PhysicsObjects, private method
-  void PhysicsGrid::moveLooseCellObjects() {
-    for (auto it = loose_cell->entities.begin(); it != loose_cell->entities.end();) {
-      if ((*it)->getMoved()) {
-        if (insertObject(*it)) {
-          // object added to cell
-          it = loose_cell->entities.erase(it);
-        } else {
-          (*it)->setMoved(false);
-          it++;
-        }
+  // Get Cells overlapped by object, private method
+  CellRange PhysicsGrid::GetCellRange(PhysicsObject* object) const {
+    CellRange range;
+    CellIndices(object->getMinPosition(), range.min_x, range.min_y);
+    CellIndices(object->getMaxPosition(), range.max_x, range.max_y);
+    return range;
+  }
+
+  // Get Cells overlapped by many objects, private method
+  void PhysicsGrid::GetCellRanges(PhysicsObject* const* objects, unsigned count, CellRange* ranges) const {
+    // corners are gathered to small batches so that CellIndices runs over contiguous arrays
+    const unsigned BatchSize = 64;
+    Vector2f corners[2 * BatchSize];
+    int32_t x[2 * BatchSize];
+    int32_t y[2 * BatchSize];
+    for (unsigned begin = 0; begin < count; begin += BatchSize) {
+      unsigned size = std::min(BatchSize, count - begin);
+      for (unsigned i = 0; i < size; i++) {
+        corners[2 * i] = objects[begin + i]->getMinPosition();
+        corners[2 * i + 1] = objects[begin + i]->getMaxPosition();
+      }
+      CellIndices(corners, 2 * size, x, y);
+      for (unsigned i = 0; i < size; i++) {
+        CellRange& range = ranges[begin + i];
+        range.min_x = x[2 * i];
+        range.min_y = y[2 * i];
+        range.max_x = x[2 * i + 1];
+        range.max_y = y[2 * i + 1];
       }
-      else it++;
     }
   }
 
   // Add Cells
-  void PhysicsGrid::addCells(int gridWidth, int gridHeight, int gridCellSize) {
+  void PhysicsGrid::addCells(int gridWidth, int gridHeight, int gridCellSize, enum CellOrder::CellOrder order) {
+    Clear();
     this->gridWidth = gridWidth;
     this->gridHeight = gridHeight;
     this->gridCellSize = gridCellSize;
-    for (int y = 0; y < gridHeight / gridCellSize; y++) {
-      cells.push_back(std::vector<Cell<PhysicsObject*>*>());
-      for (int x = 0; x < gridWidth / gridCellSize; x++) {
-        cells[y].push_back(new Cell<PhysicsObject*>());
+    int rows = gridHeight / gridCellSize;
+    int columns = gridWidth / gridCellSize;
+    if ((rows <= 0) || (columns <= 0)) return;
+    // precomputed so that CellIndices needs no divisions nor size checks
+    grid_columns = columns;
+    inverse_cell_size = 1.f / gridCellSize;
+    half_width = gridWidth / 2;
+    half_height = gridHeight / 2;
+    last_column = static_cast<float>(columns - 1);
+    last_row = static_cast<float>(rows - 1);
+    grid_rows = rows;
+    cell_order = CellOrder::RowMajor;
+    cell_capacity = rows * columns;
+    if (order == CellOrder::Morton) {
+      // Morton codes index a square of power of two, used only when the padding
+      // at most doubles the amount of Cells
+      uint32_t side = 1;
+      while ((side < static_cast<uint32_t>(rows)) || (side < static_cast<uint32_t>(columns))) side *= 2;
+      if ((side <= 0x10000) && (static_cast<uint64_t>(side) * side <= 2ull * cell_capacity)) {
+        cell_order = CellOrder::Morton;
+        cell_capacity = side * side;
+      }
+    }
+    // one allocation for all Cells, padding Cells are marked with negative coordinates
+    cell_array = new Cell<PhysicsObject*>[cell_capacity];
+    for (unsigned i = 0; i < cell_capacity; i++) {
+      cell_array[i].x = -1;
+      cell_array[i].y = -1;
+    }
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < columns; x++) {
+        Cell<PhysicsObject*>* cell = CellAt(x, y);
+        cell->x = x;
+        cell->y = y;
       }
     }
   }
 
-  // Add object to Cell in PhysicsGrid
+  // Add object to Cells in PhysicsGrid
   bool PhysicsGrid::addObject(PhysicsObject* object) {
-    if (! insertObject(object)) {
-      // PhysicsObject inside multiple Cells, add it to loose_cell
-      loose_cell->entities.push_back(object);
-      loose_cell->active_cell = true;
-      object->setMoved(false);
-    }
+    if (cell_array == nullptr) return false;
+    InsertObject(object);
     return true;
   }
 
-  // Remove object from PhysicsGrid Cell
-  bool PhysicsGrid::removeObject(PhysicsObject* object) {
-    Cell<PhysicsObject*>* cell = GetCorrectCell(object->getPosition());
-    if (cell) {
-      // remove object
-      for (auto item = cell->entities.begin(); item != cell->entities.end(); item++) {
-        if (*item == object) {
-          cell->entities.erase(item);
-          delete object;
-          // check if Cell still active, return value ignored (doesn't matter)
-          ActivateCell(cell);
-          return true;
-        }
+  // Compute CellRanges of objects, called from many threads
+  void PhysicsGrid::locateObjects(PhysicsObject* const* objects, unsigned begin, unsigned end) const {
+    if ((cell_array == nullptr) || (begin >= end)) return;
+    std::vector<CellRange> ranges(end - begin);
+    GetCellRanges(objects + begin, end - begin, ranges.data());
+    for (unsigned i = begin; i < end; i++) {
+      setCellRange(objects[i], ranges[i - begin]);
+    }
+  }
+
+  // Add located objects with one counting pass
+  unsigned PhysicsGrid::addObjects(PhysicsObject* const* objects, unsigned count) {
+    if (cell_array == nullptr) return 0;
+    // counting sort by Cell: reserve every Cell once before inserting
+    std::vector<unsigned> counts(grid_rows * grid_columns, 0);
+    for (unsigned i = 0; i < count; i++) {
+      const CellRange& range = objects[i]->getCellRange();
+      for (int32_t y = range.min_y; y <= range.max_y; y++) {
+        for (int32_t x = range.min_x; x <= range.max_x; x++) counts[y * grid_columns + x]++;
       }
     }
-    // Check also loose_cell
-    for (auto it = loose_cell->entities.begin(); it != loose_cell->entities.end(); it++) {
-      if (*it == object) {
-        loose_cell->entities.erase(it);
-        delete object;
-        if (loose_cell->entities.size() == 0) {
-          loose_cell->active_cell = false;
-        }
-        return true;
+    for (unsigned i = 0; i < counts.size(); i++) {
+      if (counts[i] > 0) {
+        Cell<PhysicsObject*>* cell = CellAt(i % grid_columns, i / grid_columns);
+        cell->entities.reserve(cell->entities.size() + counts[i]);
+      }
+    }
+    for (unsigned i = 0; i < count; i++) {
+      const CellRange& range = objects[i]->getCellRange();
+      for (int32_t y = range.min_y; y <= range.max_y; y++) {
+        for (int32_t x = range.min_x; x <= range.max_x; x++) insertToCell(CellAt(x, y), objects[i]);
       }
+      objects[i]->setMoved(false);
     }
-    return false;
-  }
-
-  // Move PhysicsObjects to correct grid cells
-  void PhysicsGrid::moveObjects() {
-    for (auto it = cells.begin(); it != cells.end(); it++) {
-      for (auto it2 = it->begin(); it2 != it->end(); it2++) {
-        std::list<PhysicsObject*>& physobjs = (*it2)->entities;
-        for (std::list<PhysicsObject*>::iterator i = physobjs.begin(); i != physobjs.end();) {
-          // active_cell isn't enough here because also StaticObjects could have been moved
-          if ((*i)->getMoved()) {
-            // check whether it needs to be moved
-            Cell<PhysicsObject*>* cell1 = GetCorrectCell((*i)->getMinPosition());
-            Cell<PhysicsObject*>* cell2 = GetCorrectCell((*i)->getMaxPosition());
-            if ((cell1 != cell2) || (cell1 == nullptr)) {
-              // remove object from the current Cell
-              addObject(*i);
-              i = physobjs.erase(i);
-            } else {
-              (*i)->setMoved(false);
-              i++;
-            }
-          } else i++;
+    return count;
+  }
+
+  // Remove object from PhysicsGrid Cells
+  bool PhysicsGrid::removeObject(PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    if (range.empty() || (range.min_x < 0) || (range.min_y < 0) || (range.max_x >= grid_columns) ||
+        (static_cast<unsigned>(range.max_y) >= getRows())) return false;
+    // object must be found from its home Cell, otherwise it belongs to another Broadphase
+    if (!inCell(CellAt(range.min_x, range.min_y), object)) return false;
+    RemoveFromCells(object);
+    PhysicsObject::destroy(object);
+    return true;
+  }
+
+  // Move listed PhysicsObjects to correct grid cells
+  void PhysicsGrid::moveObjects(const std::vector<PhysicsObject*>& moved) {
+    if (moved.empty()) return;
+    std::vector<CellRange> ranges(moved.size());
+    GetCellRanges(moved.data(), moved.size(), ranges.data());
+    for (unsigned i = 0; i < moved.size(); i++) {
+      PhysicsObject* object = moved[i];
+      // check whether it needs to be moved
+      if (ranges[i] != object->getCellRange()) {
+        RemoveFromCells(object);
+        setCellRange(object, ranges[i]);
+        for (int32_t y = ranges[i].min_y; y <= ranges[i].max_y; y++) {
+          for (int32_t x = ranges[i].min_x; x <= ranges[i].max_x; x++) insertToCell(CellAt(x, y), object);
         }
       }
+      object->setMoved(false);
+    }
+  }
+
+  // Append Cells to cells
+  void PhysicsGrid::collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) {
+    for (unsigned i = 0; i < cell_capacity; i++) {
+      // padding Cells of Morton order are skipped
+      if ((cell_array[i].x >= 0) && (!active_only || cell_array[i].active_cell)) cells.push_back(&cell_array[i]);
+    }
+  }
+
+  // Find objects overlapping region from the Cells of region
+  void PhysicsGrid::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    if ((cell_array == nullptr) || (max.getX() < min.getX()) || (max.getY() < min.getY())) return;
+    CellRange region;
+    CellIndices(min, region.min_x, region.min_y);
+    CellIndices(max, region.max_x, region.max_y);
+    for (int32_t y = region.min_y; y <= region.max_y; y++) {
+      for (int32_t x = region.min_x; x <= region.max_x; x++) {
+        QueryCell(CellAt(x, y), region, min, max, objects);
+      }
+    }
+  }
+
+  // Map positions to flat Cell ids
+  void PhysicsGrid::getCellIds(const Vector2f* positions, unsigned count, uint32_t* ids) const {
+    if (cell_array == nullptr) return;
+    const unsigned BatchSize = 64;
+    int32_t x[BatchSize];
+    int32_t y[BatchSize];
+    for (unsigned begin = 0; begin < count; begin += BatchSize) {
+      unsigned size = std::min(BatchSize, count - begin);
+      CellIndices(positions + begin, size, x, y);
+      for (unsigned i = 0; i < size; i++) ids[begin + i] = static_cast<uint32_t>(y[i] * grid_columns + x[i]);
     }
-    // Handle loose_cell
-    moveLooseCellObjects();
+  }
 
+  // Get Cell indices, private method
+  void PhysicsGrid::CellIndices(const Vector2f pos, int32_t& x, int32_t& y) const {
+    CellIndices(&pos, 1, &x, &y);
   }
 
-  // Get correct Cell, private method
-  Cell<PhysicsObject*>* PhysicsGrid::GetCorrectCell(const Vector2f pos) const {
-    int x = static_cast<int>(pos.getX());
-    int y = static_cast<int>(pos.getY());
-    if ((gridWidth <= 0) || (gridHeight <= 0) || (gridCellSize <= 0)) return nullptr;
-    int x_index = (gridWidth / 2 + x) / gridCellSize;
-    int y_index = (gridHeight / 2 + y) / gridCellSize;
-    try {
-      return cells.at(y_index).at(x_index);
-    } catch (std::out_of_range &e) {
-      return nullptr;
+  // Get Cell indices of many positions, private method
+  void PhysicsGrid::CellIndices(const Vector2f* positions, unsigned count, int32_t* x, int32_t* y) const {
+    for (unsigned i = 0; i < count; i++) {
+      // clamp before conversion: far away positions and NaN map to the border
+      // Cells, and truncation equals floor for the non-negative result
+      float x_index = (positions[i].getX() + half_width) * inverse_cell_size;
+      float y_index = (positions[i].getY() + half_height) * inverse_cell_size;
+      x[i] = static_cast<int32_t>(std::min(last_column, std::max(0.f, x_index)));
+      y[i] = static_cast<int32_t>(std::min(last_row, std::max(0.f, y_index)));
     }
   }
 
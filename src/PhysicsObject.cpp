@@ -5,12 +5,34 @@
   */
 
 #include "../include/PhysicsObject.hpp"
+#include <atomic>
 
 namespace pe {
 
+  // Take the next unused id
+  uint32_t ObjectId::next() {
+    static std::atomic<uint32_t> counter(0);
+    return counter.fetch_add(1, std::memory_order_relaxed);
+  }
+
   // Constructor
   PhysicsObject::PhysicsObject(Shape *shape, float density, bool static_object, ObjectType::ObjectType type):
-  shape(shape), physics(PhysicsProperties(density, shape->getArea(), static_object)), collision_mask(0x00), type(type), moved(false) {}
+  shape(shape), physics(PhysicsProperties(density, shape->getArea(), static_object)), collision_mask(0x00), type(type), moved(false) {
+    updateTransform();
+  }
+
+  // Free pooled or heap allocated object
+  void PhysicsObject::destroy(PhysicsObject* object) {
+    PoolBase* pool = object->getPool();
+    if (pool == nullptr) {
+      delete object;
+      return;
+    }
+    // slot address is the address of the most derived object
+    void* memory = dynamic_cast<void*>(object);
+    object->~PhysicsObject();
+    pool->release(memory);
+  }
 
   // Get ObjectType
   ObjectType::ObjectType PhysicsObject::getObjectType() const {
@@ -37,15 +59,54 @@ namespace pe {
     return shape;
   }
 
-  // Get physics
-  PhysicsProperties& PhysicsObject::getPhysics() {
-    return physics;
-  }
-
   // Set PhysicsObject position in PhysicsWorld
   void PhysicsObject::setPosition(Vector2f position) {
     physics.setPosition(position);
     moved = true;
+    wake();
+    updateTransform();
+  }
+
+  // Wake sleeping object
+  void PhysicsObject::wake() {
+    sleeping = false;
+    rest_steps = 0;
+  }
+
+  // Put object to sleep
+  void PhysicsObject::sleep() {
+    sleeping = true;
+    physics.velocity.update(0.f, 0.f);
+    physics.acceloration.update(0.f, 0.f);
+  }
+
+  // Update sleep state
+  bool PhysicsObject::updateSleep(float velocity_limit, float distance_limit, unsigned steps) {
+    if (sleeping) return true;
+    float distance = (physics.position - rest_position).getLength();
+    rest_position = physics.position;
+    if ((steps == 0) || (physics.collision_velocity.getLength() >= velocity_limit) || (distance >= distance_limit)) {
+      rest_steps = 0;
+      return false;
+    }
+    if (++rest_steps < steps) return false;
+    sleep();
+    return true;
+  }
+
+  // Refresh world space vertices
+  void PhysicsObject::updateTransform() {
+    if ((shape == nullptr) || isTransformValid()) return;
+    const std::deque<Vector2f>& frame = shape->getFrame();
+    unsigned edges = shape->getEdges();
+    world_vertices.resize(edges);
+    for (unsigned i = 0; i < edges; i++) {
+      world_vertices[i] = frame[i] + physics.position;
+      world_vertices[i].rotate(physics.angle);
+    }
+    transform_position = physics.position;
+    transform_angle = physics.angle;
+    transform_valid = true;
   }
 
   // Get PhysicsObject position in PhysicsWorld
@@ -55,12 +116,12 @@ namespace pe {
 
   // Get min position in PhysicsWorld
   Vector2f PhysicsObject::getMinPosition() const {
-    return getPosition() + shape->getMin();
+    return physics.position + shape->getMin();
   }
 
   // Get max position in PhysicsWorld
   Vector2f PhysicsObject::getMaxPosition() const {
-    return getPosition() + shape->getMax();
+    return physics.position + shape->getMax();
   }
 
   // Set origin transform for PhysicsObject
@@ -36,15 +36,23 @@ namespace pe {
 
   // Apply resisting forces
   void PhysicsProperties::applyResistance(float elapsed_time) {
-    if (resistance_counter % PhysicsProperties::ResistanceInterval == 0)
-    {
-      velocity.update(velocity.getX() * (1.f - elapsed_time / resistance_factor),
-                      velocity.getY() * (1.f - elapsed_time / resistance_factor));
-      acceloration.update(acceloration.getX() * (1.f - elapsed_time / sqrt(resistance_factor)),
-                      acceloration.getY() * (1.f - elapsed_time / sqrt(resistance_factor)));
-      resistance_counter = 0;
-    }
-    resistance_counter++;
+    float velocity_factor, acceloration_factor;
+    resistanceFactors(elapsed_time, velocity_factor, acceloration_factor);
+    velocity.update(velocity.getX() * velocity_factor, velocity.getY() * velocity_factor);
+    acceloration.update(acceloration.getX() * acceloration_factor, acceloration.getY() * acceloration_factor);
+  }
+
+  // Get resistance multipliers
+  void PhysicsProperties::resistanceFactors(float elapsed_time, float& velocity_factor, float& acceloration_factor) {
+    velocity_factor = 1.f;
+    acceloration_factor = 1.f;
+    if (advanceResistance()) resistanceMultipliers(elapsed_time, resistance_factor, velocity_factor, acceloration_factor);
+  }
+
+  // Calculate resistance multipliers
+  void PhysicsProperties::resistanceMultipliers(float elapsed_time, float resistance_factor, float& velocity_factor, float& acceloration_factor) {
+    velocity_factor = 1.f - elapsed_time / resistance_factor;
+    acceloration_factor = 1.f - elapsed_time / sqrt(resistance_factor);
   }
 
   // Calculate inverse of the object mass, private method
@@ -5,6 +5,8 @@
   */
 
 #include "../include/PhysicsWorld.hpp"
+#include <algorithm>
+#include <unordered_map>
 
 namespace pe {
 
@@ -12,10 +14,20 @@ namespace pe {
 
   // Init class variables
   const int PhysicsWorld::GridCellSize = 5000;
+  const unsigned PhysicsWorld::ContactBufferReserve = 256;
+  const unsigned PhysicsWorld::PairTaskSize = 64;
+  const unsigned PhysicsWorld::IslandTaskSize = 64;
+  const unsigned PhysicsWorld::BodyBatchSize = 64;
+  const float PhysicsWorld::BulletOverlap = 0.05f;
   unsigned PhysicsWorld::THREADS = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0;
   int PhysicsWorld::WorldWidth = 100000;
   int PhysicsWorld::WorldHeight = PhysicsWorld::WorldWidth;
   float PhysicsWorld::IterationsInterval = 1.f / 60.f;
+  enum Scheduling::Scheduling PhysicsWorld::WorkScheduling = Scheduling::WorkStealing;
+  float PhysicsWorld::SleepVelocity = 1.f;
+  float PhysicsWorld::SleepDistance = 0.001f;
+  unsigned PhysicsWorld::SleepSteps = 60;
+  enum CellOrder::CellOrder PhysicsWorld::GridCellOrder = CellOrder::RowMajor;
 
   // Set amount of THREADS
   void PhysicsWorld::setThreads(unsigned amount) {
@@ -26,195 +38,632 @@ namespace pe {
     else PhysicsWorld::THREADS = 0; // no worker threads created
   }
 
+  // Set how work is divided between threads
+  void PhysicsWorld::setScheduling(enum Scheduling::Scheduling scheduling) {
+    PhysicsWorld::WorkScheduling = scheduling;
+  }
+
   // Set how many iterations / s
   void PhysicsWorld::setIterationAmount(float iterations) {
     PhysicsWorld::IterationsInterval = 1.f / iterations;
   }
 
+  // Set sleep thresholds
+  void PhysicsWorld::setSleepThresholds(float velocity, float distance, unsigned steps) {
+    PhysicsWorld::SleepVelocity = velocity;
+    PhysicsWorld::SleepDistance = distance;
+    PhysicsWorld::SleepSteps = steps;
+  }
+
+  // Set memory order of PhysicsGrid Cells
+  void PhysicsWorld::setCellOrder(enum CellOrder::CellOrder order) {
+    PhysicsWorld::GridCellOrder = order;
+  }
+
   // Init Grid, private method
-  void PhysicsWorld::InitGrid() {
-    grid->addCells(PhysicsWorld::WorldWidth, PhysicsWorld::WorldHeight, PhysicsWorld::GridCellSize);
+  void PhysicsWorld::InitGrid(int cellSize) {
+    if (broadphase_type == BroadphaseType::HashGrid) {
+      broadphase = new SpatialHashGrid(static_cast<float>(cellSize));
+    } else if (broadphase_type == BroadphaseType::SweepAndPrune) {
+      broadphase = new SweepAndPrune();
+    } else if (broadphase_type == BroadphaseType::AABBTree) {
+      broadphase = new AABBTree();
+    } else {
+      PhysicsGrid* grid = new PhysicsGrid();
+      grid->addCells(PhysicsWorld::WorldWidth, PhysicsWorld::WorldHeight, cellSize > 0 ? cellSize : PhysicsWorld::GridCellSize,
+                     PhysicsWorld::GridCellOrder);
+      broadphase = grid;
+    }
   }
 
   // Constructor
-  PhysicsWorld::PhysicsWorld(): grid(new PhysicsGrid()) {
-    InitGrid();
+  PhysicsWorld::PhysicsWorld(): PhysicsWorld(BroadphaseType::Grid, PhysicsWorld::GridCellSize) {}
+
+  // Constructor with selected Broadphase
+  PhysicsWorld::PhysicsWorld(enum BroadphaseType::BroadphaseType type, int cellSize):
+  broadphase_type(type), pool(new ThreadPool(PhysicsWorld::THREADS)), scheduler(new TaskScheduler(pool)) {
+    InitGrid(cellSize);
   }
 
   // Deconstructor
   PhysicsWorld::~PhysicsWorld() {
-    delete grid;
+    delete scheduler;
+    delete pool;
+    delete broadphase;
   }
 
-  // Copy constructor
+  // Copy constructor, threads are not copied but a new ThreadPool is created
   PhysicsWorld::PhysicsWorld(const PhysicsWorld& world):
-  grid(new PhysicsGrid(*world.grid)), collided(world.collided) {}
+  broadphase_type(world.broadphase_type), broadphase(world.broadphase->clone()), statics(world.statics),
+  pool(new ThreadPool(PhysicsWorld::THREADS)), scheduler(new TaskScheduler(pool)), contacts(world.contacts) {
+    CopyShapes(world);
+  }
 
   // Assignment operator
   PhysicsWorld& PhysicsWorld::operator=(const PhysicsWorld& world) {
+    if (this == &world) return *this;
+    delete broadphase;
+    broadphase_type = world.broadphase_type;
+    broadphase = world.broadphase->clone();
+    statics = world.statics;
+    CopyShapes(world);
+    contacts = world.contacts;
     collided.clear();
-    *grid = *world.grid;
-    collided = world.collided;
+    collided_valid = false;
+    contact_cache.clear();
     return *this;
   }
 
-  // Add PhysicsObject to PhysicsWorld, wrapper call for PhysicsGrid addObject
+  // Copy pooled Shapes of copied objects, private method
+  void PhysicsWorld::CopyShapes(const PhysicsWorld& world) {
+    if (world.shape_pool.size() == 0) return;
+    std::vector<PhysicsObject*> objects;
+    std::vector<Cell<PhysicsObject*>*> cells;
+    broadphase->collectCells(cells, false);
+    for (auto cell : cells) {
+      for (auto object : cell->entities) {
+        if (isHomeCell(cell, object)) objects.push_back(object);
+      }
+    }
+    objects.insert(objects.end(), statics.getObjects().begin(), statics.getObjects().end());
+    std::unordered_map<Shape*, Shape*> copies;
+    for (auto object : objects) {
+      Shape* shape = object->getShape();
+      if ((shape == nullptr) || !world.shape_pool.owns(shape)) continue;
+      auto it = copies.find(shape);
+      if (it == copies.end()) it = copies.emplace(shape, shape_pool.create(*shape)).first;
+      object->replaceShape(it->second);
+    }
+  }
+
+  // Add PhysicsObject to PhysicsWorld, StaticObjects go to StaticGeometry
   bool PhysicsWorld::addObject(PhysicsObject* object) {
-    return grid->addObject(object);
+    if (object->getObjectType() == ObjectType::StaticObject) return statics.addObject(object);
+    return broadphase->addObject(object);
   }
 
-  // Remove PhysicsObject from PhysicsWorld, wrapper call for PhysicsGrid removeObject
+  // Add many PhysicsObjects, Broadphase locations are computed in parallel
+  unsigned PhysicsWorld::addObjects(PhysicsObject* const* objects, unsigned count) {
+    unsigned added = 0;
+    std::vector<PhysicsObject*> dynamics;
+    dynamics.reserve(count);
+    for (unsigned i = 0; i < count; i++) {
+      if (objects[i]->getObjectType() == ObjectType::StaticObject) {
+        if (statics.addObject(objects[i])) added++;
+      } else {
+        dynamics.push_back(objects[i]);
+      }
+    }
+    if (dynamics.empty()) return added;
+    unsigned threads = pool->getWorkers() + 1;
+    unsigned size = dynamics.size();
+    pool->run([this, &dynamics, threads, size] (unsigned index) {
+      broadphase->locateObjects(dynamics.data(), size * index / threads, size * (index + 1) / threads);
+    });
+    return added + broadphase->addObjects(dynamics.data(), size);
+  }
+
+  // Remove PhysicsObject from PhysicsWorld
   bool PhysicsWorld::removeObject(PhysicsObject* object) {
-    return grid->removeObject(object);
+    contact_cache.removeObject(object);
+    if (sleeping_amount > 0) {
+      // objects resting on the removed object must fall, and so must the sleeping objects resting on them
+      std::vector<PhysicsObject*> woken(1, object);
+      std::vector<PhysicsObject*> touching;
+      Vector2f margin(1.f, 1.f);
+      for (unsigned i = 0; i < woken.size(); i++) {
+        touching.clear();
+        broadphase->queryRegion(woken[i]->getMinPosition() - margin, woken[i]->getMaxPosition() + margin, touching);
+        for (auto other : touching) {
+          if (!other->isSleeping()) continue;
+          other->wake();
+          woken.push_back(other);
+        }
+      }
+    }
+    if (object->getObjectType() == ObjectType::StaticObject) return statics.removeObject(object);
+    return broadphase->removeObject(object);
+  }
+
+  // Create box Shape from the pool
+  Shape* PhysicsWorld::createShape(float width, float height) {
+    return shape_pool.create(width, height);
+  }
+
+  // Copy Shape to the pool
+  Shape* PhysicsWorld::createShape(const Shape& shape) {
+    return shape_pool.create(shape);
+  }
+
+  // Return Shape to the pool
+  void PhysicsWorld::destroyShape(Shape* shape) {
+    shape_pool.destroy(shape);
+  }
+
+  // Create DynamicObject from the pool
+  DynamicObject* PhysicsWorld::createDynamicObject(Shape* shape, float density) {
+    DynamicObject* object = dynamic_pool.create(shape, density);
+    object->setPool(&dynamic_pool);
+    return object;
+  }
+
+  // Create StaticObject from the pool
+  StaticObject* PhysicsWorld::createStaticObject(Shape* shape) {
+    StaticObject* object = static_pool.create(shape);
+    object->setPool(&static_pool);
+    return object;
+  }
+
+  // Free object which is not in PhysicsWorld
+  void PhysicsWorld::destroyObject(PhysicsObject* object) {
+    PhysicsObject::destroy(object);
+  }
+
+  // Rebuild StaticGeometry
+  void PhysicsWorld::rebuildStatics() {
+    statics.rebuild();
+  }
+
+  // Find objects overlapping region from Broadphase and StaticGeometry
+  void PhysicsWorld::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    if (statics.isDirty()) statics.rebuild();
+    broadphase->queryRegion(min, max, objects);
+    statics.queryRegion(min, max, objects);
+  }
+
+  // Find objects hit by segment from Broadphase and StaticGeometry
+  void PhysicsWorld::queryRay(const Vector2f from, const Vector2f to, std::vector<PhysicsObject*>& objects) {
+    if (statics.isDirty()) statics.rebuild();
+    std::vector<PhysicsObject*> dynamics;
+    broadphase->queryRay(from, to, dynamics);
+    std::vector<std::pair<float, PhysicsObject*>> hits;
+    for (auto object : dynamics) {
+      float distance = 0.f;
+      Broadphase::RayHit(from, to, object->getMinPosition(), object->getMaxPosition(), distance);
+      hits.push_back(std::make_pair(distance, object));
+    }
+    statics.queryRay(from, to, hits);
+    Broadphase::AppendHits(hits, objects);
   }
 
   // Update PhysicsWorld PhysicsObject positions and calculate collision
   void PhysicsWorld::update() {
     /*
       STEPS
-      0. init collided
+      0. init contacts, one contact buffer per thread
     */
-    collided.clear();
+    contacts.clear();
+    collided_valid = false;
+    if (contact_buffers.size() != PhysicsWorld::THREADS + 1) {
+      contact_buffers.resize(PhysicsWorld::THREADS + 1);
+      for (auto& buffer : contact_buffers) buffer.reserve(PhysicsWorld::ContactBufferReserve);
+      static_queries.resize(PhysicsWorld::THREADS + 1);
+      pair_hits.resize(PhysicsWorld::THREADS + 1);
+      moved_buffers.resize(PhysicsWorld::THREADS + 1);
+      body_stores.resize(PhysicsWorld::THREADS + 1);
+      awake_counts.resize(PhysicsWorld::THREADS + 1);
+      sleeping_counts.resize(PhysicsWorld::THREADS + 1);
+      solvers.resize(PhysicsWorld::THREADS + 1);
+      iteration_counts.resize(PhysicsWorld::THREADS + 1);
+    }
+    if (statics.isDirty()) statics.rebuild();
 
     /*
-      1. Update object physics if DynamicObject (call updatePhysics with elapsed
-       time, IterationsInterval, as argument). This could be done in multiple
-       threads at the same time, threads operate one grid cell. Activate object
-       moved bool.
+      1. Update object physics of awake DynamicObjects. Threads operate one grid
+       cell at a time and gather objects to their own BodyStore, which is
+       integrated with elapsed time IterationsInterval whenever BodyBatchSize
+       objects are gathered. Remaining objects are integrated after all Cells.
+       Objects which moved are stored to the moved buffer of the thread.
     */
     DoWork(WorkType::UpdateObjects);
+    IntegrateBodies();
 
     /*
-      2. Move objects to the correct grid cells (call grid moveObjects)
+      2. Move only moved objects to the correct grid cells (call broadphase moveObjects)
+    */
+    MergeMoved();
+    broadphase->moveObjects(moved);
+    /*
+      2.5 Stop moved bullet objects at the first object they passed through,
+       step 3 then finds the contact like for slower objects
     */
-    grid->moveObjects();
+    SweepBullets();
 
     /*
-      3. Check collisions and store collided objects to collided
+      3. Check collisions and store collided objects to contact buffers
         - Collision may cause objects to change grid cells
         - But it's enough to update objects' grid cells during next update cycle
         step 2
     */
     DoWork(WorkType::CheckCollisions);
-    // check also if objects in loose cell collided with each other or with any other
-    // PhysicsObjects
-    CheckLooseCollisions();
+    DoWork(WorkType::CheckStaticCollisions);
+    MergeContacts();
+    // transitions are tracked before the response moves objects, so that the
+    // cached transforms match the detected contacts
+    contact_cache.beginStep();
+    for (auto& contact : contacts) contact_cache.addContact(contact.first, contact.second, contact.mtv);
+    contact_cache.endStep();
+    /*
+      4. Apply collision response, objects are modified only here
+    */
+    ResolveContacts();
   }
 
-  // Start threads to do specified work, private method
+  // Wake pool threads to do specified work, private method
   void PhysicsWorld::DoWork(enum WorkType::WorkType worktype) {
-    unsigned interval;
-    if ((PhysicsWorld::THREADS > 0) && ((interval = grid->getCellsSize() / PhysicsWorld::THREADS) > 0)) {
-      std::thread *workers = new std::thread[THREADS];
-      auto it = grid->begin();
-      //auto it_inc = [](auto it, unsigned inc) { for (unsigned i = 0; i < inc; i++) it++; return it;};
-      unsigned i = 0;
-      for (; i < PhysicsWorld::THREADS - 1; i++) {
-        auto it2 = it + interval;
-        if (worktype == WorkType::UpdateObjects) {
-          workers[i] = std::thread(&PhysicsWorld::UpdateObjects, this, it, it2);
-        } else {
-          workers[i] = std::thread(&PhysicsWorld::CheckCollisions, this, it, it2);
-        }
-        it = it2;
+    // setThreads may have been called since the previous update
+    pool->resize(PhysicsWorld::THREADS);
+    if ((worktype == WorkType::CheckStaticCollisions) && (statics.getObjectAmount() == 0)) return;
+    if (worktype == WorkType::CheckCollisions) {
+      pairs.clear();
+      if (broadphase->collectPairs(pairs)) {
+        DoPairWork();
+        return;
       }
-
+    }
+    if (PhysicsWorld::WorkScheduling == Scheduling::WorkStealing) {
+      DoCellTaskWork(worktype);
+    }
+    else if (!DoRowPartitionWork(worktype)) {
       if (worktype == WorkType::UpdateObjects) {
-        workers[i] = std::thread(&PhysicsWorld::UpdateObjects, this, it, grid->cend());
-        UpdateLooseObjects();
+        UpdateObjects(0, cell_tasks.size(), 0);
+      } else if (worktype == WorkType::CheckCollisions) {
+        CheckCollisions(0, cell_tasks.size(), 0);
       } else {
-        workers[i] = std::thread(&PhysicsWorld::CheckCollisions, this, it, grid->cend());
+        CheckStaticCollisions(0, cell_tasks.size(), 0);
       }
-      // collect threads
-      for (unsigned j = 0; j < PhysicsWorld::THREADS; j++) {
-        workers[j].join();
+    }
+  }
+
+  // Divide work by equal slices of Cells, private method
+  bool PhysicsWorld::DoRowPartitionWork(enum WorkType::WorkType worktype) {
+    cell_tasks.clear();
+    broadphase->collectCells(cell_tasks, false);
+    unsigned interval;
+    if ((PhysicsWorld::THREADS == 0) || ((interval = cell_tasks.size() / PhysicsWorld::THREADS) == 0)) return false;
+    const unsigned threads = PhysicsWorld::THREADS;
+    const unsigned size = cell_tasks.size();
+    // worker i handles Cells [i * interval, (i + 1) * interval), the last worker
+    // takes the remaining Cells and the calling thread only waits
+    pool->run([this, worktype, threads, interval, size] (unsigned index) {
+      if (index < threads) {
+        unsigned first = index * interval;
+        unsigned last = index == threads - 1 ? size : first + interval;
+        if (worktype == WorkType::UpdateObjects) UpdateObjects(first, last, index);
+        else if (worktype == WorkType::CheckCollisions) CheckCollisions(first, last, index);
+        else CheckStaticCollisions(first, last, index);
       }
-      delete[] workers;
+    });
+    return true;
+  }
+
+  // Run one task per active Cell, private method
+  void PhysicsWorld::DoCellTaskWork(enum WorkType::WorkType worktype) {
+    cell_tasks.clear();
+    broadphase->collectCells(cell_tasks, true);
+    if (worktype == WorkType::UpdateObjects) {
+      scheduler->run(cell_tasks.size(), [this] (unsigned task, unsigned thread) {
+        UpdateCell(cell_tasks[task], thread);
+      });
+    } else if (worktype == WorkType::CheckCollisions) {
+      scheduler->run(cell_tasks.size(), [this] (unsigned task, unsigned thread) {
+        CheckCellCollisions(cell_tasks[task], thread);
+      });
+    } else {
+      scheduler->run(cell_tasks.size(), [this] (unsigned task, unsigned thread) {
+        CheckStaticCellCollisions(cell_tasks[task], thread);
+      });
     }
-    else {
-      if (worktype == WorkType::UpdateObjects) {
-        UpdateObjects(grid->cbegin(), grid->cend());
-        UpdateLooseObjects();
-      } else {
-        CheckCollisions(grid->cbegin(), grid->cend());
+  }
+
+  // Run one task per PairTaskSize pairs, private method
+  void PhysicsWorld::DoPairWork() {
+    unsigned tasks = (pairs.size() + PhysicsWorld::PairTaskSize - 1) / PhysicsWorld::PairTaskSize;
+    scheduler->run(tasks, [this] (unsigned task, unsigned thread) {
+      unsigned begin = task * PhysicsWorld::PairTaskSize;
+      unsigned end = std::min(begin + PhysicsWorld::PairTaskSize, static_cast<unsigned>(pairs.size()));
+      CheckPairs(begin, end, thread);
+    });
+  }
+
+  // Merge contact buffers, private method
+  void PhysicsWorld::MergeContacts() {
+    size_t size = 0;
+    for (auto& buffer : contact_buffers) size += buffer.size();
+    contacts.reserve(size);
+    for (auto& buffer : contact_buffers) {
+      contacts.insert(contacts.end(), buffer.begin(), buffer.end());
+      buffer.clear();
+    }
+  }
+
+  // Merge moved buffers and sleep counts, private method
+  void PhysicsWorld::MergeMoved() {
+    moved.clear();
+    for (auto& buffer : moved_buffers) {
+      moved.insert(moved.end(), buffer.begin(), buffer.end());
+      buffer.clear();
+    }
+    awake_amount = 0;
+    sleeping_amount = 0;
+    for (unsigned i = 0; i < awake_counts.size(); i++) {
+      awake_amount += awake_counts[i];
+      sleeping_amount += sleeping_counts[i];
+      awake_counts[i] = 0;
+      sleeping_counts[i] = 0;
+    }
+  }
+
+  // Sweep moved bullets, private method
+  void PhysicsWorld::SweepBullets() {
+    swept.clear();
+    for (auto object : moved) {
+      if (!object->isBullet()) continue;
+      // integration moved the object by collision_velocity during the step
+      Vector2f motion = object->getPhysics().collision_velocity * PhysicsWorld::IterationsInterval;
+      float distance = motion.getLength();
+      if (!(distance > PhysicsWorld::BulletOverlap)) continue;
+      Vector2f min = object->getMinPosition();
+      Vector2f max = object->getMaxPosition();
+      Vector2f start_min = min - motion;
+      Vector2f start_max = max - motion;
+      min.update(std::min(min.getX(), start_min.getX()), std::min(min.getY(), start_min.getY()));
+      max.update(std::max(max.getX(), start_max.getX()), std::max(max.getY(), start_max.getY()));
+      bullet_candidates.clear();
+      broadphase->queryRegion(min, max, bullet_candidates);
+      statics.queryRegion(min, max, bullet_candidates);
+      float first = 1.f;
+      for (auto other : bullet_candidates) {
+        float toi;
+        if (CollisionDetection::sweepCollision(object, motion, other, toi) && (toi < first)) first = toi;
       }
+      // stop slightly inside the hit object so that the contact is detected
+      float back = (1.f - first) * distance - PhysicsWorld::BulletOverlap;
+      if (back <= 0.f) continue;
+      object->getPhysics().movePosition((-back / distance) * motion);
+      object->updateTransform();
+      swept.push_back(object);
     }
+    if (!swept.empty()) broadphase->moveObjects(swept);
   }
 
-  // Update PhysicsObjects in specific grid partion, private method
-  void PhysicsWorld::UpdateObjects(std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator begin, std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator end) {
-    for (auto it = begin; it != end; it++) {
-      for (auto it2 = it->cbegin(); it2 != it->cend(); it2++) {
-        std::list<PhysicsObject*>& objects = (*it2)->entities;
-        for (auto& object : objects) {
-          if (object->getObjectType() == ObjectType::DynamicObject) {
-            object->updatePhysics(PhysicsWorld::IterationsInterval);
-            object->setMoved(true);
-          }
+  // Apply collision response, private method
+  void PhysicsWorld::ResolveContacts() {
+    islands.clear();
+    resolved.clear();
+    manifolds.clear();
+    for (unsigned i = 0; i < contacts.size(); i++) {
+      struct Collided& contact = contacts[i];
+      PhysicsObject* sleeping = contact.first->isSleeping() ? contact.first : contact.second->isSleeping() ? contact.second : nullptr;
+      if (sleeping != nullptr) {
+        PhysicsObject* other = sleeping == contact.first ? contact.second : contact.first;
+        if ((other->getObjectType() == ObjectType::DynamicObject) && (PhysicsWorld::SleepSteps > 0) &&
+            (other->getRestSteps() >= PhysicsWorld::SleepSteps)) {
+          // object which has rested the whole sleep period joins the sleeping one
+          other->sleep();
+          continue;
         }
+        // otherwise the island is woken and falls asleep together once it rests
+        sleeping->wake();
       }
+      islands.addContact(contact.first, contact.second);
+      resolved.push_back(i);
+      // cache lookups are done here, solving threads only use the pointers
+      manifolds.push_back(contact_cache.getManifold(contact.first, contact.second));
+    }
+    islands.build();
+    small_islands.clear();
+    large_islands.clear();
+    unsigned limit = ContactSolver::getColouringLimit();
+    for (unsigned island = 0; island < islands.size(); island++) {
+      unsigned amount;
+      islands.getContacts(island, amount);
+      if ((limit > 0) && (amount >= limit)) large_islands.push_back(island);
+      else small_islands.push_back(island);
+    }
+    // small islands are grouped so that each task solves IslandTaskSize contacts
+    island_tasks.clear();
+    unsigned task_contacts = 0;
+    for (unsigned i = 0; i < small_islands.size(); i++) {
+      if (task_contacts == 0) island_tasks.push_back(i);
+      unsigned amount;
+      islands.getContacts(small_islands[i], amount);
+      task_contacts += amount;
+      if (task_contacts >= PhysicsWorld::IslandTaskSize) task_contacts = 0;
     }
+    island_tasks.push_back(small_islands.size());
+    for (auto& count : iteration_counts) count = 0;
+    scheduler->run(island_tasks.size() - 1, [this] (unsigned task, unsigned thread) {
+      SolveIslands(island_tasks[task], island_tasks[task + 1], thread);
+    });
+    // coloured islands share the pool, so they are solved after the tasks
+    for (auto island : large_islands) SolveIsland(island, 0, pool);
+    solver_iterations = 0;
+    for (auto count : iteration_counts) solver_iterations = std::max(solver_iterations, count);
   }
 
-  // Update loose_cell objects, private method
-  void PhysicsWorld::UpdateLooseObjects() {
-    std::list<PhysicsObject*> objects = grid->getLooseCell()->entities;
-    for (auto& object : objects) {
-      if (object->getObjectType() == ObjectType::DynamicObject) {
-        object->updatePhysics(PhysicsWorld::IterationsInterval);
-        object->setMoved(true);
+  // Solve small contact islands, private method
+  void PhysicsWorld::SolveIslands(unsigned begin, unsigned end, unsigned thread) {
+    for (unsigned i = begin; i < end; i++) SolveIsland(small_islands[i], thread, nullptr);
+  }
+
+  // Solve one contact island, private method
+  void PhysicsWorld::SolveIsland(unsigned island, unsigned thread, ThreadPool* pool) {
+    ContactSolver& solver = solvers[thread];
+    unsigned amount;
+    const unsigned* island_contacts = islands.getContacts(island, amount);
+    if (pool == nullptr) {
+      for (unsigned i = 0; i < amount; i++) {
+        struct Collided& contact = contacts[resolved[island_contacts[i]]];
+        solver.add(contact.first, contact.second, contact.mtv, manifolds[island_contacts[i]]);
+      }
+    } else {
+      // contact order depends on the threads which found them, ids give the same colours every time
+      ordered_contacts.clear();
+      for (unsigned i = 0; i < amount; i++) {
+        struct Collided& contact = contacts[resolved[island_contacts[i]]];
+        uint64_t id1 = contact.first->getId();
+        uint64_t id2 = contact.second->getId();
+        ordered_contacts.push_back(std::make_pair(id1 < id2 ? (id1 << 32) | id2 : (id2 << 32) | id1, island_contacts[i]));
+      }
+      std::sort(ordered_contacts.begin(), ordered_contacts.end());
+      for (auto& ordered : ordered_contacts) {
+        struct Collided& contact = contacts[resolved[ordered.second]];
+        bool swap = contact.first->getId() > contact.second->getId();
+        solver.add(swap ? contact.second : contact.first, swap ? contact.first : contact.second, contact.mtv, manifolds[ordered.second]);
       }
     }
+    solver.solve(pool);
+    iteration_counts[thread] = std::max(iteration_counts[thread], solver.getIterations());
+    PhysicsObject* const* objects = islands.getObjects(island, amount);
+    unsigned rest_steps = objects[0]->getRestSteps();
+    for (unsigned i = 1; i < amount; i++) rest_steps = std::min(rest_steps, objects[i]->getRestSteps());
+    for (unsigned i = 0; i < amount; i++) objects[i]->limitRestSteps(rest_steps);
   }
 
-  // Check collisions and update collided, private method
-  void PhysicsWorld::CheckCollisions(std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator begin, std::vector<std::vector<Cell<PhysicsObject*>*>>::const_iterator end) {
-    for (auto it = begin; it != end; it++) {
-      for (auto it2 = it->begin(); it2 != it->end(); it2++) {
-        for (auto object1 = (*it2)->entities.begin(); object1 != (*it2)->entities.end(); object1++) {
-          auto object2 = object1;
-          for (++object2; object2 != (*it2)->entities.end(); object2++) {
-            if (CollisionDetection::calculateCollision(*object1, *object2)) {
-              // objects collided, add to those to collided
-              collided_mutex.lock();
-              collided.push_back(Collided(*object1, *object2));
-              collided_mutex.unlock();
-            }
-          }
+  // Update PhysicsObjects in specific grid partion, private method
+  void PhysicsWorld::UpdateObjects(unsigned begin, unsigned end, unsigned thread) {
+    for (unsigned i = begin; i < end; i++) {
+      UpdateCell(cell_tasks[i], thread);
+    }
+  }
+
+  // Update PhysicsObjects of one Cell, private method
+  void PhysicsWorld::UpdateCell(Cell<PhysicsObject*>* cell, unsigned thread) {
+    std::vector<PhysicsObject*>& buffer = moved_buffers[thread];
+    BodyStore& bodies = body_stores[thread];
+    for (auto& object : cell->entities) {
+      if ((object->getObjectType() == ObjectType::DynamicObject) && isHomeCell(cell, object)) {
+        if (object->updateSleep(PhysicsWorld::SleepVelocity, PhysicsWorld::SleepDistance, PhysicsWorld::SleepSteps)) {
+          // object which fell asleep right after collision response is moved once more
+          if (object->getMoved()) buffer.push_back(object);
+          sleeping_counts[thread]++;
+          continue;
+        }
+        awake_counts[thread]++;
+        bodies.add(static_cast<DynamicObject*>(object), PhysicsWorld::IterationsInterval);
+        // objects are stored back while they are still in cache
+        if (bodies.size() >= PhysicsWorld::BodyBatchSize) {
+          bodies.integrate(PhysicsWorld::IterationsInterval);
+          bodies.store(buffer);
         }
       }
     }
   }
 
-  // Check collisions for the loose objects, private method
-  // This is not designed to be multithreaded
-  void PhysicsWorld::CheckLooseCollisions() {
-    Cell<PhysicsObject*>* loose_cell = grid->getLooseCell();
-    for (auto it1 = loose_cell->entities.begin(); it1 != loose_cell->entities.end(); it1++) {
-      auto it2 = it1;
-      for(++it2; it2 != loose_cell->entities.end(); it2++) {
-        // check collisions between other loose objects
-        if (CollisionDetection::calculateCollision(*it1, *it2)) {
-          collided.push_back(Collided(*it1, *it2));
+  // Integrate remaining gathered DynamicObjects, private method
+  void PhysicsWorld::IntegrateBodies() {
+    unsigned size = 0;
+    for (auto& bodies : body_stores) size += bodies.size();
+    if (size == 0) return;
+    pool->run([this] (unsigned index) {
+      if (index < body_stores.size()) {
+        body_stores[index].integrate(PhysicsWorld::IterationsInterval);
+        body_stores[index].store(moved_buffers[index]);
+      }
+    });
+  }
+
+  // Check collisions and store them to thread's contact buffer, private method
+  void PhysicsWorld::CheckCollisions(unsigned begin, unsigned end, unsigned thread) {
+    for (unsigned i = begin; i < end; i++) {
+      CheckCellCollisions(cell_tasks[i], thread);
+    }
+  }
+
+  // Check collisions of pairs and store them to thread's contact buffer, private method
+  void PhysicsWorld::CheckPairs(unsigned begin, unsigned end, unsigned thread) {
+    std::vector<struct Collided>& buffer = contact_buffers[thread];
+    std::vector<std::pair<unsigned, struct CollisionDetection::MTV>>& hits = pair_hits[thread];
+    hits.clear();
+    CollisionDetection::detectCollisions(pairs.data() + begin, end - begin, hits, &contact_cache);
+    for (auto& hit : hits) {
+      const struct ObjectPair& pair = pairs[begin + hit.first];
+      buffer.push_back(Collided(pair.first, pair.second, hit.second));
+    }
+  }
+
+  // Check collisions against StaticGeometry and store them to thread's contact buffer, private method
+  void PhysicsWorld::CheckStaticCollisions(unsigned begin, unsigned end, unsigned thread) {
+    for (unsigned i = begin; i < end; i++) {
+      CheckStaticCellCollisions(cell_tasks[i], thread);
+    }
+  }
+
+  // Check collisions of one Cell against StaticGeometry, private method
+  void PhysicsWorld::CheckStaticCellCollisions(Cell<PhysicsObject*>* cell, unsigned thread) {
+    std::vector<struct Collided>& buffer = contact_buffers[thread];
+    std::vector<PhysicsObject*>& found = static_queries[thread];
+    for (auto object : cell->entities) {
+      if (!isActive(object) || !isHomeCell(cell, object)) continue;
+      found.clear();
+      statics.queryRegion(object->getMinPosition(), object->getMaxPosition(), found);
+      for (auto stat : found) {
+        struct CollisionDetection::MTV mtv;
+        if (CollisionDetection::detectCollision(object, stat, mtv, &contact_cache)) {
+          buffer.push_back(Collided(object, stat, mtv));
         }
       }
-      for (auto it = grid->cbegin(); it != grid->cend(); it++) {
-        for (auto it2 = it->begin(); it2 != it->end(); it2++) {
-          for (auto &object : (*it2)->entities) {
-            // check collisions with other PhysicsObjects
-            if (CollisionDetection::calculateCollision(*it1, object)) {
-              collided.push_back(Collided(*it1, object));
-            }
-          }
+    }
+  }
+
+  // Check collisions of one Cell and store them to thread's contact buffer, private method
+  void PhysicsWorld::CheckCellCollisions(Cell<PhysicsObject*>* cell, unsigned thread) {
+    std::vector<struct Collided>& buffer = contact_buffers[thread];
+    PhysicsObject* const* entities = cell->entities.data();
+    unsigned size = cell->entities.size();
+    for (unsigned i = 0; i < size; i++) {
+      PhysicsObject* object1 = entities[i];
+      bool active1 = isActive(object1);
+      for (unsigned j = i + 1; j < size; j++) {
+        PhysicsObject* object2 = entities[j];
+        if ((!active1 && !isActive(object2)) || !ownsPair(cell, object1, object2)) continue;
+        struct CollisionDetection::MTV mtv;
+        if (CollisionDetection::detectCollision(object1, object2, mtv, &contact_cache)) {
+          // objects collided, buffer is owned by this thread so no locking is needed
+          buffer.push_back(Collided(object1, object2, mtv));
         }
       }
     }
   }
 
+  // Get collided PhysicsObjects as a vector reference
+  std::vector<struct Collided>& PhysicsWorld::getContacts() {
+    return contacts;
+  }
 
   // Get collided PhysicsObjects as a list reference
   std::list<struct Collided>& PhysicsWorld::getCollided() {
+    if (!collided_valid) {
+      collided.assign(contacts.begin(), contacts.end());
+      collided_valid = true;
+    }
     return collided;
   }
 
+  // Get contact transitions of the latest update
+  const std::vector<struct ContactEvent>& PhysicsWorld::getContactEvents() const {
+    return contact_cache.getEvents();
+  }
+
 } // end of namespace pe
@@ -13,7 +13,7 @@ namespace pe {
   Shape::Shape(): area(0.f) {}
 
   // Box shape constructor
-  Shape::Shape(float width, float height) {
+  Shape::Shape(float width, float height): type(ShapeType::Box) {
     width = std::abs(width) / 2.f;
     height = std::abs(height) / 2.f;
     frame.push_back( Vector2f(-width, -height) );
@@ -29,7 +29,7 @@ namespace pe {
   }
 
   //  Copy constructor
-  Shape::Shape(const Shape& shape) {
+  Shape::Shape(const Shape& shape): type(shape.type) {
     for (Vector2f item : shape.frame) {
       frame.push_back(item);
     }
@@ -41,6 +41,7 @@ namespace pe {
   // Assignment overload
   Shape& Shape::operator=(const Shape& shape) {
     frame.clear();
+    type = shape.type;
     for (Vector2f item : shape.frame) {
       frame.push_back(item);
     }
@@ -0,0 +1,308 @@
+/**
+  *   @file SpatialHashGrid.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class SpatialHashGrid
+  */
+
+#include "../include/SpatialHashGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace pe {
+
+  // Empty constructor
+  SpatialHashGrid::SpatialHashGrid(): SpatialHashGrid(SpatialHashGrid::DefaultCellSize) {}
+
+  // Constructor
+  SpatialHashGrid::SpatialHashGrid(float cellSize) {
+    cellSize = std::abs(cellSize);
+    this->cellSize = cellSize > 0.f ? cellSize : SpatialHashGrid::DefaultCellSize;
+    inverseCellSize = 1.f / this->cellSize;
+    Rehash(SpatialHashGrid::MinTableSize);
+  }
+
+  // Deconstructor
+  SpatialHashGrid::~SpatialHashGrid() {
+    Clear();
+  }
+
+  // Copy constructor
+  SpatialHashGrid::SpatialHashGrid(const SpatialHashGrid& grid) {
+    Copy(grid);
+  }
+
+  // Assignment operator
+  SpatialHashGrid& SpatialHashGrid::operator=(const SpatialHashGrid& grid) {
+    if (this != &grid) {
+      Clear();
+      Copy(grid);
+    }
+    return *this;
+  }
+
+  // Clone SpatialHashGrid
+  Broadphase* SpatialHashGrid::clone() const {
+    return new SpatialHashGrid(*this);
+  }
+
+  // Add object to SpatialHashGrid
+  bool SpatialHashGrid::addObject(PhysicsObject* object) {
+    InsertObject(object);
+    return true;
+  }
+
+  // Compute CellRanges of objects, called from many threads
+  void SpatialHashGrid::locateObjects(PhysicsObject* const* objects, unsigned begin, unsigned end) const {
+    for (unsigned i = begin; i < end; i++) {
+      setCellRange(objects[i], GetCellRange(objects[i]));
+    }
+  }
+
+  // Add located objects, tables are grown once for the whole batch
+  unsigned SpatialHashGrid::addObjects(PhysicsObject* const* objects, unsigned count) {
+    // new Cells are bounded by references and by the area the batch covers
+    uint64_t references = 0;
+    CellRange bounds = count > 0 ? objects[0]->getCellRange() : CellRange();
+    for (unsigned i = 0; i < count; i++) {
+      const CellRange& range = objects[i]->getCellRange();
+      references += objects[i]->getCellSlots().size();
+      bounds.min_x = std::min(bounds.min_x, range.min_x);
+      bounds.min_y = std::min(bounds.min_y, range.min_y);
+      bounds.max_x = std::max(bounds.max_x, range.max_x);
+      bounds.max_y = std::max(bounds.max_y, range.max_y);
+    }
+    uint64_t area = count > 0 ? static_cast<uint64_t>(bounds.max_x - bounds.min_x + 1) * (bounds.max_y - bounds.min_y + 1) : 0;
+    uint64_t created = std::min(references, area);
+    // one rehash and reserve for the whole batch
+    uint64_t size = table.size();
+    while ((cells.size() + created) * 2 > size) size *= 2;
+    if (size != table.size()) Rehash(static_cast<unsigned>(size));
+    cells.reserve(cells.size() + created);
+    for (unsigned i = 0; i < count; i++) {
+      const CellRange& range = objects[i]->getCellRange();
+      for (int32_t y = range.min_y; y <= range.max_y; y++) {
+        for (int32_t x = range.min_x; x <= range.max_x; x++) {
+          Cell<PhysicsObject*>& cell = cells[GetOrCreateCell(x, y)];
+          if (cell.entities.empty()) empty_cells--;
+          insertToCell(&cell, objects[i]);
+        }
+      }
+      objects[i]->setMoved(false);
+    }
+    return count;
+  }
+
+  // Remove object from SpatialHashGrid
+  bool SpatialHashGrid::removeObject(PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    if (range.empty()) return false;
+    // object must be found from its home Cell, otherwise it belongs to another Broadphase
+    uint32_t index = FindCell(range.min_x, range.min_y);
+    if (index == SpatialHashGrid::EmptySlot) return false;
+    if (!inCell(&cells[index], object)) return false;
+    RemoveFromCells(object);
+    PhysicsObject::destroy(object);
+    return true;
+  }
+
+  // Move listed objects to correct Cells
+  void SpatialHashGrid::moveObjects(const std::vector<PhysicsObject*>& moved) {
+    for (auto object : moved) {
+      if (GetCellRange(object) != object->getCellRange()) {
+        RemoveFromCells(object);
+        InsertObject(object);
+      } else {
+        object->setMoved(false);
+      }
+    }
+    // release empty Cells when they start to dominate
+    if ((empty_cells > SpatialHashGrid::MinTableSize) && (empty_cells > cells.size() / 2)) {
+      Compact();
+    }
+  }
+
+  // Append Cells to cells
+  void SpatialHashGrid::collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) {
+    for (auto& cell : this->cells) {
+      if (active_only ? cell.active_cell : !cell.entities.empty()) cells.push_back(&cell);
+    }
+  }
+
+  // Find objects overlapping region from the Cells of region
+  void SpatialHashGrid::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    if ((max.getX() < min.getX()) || (max.getY() < min.getY())) return;
+    CellRange region;
+    CellCoordinates(min, region.min_x, region.min_y);
+    CellCoordinates(max, region.max_x, region.max_y);
+    // large region, cheaper to check the allocated Cells
+    double region_cells = (static_cast<double>(region.max_x) - region.min_x + 1) * (static_cast<double>(region.max_y) - region.min_y + 1);
+    if (region_cells > cells.size()) {
+      Broadphase::queryRegion(min, max, objects);
+      return;
+    }
+    for (int32_t y = region.min_y; y <= region.max_y; y++) {
+      for (int32_t x = region.min_x; x <= region.max_x; x++) {
+        uint32_t index = FindCell(x, y);
+        if (index != SpatialHashGrid::EmptySlot) QueryCell(&cells[index], region, min, max, objects);
+      }
+    }
+  }
+
+  // Convert position to Cell coordinates, private method
+  void SpatialHashGrid::CellCoordinates(const Vector2f pos, int32_t& x, int32_t& y) const {
+    // clamp to int32_t range, objects far away just share the border Cells
+    const float limit = 2147483520.f;
+    float fx = std::floor(pos.getX() * inverseCellSize);
+    float fy = std::floor(pos.getY() * inverseCellSize);
+    x = static_cast<int32_t>(std::min(limit, std::max(-limit, fx)));
+    y = static_cast<int32_t>(std::min(limit, std::max(-limit, fy)));
+  }
+
+  // Find Cell index, private method
+  uint32_t SpatialHashGrid::FindCell(int32_t x, int32_t y) const {
+    uint32_t mask = table.size() - 1;
+    for (uint32_t i = Hash(x, y) & mask; ; i = (i + 1) & mask) {
+      const Slot& slot = table[i];
+      if (slot.cell == SpatialHashGrid::EmptySlot) return SpatialHashGrid::EmptySlot;
+      if ((slot.x == x) && (slot.y == y)) return slot.cell;
+    }
+  }
+
+  // Find or create Cell, private method
+  uint32_t SpatialHashGrid::GetOrCreateCell(int32_t x, int32_t y) {
+    uint32_t mask = table.size() - 1;
+    uint32_t i = Hash(x, y) & mask;
+    for (; table[i].cell != SpatialHashGrid::EmptySlot; i = (i + 1) & mask) {
+      if ((table[i].x == x) && (table[i].y == y)) return table[i].cell;
+    }
+    // create new Cell, keep load factor below 0.5
+    uint32_t index = cells.size();
+    cells.push_back(Cell<PhysicsObject*>());
+    empty_cells++;
+    cells.back().x = x;
+    cells.back().y = y;
+    table[i].x = x;
+    table[i].y = y;
+    table[i].cell = index;
+    if (cells.size() * 2 > table.size()) Rehash(table.size() * 2);
+    return index;
+  }
+
+  // Hash Cell coordinates, private method
+  uint32_t SpatialHashGrid::Hash(int32_t x, int32_t y) {
+    // 64-bit finalizer of MurmurHash3
+    uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return static_cast<uint32_t>(key);
+  }
+
+  // Rebuild table, private method
+  void SpatialHashGrid::Rehash(unsigned size) {
+    Slot empty;
+    empty.x = 0;
+    empty.y = 0;
+    empty.cell = SpatialHashGrid::EmptySlot;
+    table.assign(size, empty);
+    uint32_t mask = size - 1;
+    for (uint32_t index = 0; index < cells.size(); index++) {
+      int32_t x = cells[index].x;
+      int32_t y = cells[index].y;
+      uint32_t i = Hash(x, y) & mask;
+      while (table[i].cell != SpatialHashGrid::EmptySlot) i = (i + 1) & mask;
+      table[i].x = x;
+      table[i].y = y;
+      table[i].cell = index;
+    }
+  }
+
+  // Release empty Cells, private method
+  void SpatialHashGrid::Compact() {
+    unsigned kept = 0;
+    for (unsigned i = 0; i < cells.size(); i++) {
+      if (cells[i].entities.empty()) continue;
+      if (kept != i) cells[kept] = std::move(cells[i]);
+      kept++;
+    }
+    cells.resize(kept);
+    empty_cells = 0;
+    unsigned size = SpatialHashGrid::MinTableSize;
+    while (size < 2 * kept) size *= 2;
+    Rehash(size);
+  }
+
+  // Insert object to all overlapped Cells, private method
+  void SpatialHashGrid::InsertObject(PhysicsObject* object) {
+    CellRange range = GetCellRange(object);
+    setCellRange(object, range);
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+      for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        // GetOrCreateCell may reallocate cells, so index is used
+        Cell<PhysicsObject*>& cell = cells[GetOrCreateCell(x, y)];
+        if (cell.entities.empty()) empty_cells--;
+        insertToCell(&cell, object);
+      }
+    }
+    object->setMoved(false);
+  }
+
+  // Remove object from its Cells, private method
+  void SpatialHashGrid::RemoveFromCells(PhysicsObject* object) {
+    const CellRange& range = object->getCellRange();
+    for (int32_t y = range.min_y; y <= range.max_y; y++) {
+      for (int32_t x = range.min_x; x <= range.max_x; x++) {
+        uint32_t index = FindCell(x, y);
+        if (index == SpatialHashGrid::EmptySlot) continue;
+        Cell<PhysicsObject*>& cell = cells[index];
+        removeFromCell(&cell, object);
+        if (cell.entities.empty()) empty_cells++;
+      }
+    }
+  }
+
+  // Get Cells overlapped by object, private method
+  CellRange SpatialHashGrid::GetCellRange(PhysicsObject* object) const {
+    CellRange range;
+    CellCoordinates(object->getMinPosition(), range.min_x, range.min_y);
+    CellCoordinates(object->getMaxPosition(), range.max_x, range.max_y);
+    return range;
+  }
+
+  // Delete all objects and Cells, private method
+  void SpatialHashGrid::Clear() {
+    // each object is deleted only once from its home Cell, after all Cells
+    // have been visited since other Cells of a straddling object read its CellRange
+    std::vector<PhysicsObject*> objects;
+    for (auto& cell : cells) {
+      for (auto object : cell.entities) {
+        if (isHomeCell(&cell, object)) objects.push_back(object);
+      }
+    }
+    for (auto object : objects) PhysicsObject::destroy(object);
+    cells.clear();
+    empty_cells = 0;
+    Rehash(SpatialHashGrid::MinTableSize);
+  }
+
+  // Copy grid, private method
+  void SpatialHashGrid::Copy(const SpatialHashGrid& grid) {
+    cellSize = grid.cellSize;
+    inverseCellSize = grid.inverseCellSize;
+    Rehash(SpatialHashGrid::MinTableSize);
+    for (auto& cell : grid.cells) {
+      for (auto object : cell.entities) {
+        // copy each object only once and insert it to all its Cells
+        if (!isHomeCell(&cell, object)) continue;
+        if (object->getObjectType() == ObjectType::DynamicObject) {
+          InsertObject(new DynamicObject(*static_cast<DynamicObject*>(object)));
+        } else {
+          InsertObject(new StaticObject(*static_cast<StaticObject*>(object)));
+        }
+      }
+    }
+  }
+
+} // end of namespace pe
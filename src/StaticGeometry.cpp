@@ -0,0 +1,166 @@
+/**
+  *   @file StaticGeometry.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class StaticGeometry
+  */
+
+#include "../include/StaticGeometry.hpp"
+#include "../include/Broadphase.hpp"
+#include <algorithm>
+
+namespace pe {
+
+  // Empty constructor
+  StaticGeometry::StaticGeometry() {}
+
+  // Deconstructor
+  StaticGeometry::~StaticGeometry() {
+    Clear();
+  }
+
+  // Copy constructor
+  StaticGeometry::StaticGeometry(const StaticGeometry& geometry) {
+    Copy(geometry);
+  }
+
+  // Assignment operator
+  StaticGeometry& StaticGeometry::operator=(const StaticGeometry& geometry) {
+    if (this != &geometry) {
+      Clear();
+      Copy(geometry);
+    }
+    return *this;
+  }
+
+  // Add StaticObject
+  bool StaticGeometry::addObject(PhysicsObject* object) {
+    if (object->getObjectType() != ObjectType::StaticObject) return false;
+    object->getProxy() = objects.size();
+    objects.push_back(object);
+    object->setMoved(false);
+    dirty = true;
+    return true;
+  }
+
+  // Remove StaticObject
+  bool StaticGeometry::removeObject(PhysicsObject* object) {
+    uint32_t index = object->getProxy();
+    if ((index >= objects.size()) || (objects[index] != object)) return false;
+    // swap the last object to the removed index
+    objects[index] = objects.back();
+    objects[index]->getProxy() = index;
+    objects.pop_back();
+    PhysicsObject::destroy(object);
+    dirty = true;
+    return true;
+  }
+
+  // Build hierarchy
+  void StaticGeometry::rebuild() {
+    items.clear();
+    nodes.clear();
+    dirty = false;
+    if (objects.empty()) return;
+    items.reserve(objects.size());
+    for (auto object : objects) {
+      items.push_back(Item{object->getMinPosition(), object->getMaxPosition(), object});
+    }
+    // leaves are full apart from the last ones, so about 2 * items / LeafSize nodes
+    nodes.reserve(2 * (items.size() / StaticGeometry::LeafSize + 1));
+    Build(0, items.size(), 0);
+  }
+
+  // Find objects overlapping region
+  void StaticGeometry::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) const {
+    if (nodes.empty()) return;
+    uint32_t stack[StaticGeometry::MaxDepth];
+    unsigned size = 0;
+    stack[size++] = 0;
+    while (size > 0) {
+      const Node& node = nodes[stack[--size]];
+      if ((node.max.getX() < min.getX()) || (max.getX() < node.min.getX()) ||
+          (node.max.getY() < min.getY()) || (max.getY() < node.min.getY())) continue;
+      if (node.count == 0) {
+        stack[size++] = &node - nodes.data() + 1;
+        stack[size++] = node.first;
+        continue;
+      }
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        const Item& item = items[i];
+        if ((item.max.getX() < min.getX()) || (max.getX() < item.min.getX()) ||
+            (item.max.getY() < min.getY()) || (max.getY() < item.min.getY())) continue;
+        objects.push_back(item.object);
+      }
+    }
+  }
+
+  // Find objects hit by segment
+  void StaticGeometry::queryRay(const Vector2f from, const Vector2f to, std::vector<std::pair<float, PhysicsObject*>>& hits) const {
+    if (nodes.empty()) return;
+    uint32_t stack[StaticGeometry::MaxDepth];
+    unsigned size = 0;
+    stack[size++] = 0;
+    while (size > 0) {
+      const Node& node = nodes[stack[--size]];
+      float distance;
+      if (!Broadphase::RayHit(from, to, node.min, node.max, distance)) continue;
+      if (node.count == 0) {
+        stack[size++] = &node - nodes.data() + 1;
+        stack[size++] = node.first;
+        continue;
+      }
+      for (uint32_t i = node.first; i < node.first + node.count; i++) {
+        if (Broadphase::RayHit(from, to, items[i].min, items[i].max, distance)) {
+          hits.push_back(std::make_pair(distance, items[i].object));
+        }
+      }
+    }
+  }
+
+  // Build subtree, private method
+  void StaticGeometry::Build(uint32_t begin, uint32_t end, unsigned depth) {
+    uint32_t index = nodes.size();
+    nodes.push_back(Node{items[begin].min, items[begin].max, begin, end - begin});
+    Vector2f center_min = (items[begin].min + items[begin].max) * 0.5f;
+    Vector2f center_max = center_min;
+    for (uint32_t i = begin; i < end; i++) {
+      Node& node = nodes[index];
+      node.min.update(std::min(node.min.getX(), items[i].min.getX()), std::min(node.min.getY(), items[i].min.getY()));
+      node.max.update(std::max(node.max.getX(), items[i].max.getX()), std::max(node.max.getY(), items[i].max.getY()));
+      Vector2f center = (items[i].min + items[i].max) * 0.5f;
+      center_min.update(std::min(center_min.getX(), center.getX()), std::min(center_min.getY(), center.getY()));
+      center_max.update(std::max(center_max.getX(), center.getX()), std::max(center_max.getY(), center.getY()));
+    }
+    // a traversal stack entry is needed for every level and the sibling
+    if ((end - begin <= StaticGeometry::LeafSize) || (depth + 2 >= StaticGeometry::MaxDepth)) return;
+    // split at the median of the longer axis of object centers, rounded so
+    // that the left subtree has only full leaves
+    bool x_axis = center_max.getX() - center_min.getX() >= center_max.getY() - center_min.getY();
+    uint32_t half = ((end - begin) / 2 + StaticGeometry::LeafSize - 1) / StaticGeometry::LeafSize * StaticGeometry::LeafSize;
+    uint32_t middle = begin + half;
+    std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end, [x_axis] (const Item& a, const Item& b) {
+      return x_axis ? a.min.getX() + a.max.getX() < b.min.getX() + b.max.getX() : a.min.getY() + a.max.getY() < b.min.getY() + b.max.getY();
+    });
+    nodes[index].count = 0;
+    Build(begin, middle, depth + 1);
+    nodes[index].first = nodes.size();
+    Build(middle, end, depth + 1);
+  }
+
+  // Delete all objects, private method
+  void StaticGeometry::Clear() {
+    for (auto object : objects) PhysicsObject::destroy(object);
+    objects.clear();
+    items.clear();
+    nodes.clear();
+    dirty = false;
+  }
+
+  // Copy objects, private method
+  void StaticGeometry::Copy(const StaticGeometry& geometry) {
+    for (auto object : geometry.objects) {
+      addObject(new StaticObject(*static_cast<StaticObject*>(object)));
+    }
+  }
+
+} // end of namespace pe
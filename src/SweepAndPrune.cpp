@@ -0,0 +1,212 @@
+/**
+  *   @file SweepAndPrune.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class SweepAndPrune
+  */
+
+#include "../include/SweepAndPrune.hpp"
+#include <algorithm>
+
+namespace pe {
+
+  // Empty constructor
+  SweepAndPrune::SweepAndPrune() {}
+
+  // Deconstructor
+  SweepAndPrune::~SweepAndPrune() {
+    Clear();
+  }
+
+  // Copy constructor
+  SweepAndPrune::SweepAndPrune(const SweepAndPrune& sap) {
+    Copy(sap);
+  }
+
+  // Assignment operator
+  SweepAndPrune& SweepAndPrune::operator=(const SweepAndPrune& sap) {
+    if (this != &sap) {
+      Clear();
+      Copy(sap);
+    }
+    return *this;
+  }
+
+  // Clone SweepAndPrune
+  Broadphase* SweepAndPrune::clone() const {
+    return new SweepAndPrune(*this);
+  }
+
+  // Add object to SweepAndPrune
+  bool SweepAndPrune::addObject(PhysicsObject* object) {
+    uint32_t index;
+    if (free_proxies.empty()) {
+      index = proxies.size();
+      proxies.push_back(Proxy());
+    } else {
+      index = free_proxies.back();
+      free_proxies.pop_back();
+    }
+    Proxy& proxy = proxies[index];
+    proxy.object = object;
+    UpdateBounds(proxy);
+    // new endpoints are appended, SortEndpoints moves them to the correct place
+    endpoints.push_back(Endpoint{proxy.min.getX(), index | SweepAndPrune::MinEndpoint});
+    endpoints.push_back(Endpoint{proxy.max.getX(), index});
+    sorted = false;
+    // bucket works as the home Cell of the object
+    buckets.add(object, index);
+    object->getProxy() = index;
+    object->setMoved(false);
+    return true;
+  }
+
+  // Remove object from SweepAndPrune
+  bool SweepAndPrune::removeObject(PhysicsObject* object) {
+    uint32_t index = object->getProxy();
+    if ((index >= proxies.size()) || (proxies[index].object != object)) return false;
+    // endpoints are dropped in one pass during the next sort, so removing
+    // many objects doesn't scan endpoints for each of them
+    buckets.remove(object);
+    proxies[index].object = nullptr;
+    removed_proxies.push_back(index);
+    PhysicsObject::destroy(object);
+    return true;
+  }
+
+  // Update bounds of listed objects and sort endpoints
+  void SweepAndPrune::moveObjects(const std::vector<PhysicsObject*>& moved) {
+    for (auto object : moved) {
+      UpdateBounds(proxies[object->getProxy()]);
+      object->setMoved(false);
+    }
+    SortEndpoints();
+  }
+
+  // Append bucket Cells to cells
+  void SweepAndPrune::collectCells(std::vector<Cell<PhysicsObject*>*>& cells, bool active_only) {
+    buckets.collect(cells, active_only);
+  }
+
+  // Append overlapping pairs to pairs
+  bool SweepAndPrune::collectPairs(std::vector<struct ObjectPair>& pairs) {
+    if (!sorted || !removed_proxies.empty()) SortEndpoints();
+    open.clear();
+    for (auto& endpoint : endpoints) {
+      uint32_t index = endpoint.proxy & ~SweepAndPrune::MinEndpoint;
+      if (!(endpoint.proxy & SweepAndPrune::MinEndpoint)) {
+        // max endpoint, proxy can't overlap with the following proxies
+        auto it = std::find(open.begin(), open.end(), index);
+        *it = open.back();
+        open.pop_back();
+        continue;
+      }
+      const Proxy& proxy = proxies[index];
+      bool active = isActive(proxy.object);
+      for (auto other_index : open) {
+        const Proxy& other = proxies[other_index];
+        // all open proxies overlap on x axis
+        if ((proxy.max.getY() < other.min.getY()) || (other.max.getY() < proxy.min.getY())) continue;
+        if (!active && !isActive(other.object)) continue;
+        pairs.push_back(ObjectPair{other.object, proxy.object});
+      }
+      open.push_back(index);
+    }
+    return true;
+  }
+
+  // Find objects overlapping region from the sorted endpoints
+  void SweepAndPrune::queryRegion(const Vector2f min, const Vector2f max, std::vector<PhysicsObject*>& objects) {
+    if (!sorted) SortEndpoints();
+    // endpoints of removed proxies are still in order, they are skipped
+    auto it = std::lower_bound(endpoints.begin(), endpoints.end(), min.getX() - max_width, [] (const Endpoint& endpoint, float value) {
+      return endpoint.value < value;
+    });
+    for (; (it != endpoints.end()) && (it->value <= max.getX()); it++) {
+      if (!(it->proxy & SweepAndPrune::MinEndpoint)) continue;
+      const Proxy& proxy = proxies[it->proxy & ~SweepAndPrune::MinEndpoint];
+      if ((proxy.object == nullptr) || (proxy.max.getX() < min.getX()) ||
+          (proxy.max.getY() < min.getY()) || (max.getY() < proxy.min.getY())) continue;
+      objects.push_back(proxy.object);
+    }
+  }
+
+  // Store object bounds, private method
+  void SweepAndPrune::UpdateBounds(Proxy& proxy) {
+    proxy.min = proxy.object->getMinPosition();
+    proxy.max = proxy.object->getMaxPosition();
+    max_width = std::max(max_width, proxy.max.getX() - proxy.min.getX());
+  }
+
+  // Refresh and sort endpoints, private method
+  void SweepAndPrune::SortEndpoints() {
+    if (!removed_proxies.empty()) {
+      // sorted and appended endpoints are compacted separately to keep the boundary
+      auto removed = [this] (const Endpoint& endpoint) {
+        return proxies[endpoint.proxy & ~SweepAndPrune::MinEndpoint].object == nullptr;
+      };
+      auto boundary = std::remove_if(endpoints.begin(), endpoints.begin() + sorted_endpoints, removed);
+      auto end = std::remove_if(endpoints.begin() + sorted_endpoints, endpoints.end(), removed);
+      end = std::move(endpoints.begin() + sorted_endpoints, end, boundary);
+      sorted_endpoints = boundary - endpoints.begin();
+      endpoints.erase(end, endpoints.end());
+      free_proxies.insert(free_proxies.end(), removed_proxies.begin(), removed_proxies.end());
+      removed_proxies.clear();
+    }
+    max_width = 0.f;
+    for (auto& endpoint : endpoints) {
+      const Proxy& proxy = proxies[endpoint.proxy & ~SweepAndPrune::MinEndpoint];
+      endpoint.value = endpoint.proxy & SweepAndPrune::MinEndpoint ? proxy.min.getX() : proxy.max.getX();
+      max_width = std::max(max_width, proxy.max.getX() - proxy.min.getX());
+    }
+    // insertion sort, objects move only a little between updates so the
+    // endpoints are nearly sorted. Min endpoints go first on equal values so
+    // that touching objects are paired
+    auto less = [] (const Endpoint& a, const Endpoint& b) {
+      return (a.value < b.value) || ((a.value == b.value) && (a.proxy & SweepAndPrune::MinEndpoint) && !(b.proxy & SweepAndPrune::MinEndpoint));
+    };
+    for (size_t i = 1; i < sorted_endpoints; i++) {
+      Endpoint endpoint = endpoints[i];
+      size_t j = i;
+      for (; (j > 0) && less(endpoint, endpoints[j - 1]); j--) {
+        endpoints[j] = endpoints[j - 1];
+      }
+      endpoints[j] = endpoint;
+    }
+    // appended endpoints are in random order, insertion sort would be quadratic
+    if (sorted_endpoints < endpoints.size()) {
+      auto boundary = endpoints.begin() + sorted_endpoints;
+      std::stable_sort(boundary, endpoints.end(), less);
+      std::inplace_merge(endpoints.begin(), boundary, endpoints.end(), less);
+      sorted_endpoints = endpoints.size();
+    }
+    sorted = true;
+  }
+
+  // Delete all objects, private method
+  void SweepAndPrune::Clear() {
+    for (auto& proxy : proxies) {
+      if (proxy.object != nullptr) PhysicsObject::destroy(proxy.object);
+    }
+    proxies.clear();
+    free_proxies.clear();
+    removed_proxies.clear();
+    endpoints.clear();
+    buckets.clear();
+    sorted = true;
+    sorted_endpoints = 0;
+    max_width = 0.f;
+  }
+
+  // Copy objects, private method
+  void SweepAndPrune::Copy(const SweepAndPrune& sap) {
+    for (auto& proxy : sap.proxies) {
+      if (proxy.object == nullptr) continue;
+      if (proxy.object->getObjectType() == ObjectType::DynamicObject) {
+        addObject(new DynamicObject(*static_cast<DynamicObject*>(proxy.object)));
+      } else {
+        addObject(new StaticObject(*static_cast<StaticObject*>(proxy.object)));
+      }
+    }
+  }
+
+} // end of namespace pe
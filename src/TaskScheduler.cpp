@@ -0,0 +1,90 @@
+/**
+  *   @file TaskScheduler.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class TaskScheduler
+  */
+
+#include "../include/TaskScheduler.hpp"
+
+namespace pe {
+
+  // Constructor
+  TaskScheduler::TaskScheduler(ThreadPool* pool): pool(pool) {}
+
+  // Run tasks using all pool threads
+  void TaskScheduler::run(unsigned tasks, const std::function<void(unsigned, unsigned)>& task) {
+    if (tasks == 0) return;
+    unsigned threads = getThreads();
+    if (threads == 1 || tasks == 1) {
+      // nothing to balance
+      for (unsigned i = 0; i < tasks; i++) task(i, threads - 1);
+      return;
+    }
+    ReserveQueues();
+    // initial even split, the remainder is given to the first queues
+    unsigned interval = tasks / threads;
+    unsigned remainder = tasks % threads;
+    unsigned begin = 0;
+    for (unsigned i = 0; i < threads; i++) {
+      unsigned end = begin + interval + (i < remainder ? 1 : 0);
+      queues[i].begin = begin;
+      queues[i].end = end;
+      begin = end;
+    }
+    pool->run([this, &task] (unsigned thread) {
+      unsigned index;
+      while (Pop(thread, index) || Steal(thread, index)) {
+        task(index, thread);
+      }
+    });
+  }
+
+  // Pop task from own deque, private method
+  bool TaskScheduler::Pop(unsigned thread, unsigned& task) {
+    TaskQueue& queue = queues[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.begin < queue.end) {
+      task = queue.begin++;
+      return true;
+    }
+    return false;
+  }
+
+  // Steal tasks from other deques, private method
+  bool TaskScheduler::Steal(unsigned thread, unsigned& task) {
+    // no new tasks are created during run, so once every deque has been seen
+    // empty the thread can finish
+    for (unsigned i = 1; i < queue_amount; i++) {
+      TaskQueue& victim = queues[(thread + i) % queue_amount];
+      unsigned begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        unsigned remaining = victim.end - victim.begin;
+        if (remaining == 0) continue;
+        unsigned stolen = (remaining + 1) / 2;
+        end = victim.end;
+        begin = end - stolen;
+        victim.end = begin;
+      }
+      task = begin;
+      if (begin + 1 < end) {
+        TaskQueue& own = queues[thread];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin + 1;
+        own.end = end;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Reserve TaskQueues, private method
+  void TaskScheduler::ReserveQueues() {
+    unsigned threads = getThreads();
+    if (queue_amount != threads) {
+      queues.reset(new TaskQueue[threads]);
+      queue_amount = threads;
+    }
+  }
+
+} // end of namespace pe
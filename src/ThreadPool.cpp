@@ -0,0 +1,93 @@
+/**
+  *   @file ThreadPool.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains source for class ThreadPool
+  */
+
+#include "../include/ThreadPool.hpp"
+
+namespace pe {
+
+  // Constructor
+  ThreadPool::ThreadPool(unsigned workers) {
+    Start(workers);
+  }
+
+  // Deconstructor
+  ThreadPool::~ThreadPool() {
+    Stop();
+  }
+
+  // Run job in all threads and wait until every thread is finished
+  void ThreadPool::run(const std::function<void(unsigned)>& job) {
+    unsigned amount = workers.size();
+    if (amount) {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->job = &job;
+      pending = amount;
+      generation++;
+    }
+    wake_condition.notify_all();
+    // calling thread takes the last index
+    job(amount);
+    if (amount) {
+      std::unique_lock<std::mutex> lock(mutex);
+      done_condition.wait(lock, [this] { return pending == 0; });
+      this->job = nullptr;
+    }
+  }
+
+  // Change amount of workers
+  void ThreadPool::resize(unsigned workers) {
+    if (workers == this->workers.size()) return;
+    Stop();
+    Start(workers);
+  }
+
+  // Worker thread main loop, private method
+  void ThreadPool::WorkerLoop(unsigned index) {
+    unsigned long seen = 0;
+    while (true) {
+      const std::function<void(unsigned)>* current;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        wake_condition.wait(lock, [this, seen] { return stop || generation != seen; });
+        if (stop) return;
+        seen = generation;
+        current = job;
+      }
+      (*current)(index);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending--;
+        if (pending == 0) done_condition.notify_one();
+      }
+    }
+  }
+
+  // Create workers, private method
+  void ThreadPool::Start(unsigned amount) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = false;
+      generation = 0;
+    }
+    for (unsigned i = 0; i < amount; i++) {
+      workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+    }
+  }
+
+  // Join all workers, private method
+  void ThreadPool::Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    wake_condition.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    workers.clear();
+  }
+
+} // end of namespace pe
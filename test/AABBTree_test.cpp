@@ -0,0 +1,118 @@
+/**
+  *   @file AABBTree_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for AABBTree
+  */
+
+
+#include "../include/AABBTree.hpp"
+#include "../include/DynamicObject.hpp"
+#include "../include/StaticObject.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+  *   @brief Check whether pairs contain pair of objects
+  *   @param pairs pairs returned by collectPairs
+  *   @param object1 1st object
+  *   @param object2 2nd object
+  *   @return true if pair found, otherwise false
+  */
+bool containsPair(const std::vector<pe::ObjectPair>& pairs, pe::PhysicsObject* object1, pe::PhysicsObject* object2) {
+  for (auto& pair : pairs) {
+    if ((pair.first == object1 && pair.second == object2) || (pair.first == object2 && pair.second == object1)) return true;
+  }
+  return false;
+}
+
+/**
+  *   @brief Test main for AABBTree
+  */
+int main() {
+  std::cout << "AABBTree test" << std::endl << std::endl;
+
+  std::cout << "Insert test" << std::endl;
+  pe::AABBTree tree;
+  assert(tree.getHeight() == -1);
+  pe::Shape shape(10.f, 10.f);
+  std::vector<pe::PhysicsObject*> objects;
+  // row of objects inserted in sorted order, worst case without rotations
+  for (int i = 0; i < 1024; i++) {
+    pe::StaticObject* stat = new pe::StaticObject(&shape);
+    stat->setPosition(pe::Vector2f(100.f * i, 0.f));
+    assert(tree.addObject(stat));
+    objects.push_back(stat);
+  }
+  assert(tree.getObjectAmount() == 1024);
+  assert(tree.getHeight() <= 20); // balanced, log2(1024) = 10
+  std::vector<pe::ObjectPair> pairs;
+  assert(tree.collectPairs(pairs));
+  assert(pairs.empty()); // only StaticObjects
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Pair test" << std::endl;
+  pe::DynamicObject* box = new pe::DynamicObject(&shape, 1.f);
+  box->setPosition(pe::Vector2f(105.f, 5.f)); // overlaps objects[1]
+  tree.addObject(box);
+  pe::DynamicObject* box2 = new pe::DynamicObject(&shape, 1.f);
+  box2->setPosition(pe::Vector2f(108.f, 12.f)); // overlaps box and objects[1]
+  tree.addObject(box2);
+  pairs.clear();
+  tree.collectPairs(pairs);
+  assert(containsPair(pairs, box, objects[1]) && containsPair(pairs, box2, objects[1]) && containsPair(pairs, box, box2));
+  unsigned dynamic_pairs = 0;
+  for (auto& pair : pairs) {
+    if ((pair.first == box || pair.first == box2) && (pair.second == box || pair.second == box2)) dynamic_pairs++;
+  }
+  assert(dynamic_pairs == 1); // found once
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Move test" << std::endl;
+  // small move stays inside the fat box
+  box->setPosition(pe::Vector2f(106.f, 5.f));
+  tree.moveObjects();
+  assert(!box->getMoved());
+  // far move reinserts
+  box->setPosition(pe::Vector2f(50005.f, 5.f));
+  tree.moveObjects();
+  pairs.clear();
+  tree.collectPairs(pairs);
+  assert(containsPair(pairs, box, objects[500]) && !containsPair(pairs, box, objects[1]));
+  assert(tree.getHeight() <= 20);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Query test" << std::endl;
+  std::vector<pe::PhysicsObject*> found;
+  tree.queryRegion(pe::Vector2f(190.f, -1.f), pe::Vector2f(410.f, 1.f), found);
+  assert(found.size() == 3); // objects 2, 3 and 4
+  found.clear();
+  tree.queryRay(pe::Vector2f(1000.f, -100.f), pe::Vector2f(1000.f, 100.f), found);
+  assert(found.size() == 1 && found[0] == objects[10]);
+  found.clear();
+  // along the row, closest first
+  tree.queryRay(pe::Vector2f(-50.f, 0.f), pe::Vector2f(350.f, 0.f), found);
+  assert(found.size() >= 4);
+  assert(found[0] == objects[0] && found[1] == objects[1]);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Copy and remove test" << std::endl;
+  pe::AABBTree copy = tree;
+  assert(copy.getObjectAmount() == tree.getObjectAmount());
+  assert(!copy.removeObject(box)); // not owned by copy
+  for (unsigned i = 0; i < objects.size(); i += 2) {
+    assert(tree.removeObject(objects[i]));
+  }
+  assert(tree.getObjectAmount() == 514);
+  assert(tree.getHeight() <= 20);
+  found.clear();
+  tree.queryRegion(pe::Vector2f(-1000.f, -100.f), pe::Vector2f(1e6f, 100.f), found);
+  assert(found.size() == 514);
+  pe::DynamicObject outside(&shape, 1.f);
+  assert(!tree.removeObject(&outside)); // never added
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All AABBTree tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,125 @@
+/**
+  *   @file BodyStore_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for BodyStore
+  */
+
+
+#include "../include/BodyStore.hpp"
+#include "../include/DynamicObject.hpp"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+/**
+  *   @brief Check whether objects have exactly the same state
+  *   @param object1 1st object
+  *   @param object2 2nd object
+  *   @return true if position, velocity, acceloration and collision_velocity match
+  */
+bool sameState(pe::DynamicObject& object1, pe::DynamicObject& object2) {
+  pe::PhysicsProperties& physics1 = object1.getPhysics();
+  pe::PhysicsProperties& physics2 = object2.getPhysics();
+  return (physics1.position == physics2.position) && (physics1.velocity == physics2.velocity) &&
+         (physics1.acceloration == physics2.acceloration) && (physics1.collision_velocity == physics2.collision_velocity) &&
+         (object1.getPrevPosition() == object2.getPrevPosition()) && (physics1.resistance_counter == physics2.resistance_counter);
+}
+
+/**
+  *   @brief Integrate objects with BodyStore and updatePhysics and compare results
+  *   @param steps how many updates are compared
+  *   @param amount how many objects, not a multiple of register width
+  *   @return true if results are bitwise identical
+  */
+bool compareIntegration(unsigned steps, unsigned amount) {
+  pe::Shape shape(10.f, 10.f);
+  std::vector<pe::DynamicObject*> reference;
+  std::vector<pe::DynamicObject*> stored;
+  for (unsigned i = 0; i < amount; i++) {
+    for (auto objects : {&reference, &stored}) {
+      pe::DynamicObject* object = new pe::DynamicObject(&shape, 1.f + i);
+      object->setPosition(pe::Vector2f(13.f * i, -7.f * i));
+      object->setVelocity(pe::Vector2f(3.f * i - 50.f, 100.f - 5.f * i));
+      object->setForce(pe::Vector2f(i * 11.f, -(i * 3.f)));
+      // resistance is applied every other update, start from different phases
+      object->getPhysics().resistance_counter = i % 3;
+      // cached resistance multipliers must follow resistance_factor
+      object->getPhysics().resistance_factor = 1.2f + i % 4 / 2 * 0.3f;
+      objects->push_back(object);
+    }
+  }
+  pe::BodyStore bodies;
+  std::vector<pe::PhysicsObject*> moved;
+  bool same = true;
+  for (unsigned step = 0; step < steps; step++) {
+    // time step changes too
+    const float interval = step < steps / 2 ? 1.f / 60.f : 1.f / 30.f;
+    for (auto object : reference) object->updatePhysics(interval);
+    for (auto object : stored) bodies.add(object, interval);
+    assert(bodies.size() == stored.size());
+    bodies.integrate(interval);
+    moved.clear();
+    bodies.store(moved);
+    assert(bodies.size() == 0);
+    assert(moved.size() == stored.size());
+    for (unsigned i = 0; i < stored.size(); i++) {
+      same = same && sameState(*reference[i], *stored[i]);
+      assert(stored[i]->isTransformValid());
+    }
+  }
+  for (auto object : reference) delete object;
+  for (auto object : stored) delete object;
+  return same;
+}
+
+/**
+  *   @brief Test main for BodyStore
+  */
+int main() {
+  std::cout << "BodyStore test" << std::endl << std::endl;
+
+  std::cout << "Integration test" << std::endl;
+  assert(pe::BodyStore::isSupported(pe::Kernel::Scalar));
+  pe::Kernel::Kernel best = pe::BodyStore::getKernel();
+  assert(pe::BodyStore::getDeterministic());
+  for (auto kernel : {pe::Kernel::Scalar, pe::Kernel::SSE, pe::Kernel::AVX2}) {
+    if (!pe::BodyStore::setKernel(kernel)) {
+      assert(!pe::BodyStore::isSupported(kernel) && pe::BodyStore::getKernel() != kernel);
+      std::cout << "kernel " << kernel << " not supported" << std::endl;
+      continue;
+    }
+    assert(pe::BodyStore::getKernel() == kernel);
+    assert(compareIntegration(10, 37)); // bitwise identical
+    assert(compareIntegration(4, 203)); // arrays grow past their first size
+  }
+  pe::BodyStore::setDeterministic(false);
+  compareIntegration(10, 37); // only checks that fast mode runs
+  pe::BodyStore::setDeterministic(true);
+  pe::BodyStore::setKernel(best);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Moved test" << std::endl;
+  const float interval = 1.f / 60.f;
+  pe::Shape shape(10.f, 10.f);
+  pe::BodyStore bodies;
+  std::vector<pe::PhysicsObject*> moved;
+  pe::DynamicObject still(&shape, 1.f);
+  float gravity = pe::PhysicsProperties::GravityY;
+  pe::PhysicsProperties::GravityY = 0.f;
+  still.setMoved(false);
+  bodies.add(&still, interval);
+  bodies.integrate(interval);
+  moved.clear();
+  bodies.store(moved);
+  assert(moved.empty() && !still.getMoved()); // no velocity and no gravity
+  still.setMoved(true);
+  bodies.add(&still, interval);
+  bodies.integrate(interval);
+  bodies.store(moved);
+  assert(moved.size() == 1 && moved[0] == &still); // flagged objects are moved
+  pe::PhysicsProperties::GravityY = gravity;
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All BodyStore tests passed" << std::endl;
+  return 0;
+}
@@ -11,6 +11,29 @@
 #include "../include/Shape.hpp"
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+  *   @brief Generic separating axis test, used as reference for the box path
+  *   @param obj1 1st object
+  *   @param obj2 2nd object
+  *   @param mtv minimum translation vector is stored here
+  *   @return true if objects collided
+  */
+bool genericCollision(pe::PhysicsObject* obj1, pe::PhysicsObject* obj2, pe::CollisionDetection::MTV& mtv) {
+  if (!pe::CollisionDetection::objectsClose(obj1, obj2) || !pe::CollisionDetection::canCollide(obj1, obj2)) return false;
+  mtv = pe::CollisionDetection::MTV();
+  for (auto object : {obj1, obj2}) {
+    for (auto& axis : object->getShape()->getAxis()) {
+      pe::CollisionDetection::Projection proj1 = pe::CollisionDetection::ProjectShape(axis, obj1->getPhysics().position, obj1->getShape(), 0.f);
+      pe::CollisionDetection::Projection proj2 = pe::CollisionDetection::ProjectShape(axis, obj2->getPhysics().position, obj2->getShape(), 0.f);
+      if (!pe::CollisionDetection::overlap(proj1, proj2)) return false;
+      mtv = pe::CollisionDetection::StoreMTV(mtv, axis, proj1, proj2);
+    }
+  }
+  return true;
+}
 
 /**
   *   @brief Test main for CollisionDetection
@@ -104,6 +127,114 @@ int main() {
 
   std::cout << "test successful" << std::endl;
 
+  std::cout << std::endl << "Box fast path test" << std::endl;
+  pe::Shape small(30.f, 20.f);
+  assert(shape.getType() == pe::ShapeType::Box && pe::Shape(small).getType() == pe::ShapeType::Box);
+  assert(pe::Shape().getType() == pe::ShapeType::Polygon);
+  pe::StaticObject center(&shape);
+  center.setPosition(pe::Vector2f(-40.f, 30.f)); // negative coordinates too
+  std::vector<pe::PhysicsObject*> boxes;
+  std::vector<pe::ObjectPair> pairs;
+  for (int y = -8; y <= 8; y++) {
+    for (int x = -8; x <= 8; x++) {
+      pe::DynamicObject* box = new pe::DynamicObject(&small, 1.f);
+      box->setPosition(pe::Vector2f(-40.f + 9.5f * x, 30.f + 8.25f * y));
+      boxes.push_back(box);
+      pairs.push_back(pe::ObjectPair{box, &center});
+    }
+  }
+  unsigned collided = 0;
+  std::vector<std::pair<unsigned, pe::CollisionDetection::MTV>> hits;
+  pe::CollisionDetection::detectCollisions(pairs.data(), pairs.size(), hits);
+  for (unsigned i = 0; i < boxes.size(); i++) {
+    assert(pe::CollisionDetection::isAxisAlignedBox(boxes[i]));
+    pe::CollisionDetection::MTV fast, generic;
+    bool hit = pe::CollisionDetection::detectCollision(boxes[i], &center, fast);
+    assert(hit == genericCollision(boxes[i], &center, generic));
+    if (!hit) continue;
+    collided++;
+    assert(std::abs(fast.amount - generic.amount) < 1e-3f);
+    bool batched = false;
+    for (auto& item : hits) {
+      if (item.first == i) {
+        batched = item.second.amount == fast.amount && item.second.axis == fast.axis;
+      }
+    }
+    assert(batched); // batch gives the same result
+  }
+  assert(collided == hits.size() && collided > 0 && collided < boxes.size());
+  // collision masks are respected
+  center.setCollisionMask(0xFF);
+  hits.clear();
+  pe::CollisionDetection::detectCollisions(pairs.data(), pairs.size(), hits);
+  assert(hits.empty());
+  for (auto box : boxes) delete box;
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "World vertex cache test" << std::endl;
+  pe::DynamicObject cached(&shape, 1.f);
+  cached.setPosition(pe::Vector2f(500.f, 500.f));
+  assert(cached.isTransformValid() && cached.getWorldVertices().size() == static_cast<unsigned>(shape.getEdges()));
+  for (auto& axis : shape.getAxis()) {
+    pe::CollisionDetection::Projection proj1 = pe::CollisionDetection::ProjectObject(axis, &cached);
+    pe::CollisionDetection::Projection proj2 = pe::CollisionDetection::ProjectShape(axis, cached.getPhysics().position, &shape, 0.f);
+    assert(proj1.min == proj2.min && proj1.max == proj2.max);
+  }
+  // direct modification invalidates cache, projection falls back to the Shape
+  cached.getPhysics().position += pe::Vector2f(1000.f, 0.f);
+  assert(!cached.isTransformValid());
+  pe::StaticObject wall(&shape);
+  wall.setPosition(pe::Vector2f(1500.f, 500.f));
+  pe::CollisionDetection::MTV mtv;
+  assert(pe::CollisionDetection::detectCollision(&cached, &wall, mtv));
+  cached.updateTransform();
+  assert(cached.isTransformValid() && pe::CollisionDetection::detectCollision(&cached, &wall, mtv));
+  // integration moves object, cache is refreshed explicitly
+  cached.updatePhysics(interval);
+  assert(!cached.isTransformValid());
+  cached.updateTransform();
+  assert(cached.isTransformValid());
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Sweep test" << std::endl;
+  {
+    pe::Shape box(20.f, 20.f);
+    pe::Shape thin(2.f, 100.f);
+    pe::DynamicObject moving(&box, 1.f);
+    pe::StaticObject wall(&thin);
+    wall.setPosition(pe::Vector2f(50.f, -40.f));
+    // box ended past the wall, its start was 100 units to the left
+    moving.setPosition(pe::Vector2f(100.f, 0.f));
+    pe::Vector2f motion(100.f, 0.f);
+    pe::CollisionDetection::MTV sweep_mtv;
+    assert(!pe::CollisionDetection::detectCollision(&moving, &wall, sweep_mtv));
+    float toi = -1.f;
+    assert(pe::CollisionDetection::sweepCollision(&moving, motion, &wall, toi));
+    float expected = (wall.getMinPosition().getX() - (moving.getMaxPosition().getX() - 100.f)) / 100.f;
+    assert(std::abs(toi - expected) < 1e-4f && toi > 0.f && toi < 1.f);
+    // diagonal motion which passes above the wall misses it
+    moving.setPosition(pe::Vector2f(100.f, -200.f));
+    assert(!pe::CollisionDetection::sweepCollision(&moving, pe::Vector2f(100.f, -60.f), &wall, toi));
+    // diagonal motion through the wall hits it later than the straight one
+    moving.setPosition(pe::Vector2f(100.f, 30.f));
+    float diagonal;
+    assert(pe::CollisionDetection::sweepCollision(&moving, pe::Vector2f(100.f, 30.f), &wall, diagonal));
+    assert(std::abs(diagonal - toi) < 1e-4f);
+    // moving away or stopping before the wall
+    moving.setPosition(pe::Vector2f(-100.f, 0.f));
+    assert(!pe::CollisionDetection::sweepCollision(&moving, pe::Vector2f(-100.f, 0.f), &wall, toi));
+    moving.setPosition(pe::Vector2f(20.f, 0.f));
+    assert(!pe::CollisionDetection::sweepCollision(&moving, pe::Vector2f(10.f, 0.f), &wall, toi));
+    // overlap at the start is left to detectCollision
+    moving.setPosition(pe::Vector2f(45.f, 0.f));
+    assert(!pe::CollisionDetection::sweepCollision(&moving, pe::Vector2f(5.f, 0.f), &wall, toi));
+    // collision masks are respected
+    moving.setPosition(pe::Vector2f(100.f, 0.f));
+    moving.setCollisionMask(0xFF);
+    assert(!pe::CollisionDetection::sweepCollision(&moving, motion, &wall, toi));
+  }
+  std::cout << "test successful" << std::endl;
+
   std::cout << std::endl << "All tests passed" << std::endl;
   return 0;
 }
@@ -0,0 +1,183 @@
+/**
+  *   @file ContactCache_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for ContactCache and PhysicsWorld contact events
+  */
+
+
+#include "../include/ContactCache.hpp"
+#include "../include/PhysicsWorld.hpp"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+/**
+  *   @brief Count events of one state
+  *   @param events events to be counted
+  *   @param state counted ContactState
+  *   @return amount of events in state
+  */
+unsigned countEvents(const std::vector<struct pe::ContactEvent>& events, enum pe::ContactState::ContactState state) {
+  unsigned amount = 0;
+  for (auto& event : events) {
+    if (event.state == state) amount++;
+  }
+  return amount;
+}
+
+/**
+  *   @brief Main test function
+  */
+int main() {
+  std::cout << "Object id test" << std::endl;
+  pe::Shape shape(10.f, 10.f);
+  pe::DynamicObject a(&shape, 1.f);
+  pe::DynamicObject b(&shape, 1.f);
+  pe::DynamicObject copy(a);
+  assert(a.getId() != b.getId() && copy.getId() != a.getId());
+  copy = b;
+  assert(copy.getId() != b.getId()); // assignment keeps the id
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Transition test" << std::endl;
+  {
+    pe::ContactCache cache;
+    pe::DynamicObject c(&shape, 1.f);
+    pe::CollisionDetection::MTV mtv;
+    mtv.axis = pe::Vector2f(0.f, 1.f);
+    mtv.amount = 2.f;
+    cache.beginStep();
+    cache.addContact(&a, &b, mtv);
+    cache.addContact(&b, &c, mtv);
+    cache.endStep();
+    assert(cache.size() == 2);
+    assert(countEvents(cache.getEvents(), pe::ContactState::Begin) == 2);
+    // order of the objects doesn't matter
+    cache.beginStep();
+    cache.addContact(&b, &a, mtv);
+    cache.endStep();
+    assert(cache.getEvents().size() == 2);
+    assert(cache.getEvents()[0].state == pe::ContactState::Persist);
+    assert(cache.getEvents()[1].state == pe::ContactState::End);
+    assert(cache.getEvents()[1].first == &b && cache.getEvents()[1].second == &c);
+    assert(cache.size() == 1);
+    // ended pair begins again
+    cache.beginStep();
+    cache.addContact(&a, &b, mtv);
+    cache.addContact(&c, &b, mtv);
+    cache.endStep();
+    assert(countEvents(cache.getEvents(), pe::ContactState::Persist) == 1);
+    assert(countEvents(cache.getEvents(), pe::ContactState::Begin) == 1);
+    // pairs of removed objects are dropped without events
+    cache.removeObject(&c);
+    cache.beginStep();
+    cache.addContact(&a, &b, mtv);
+    cache.endStep();
+    assert(cache.getEvents().size() == 1 && cache.size() == 1);
+    // inactive pairs aren't checked, so they persist silently
+    a.sleep();
+    b.sleep();
+    cache.beginStep();
+    cache.endStep();
+    assert(cache.getEvents().empty() && cache.size() == 1);
+    b.wake();
+    cache.beginStep();
+    cache.endStep();
+    assert(cache.getEvents().size() == 1 && cache.getEvents()[0].state == pe::ContactState::End);
+    assert(cache.size() == 0);
+    a.wake();
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Reuse test" << std::endl;
+  {
+    pe::ContactCache cache;
+    pe::DynamicObject c(&shape, 1.f);
+    pe::DynamicObject d(&shape, 1.f);
+    c.setPosition(pe::Vector2f(0.f, 0.f));
+    d.setPosition(pe::Vector2f(8.f, 3.f));
+    pe::CollisionDetection::MTV mtv, cached;
+    mtv.axis = pe::Vector2f(1.f, 0.f);
+    mtv.amount = 2.f;
+    assert(!cache.reuse(&c, &d, cached));
+    cache.beginStep();
+    cache.addContact(&c, &d, mtv);
+    cache.endStep();
+    assert(cache.reuse(&c, &d, cached));
+    assert(cached.axis == mtv.axis && cached.amount == mtv.amount);
+    assert(!cache.reuse(&d, &c, cached)); // only in the same order
+    // moving both objects keeps the relative transform
+    c.setPosition(pe::Vector2f(100.f, 50.f));
+    d.setPosition(pe::Vector2f(108.f, 53.f));
+    assert(cache.reuse(&c, &d, cached));
+    d.setPosition(pe::Vector2f(108.5f, 53.f));
+    assert(!cache.reuse(&c, &d, cached));
+    d.setPosition(pe::Vector2f(108.f, 53.f));
+    d.getPhysics().angle = 0.1f;
+    assert(!cache.reuse(&c, &d, cached));
+    d.getPhysics().angle = 0.f;
+    // only results of the previous step are reused
+    cache.beginStep();
+    cache.addContact(&c, &d, mtv);
+    cache.endStep();
+    cache.beginStep();
+    cache.addContact(&c, &d, mtv);
+    cache.endStep();
+    assert(cache.reuse(&c, &d, cached));
+    // narrow phase returns the cached result for an unchanged rotated pair
+    pe::DynamicObject e(&shape, 1.f);
+    pe::DynamicObject f(&shape, 1.f);
+    e.setPosition(pe::Vector2f(0.f, 0.f));
+    f.setPosition(pe::Vector2f(6.f, 3.f));
+    e.getPhysics().angle = 0.3f;
+    f.getPhysics().angle = 0.3f;
+    pe::CollisionDetection::MTV detected;
+    assert(pe::CollisionDetection::detectCollision(&e, &f, detected, &cache));
+    cache.beginStep();
+    cache.addContact(&e, &f, detected);
+    cache.endStep();
+    pe::CollisionDetection::MTV again;
+    assert(pe::CollisionDetection::detectCollision(&e, &f, again, &cache));
+    assert(again.axis == detected.axis && again.amount == detected.amount);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "PhysicsWorld event test" << std::endl;
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+    pe::PhysicsWorld world(type, 100);
+    pe::StaticObject* ground = world.createStaticObject(world.createShape(1000.f, 20.f));
+    ground->setPosition(pe::Vector2f(0.f, 20.f));
+    assert(world.addObject(ground));
+    std::vector<pe::PhysicsObject*> boxes;
+    for (int i = 0; i < 10; i++) {
+      pe::DynamicObject* box = world.createDynamicObject(&shape, 1.f);
+      box->setPosition(pe::Vector2f(i * 30.f - 150.f, 18.f)); // overlaps the ground
+      assert(world.addObject(box));
+      boxes.push_back(box);
+    }
+    unsigned begun = 0, ended = 0;
+    for (int step = 0; step < 60; step++) {
+      world.update();
+      // every contact is reported as a Begin or a Persist event
+      const std::vector<struct pe::ContactEvent>& events = world.getContactEvents();
+      assert(countEvents(events, pe::ContactState::Begin) + countEvents(events, pe::ContactState::Persist) == world.getContacts().size());
+      begun += countEvents(events, pe::ContactState::Begin);
+      ended += countEvents(events, pe::ContactState::End);
+    }
+    assert(begun >= boxes.size());
+    assert(begun - ended <= boxes.size());
+    // boxes leaving the ground end their contacts
+    for (auto box : boxes) box->setPosition(box->getPosition() + pe::Vector2f(0.f, -500.f));
+    world.update();
+    assert(world.getContacts().empty());
+    assert(countEvents(world.getContactEvents(), pe::ContactState::End) == begun - ended);
+    // removed objects don't produce events
+    assert(world.removeObject(boxes[0]));
+    world.update();
+    for (auto& event : world.getContactEvents()) assert(event.first != boxes[0] && event.second != boxes[0]);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All ContactCache tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,352 @@
+/**
+  *   @file ContactSolver_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for contact Manifolds and ContactSolver
+  */
+
+
+#include "../include/ContactSolver.hpp"
+#include "../include/PhysicsWorld.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+  *   @brief Add StaticObject ground whose top is at y = 90
+  *   @param world PhysicsWorld where the ground is added
+  *   @param ground_shape Shape of the ground, height 20
+  */
+void addGround(pe::PhysicsWorld& world, pe::Shape& ground_shape) {
+  pe::StaticObject* ground = new pe::StaticObject(&ground_shape);
+  ground->setPosition(pe::Vector2f(0.f, 100.f));
+  assert(world.addObject(ground));
+}
+
+/**
+  *   @brief Build a stack of boxes standing on the ground
+  *   @param world PhysicsWorld where the boxes are added
+  *   @param box_shape Shape of the boxes, 20 x 20
+  *   @param x horizontal position of the stack
+  *   @param height amount of boxes
+  *   @param gap vertical space left below each box
+  *   @return boxes from the bottom to the top
+  */
+std::vector<pe::DynamicObject*> buildStack(pe::PhysicsWorld& world, pe::Shape& box_shape, float x, unsigned height, float gap = 0.f) {
+  std::vector<pe::DynamicObject*> boxes;
+  for (unsigned i = 0; i < height; i++) {
+    pe::DynamicObject* box = new pe::DynamicObject(&box_shape, 1.f);
+    box->setPosition(pe::Vector2f(x, 80.f - (20.f + gap) * i - gap));
+    assert(world.addObject(box));
+    boxes.push_back(box);
+  }
+  return boxes;
+}
+
+/**
+  *   @brief Check that all boxes are sleeping
+  *   @param boxes checked boxes
+  *   @return true if every box is sleeping
+  */
+bool allSleeping(const std::vector<pe::DynamicObject*>& boxes) {
+  for (auto box : boxes) {
+    if (!box->isSleeping()) return false;
+  }
+  return true;
+}
+
+/**
+  *   @brief Solve contacts of an overlapping pile of boxes once
+  *   @details Boxes start with different velocities, so every contact has work
+  *   @param box_shape Shape of the boxes, 20 x 20
+  *   @param pool threads passed to ContactSolver::solve, may be nullptr
+  *   @param colours colours used by the solve are stored here
+  *   @return positions and velocities of the boxes after the solve
+  */
+std::vector<float> solvePile(pe::Shape& box_shape, pe::ThreadPool* pool, unsigned& colours) {
+  const unsigned width = 40;
+  pe::Shape ground_shape(width * 20.f, 20.f);
+  pe::StaticObject ground(&ground_shape);
+  ground.setPosition(pe::Vector2f(width * 9.75f, 10.f));
+  std::vector<pe::DynamicObject*> boxes;
+  for (unsigned i = 0; i < width * width; i++) {
+    pe::DynamicObject* box = new pe::DynamicObject(&box_shape, 1.f);
+    box->setPosition(pe::Vector2f((i % width) * 19.5f, -10.f - (i / width) * 19.5f));
+    box->getPhysics().collision_velocity = pe::Vector2f((i * 7) % 11 - 5.f, (i * 3) % 13 - 6.f);
+    boxes.push_back(box);
+  }
+  pe::ContactSolver solver;
+  pe::CollisionDetection::MTV mtv;
+  for (unsigned i = 0; i < boxes.size(); i++) {
+    if ((i < width) && pe::CollisionDetection::detectCollision(boxes[i], &ground, mtv)) solver.add(boxes[i], &ground, mtv, nullptr);
+    for (unsigned j = i + 1; (j < boxes.size()) && (j <= i + width + 1); j++) {
+      if (pe::CollisionDetection::detectCollision(boxes[i], boxes[j], mtv)) solver.add(boxes[i], boxes[j], mtv, nullptr);
+    }
+  }
+  assert(solver.size() >= pe::ContactSolver::getColouringLimit());
+  solver.solve(pool);
+  colours = solver.getColours();
+  std::vector<float> state;
+  for (auto box : boxes) {
+    state.push_back(box->getPosition().getX());
+    state.push_back(box->getPosition().getY());
+    state.push_back(box->getPhysics().velocity.getX());
+    state.push_back(box->getPhysics().velocity.getY());
+    delete box;
+  }
+  return state;
+}
+
+/**
+  *   @brief Main test function
+  */
+int main() {
+  pe::Shape box_shape(20.f, 20.f);
+  pe::Shape ground_shape(1000.f, 20.f);
+
+  std::cout << "Box manifold test" << std::endl;
+  {
+    pe::DynamicObject upper(&box_shape, 1.f);
+    pe::DynamicObject lower(&box_shape, 1.f);
+    upper.setPosition(pe::Vector2f(0.f, 0.f));
+    lower.setPosition(pe::Vector2f(6.f, 18.f));
+    pe::CollisionDetection::MTV mtv;
+    assert(pe::CollisionDetection::detectCollision(&upper, &lower, mtv));
+    pe::CollisionDetection::Manifold manifold;
+    assert(pe::CollisionDetection::findManifold(&upper, &lower, mtv, manifold) == 2);
+    // normal points from the 1st object towards the 2nd
+    assert(manifold.normal == pe::Vector2f(0.f, 1.f));
+    for (unsigned i = 0; i < 2; i++) {
+      assert(std::abs(manifold.points[i].depth - 2.f) < 1e-4f);
+      assert(manifold.points[i].point.getX() >= -4.f - 1e-4f && manifold.points[i].point.getX() <= 10.f + 1e-4f);
+    }
+    assert(std::abs(manifold.points[0].point.getX() - manifold.points[1].point.getX()) > 13.f);
+    assert(manifold.points[0].feature != manifold.points[1].feature);
+    // swapped order flips the normal
+    assert(pe::CollisionDetection::findManifold(&lower, &upper, mtv, manifold) == 2);
+    assert(manifold.normal == pe::Vector2f(0.f, -1.f));
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Corner manifold test" << std::endl;
+  {
+    pe::DynamicObject corner(&box_shape, 1.f);
+    corner.setPosition(pe::Vector2f(0.f, 0.f));
+    corner.getPhysics().angle = 0.785398f;
+    corner.updateTransform();
+    pe::Vector2f lowest = corner.getWorldVertices()[0];
+    for (auto& vertex : corner.getWorldVertices()) {
+      if (vertex.getY() > lowest.getY()) lowest = vertex;
+    }
+    pe::StaticObject ground(&ground_shape);
+    // top of the ground inside the unrotated bounds, which objectsClose checks
+    ground.setPosition(pe::Vector2f(lowest.getX(), 19.f));
+    pe::CollisionDetection::MTV mtv;
+    assert(pe::CollisionDetection::detectCollision(&corner, &ground, mtv));
+    pe::CollisionDetection::Manifold manifold;
+    assert(pe::CollisionDetection::findManifold(&corner, &ground, mtv, manifold) == 1);
+    assert((manifold.points[0].point - lowest).getLength() < 1e-3f);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Collision mask test" << std::endl;
+  {
+    pe::DynamicObject pusher(&box_shape, 1.f);
+    pe::DynamicObject pushed(&box_shape, 1.f);
+    pusher.setPosition(pe::Vector2f(0.f, 0.f));
+    pushed.setPosition(pe::Vector2f(0.f, 15.f));
+    pusher.setCollisionMask(0x03);
+    pushed.setCollisionMask(0x01);
+    pushed.getPhysics().collision_velocity = pe::Vector2f(0.f, -50.f);
+    pe::CollisionDetection::MTV mtv;
+    assert(pe::CollisionDetection::detectCollision(&pusher, &pushed, mtv));
+    pe::ContactSolver solver;
+    solver.add(&pusher, &pushed, mtv, nullptr);
+    assert(solver.size() == 1);
+    solver.solve();
+    assert(solver.size() == 0 && solver.getIterations() > 0);
+    // only the object with the smaller mask moves
+    assert(pusher.getPosition() == pe::Vector2f(0.f, 0.f));
+    assert(pusher.getPhysics().velocity == pe::Vector2f(0.f, 0.f));
+    assert(pushed.getPosition().getY() > 15.f);
+    assert(pushed.getPhysics().velocity.getY() >= 0.f);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Restitution test" << std::endl;
+  {
+    pe::StaticObject ground(&ground_shape);
+    ground.setPosition(pe::Vector2f(0.f, 100.f));
+    for (float speed : {5.f, 100.f}) {
+      pe::DynamicObject box(&box_shape, 1.f);
+      box.setPosition(pe::Vector2f(0.f, 81.f));
+      box.getPhysics().velocity = pe::Vector2f(0.f, speed);
+      box.getPhysics().collision_velocity = pe::Vector2f(0.f, speed);
+      pe::CollisionDetection::MTV mtv;
+      assert(pe::CollisionDetection::detectCollision(&box, &ground, mtv));
+      pe::ContactSolver solver;
+      solver.add(&box, &ground, mtv, nullptr);
+      solver.solve();
+      if (speed < 10.f) {
+        // slow contact comes to rest
+        assert(std::abs(box.getPhysics().velocity.getY()) < 1e-3f);
+      } else {
+        assert(std::abs(box.getPhysics().velocity.getY() + box.getElasticity() * speed) < 1e-2f);
+      }
+    }
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Friction test" << std::endl;
+  {
+    pe::StaticObject ground(&ground_shape);
+    ground.setPosition(pe::Vector2f(0.f, 100.f));
+    float friction = pe::ContactSolver::getFriction();
+    float speeds[2];
+    for (unsigned i = 0; i < 2; i++) {
+      pe::ContactSolver::setFriction(i == 0 ? 0.f : 1.f);
+      pe::DynamicObject box(&box_shape, 1.f);
+      box.setPosition(pe::Vector2f(0.f, 81.f));
+      box.getPhysics().velocity = pe::Vector2f(5.f, 5.f);
+      box.getPhysics().collision_velocity = pe::Vector2f(5.f, 5.f);
+      pe::CollisionDetection::MTV mtv;
+      assert(pe::CollisionDetection::detectCollision(&box, &ground, mtv));
+      pe::ContactSolver solver;
+      solver.add(&box, &ground, mtv, nullptr);
+      solver.solve();
+      speeds[i] = box.getPhysics().velocity.getX();
+    }
+    pe::ContactSolver::setFriction(friction);
+    assert(std::abs(speeds[0] - 5.f) < 1e-4f);
+    assert(speeds[1] < 0.01f && speeds[1] > -0.01f); // friction limit 5 stops the box
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Resting test" << std::endl;
+  pe::PhysicsProperties::GravityY = 100.f;
+  {
+    pe::PhysicsWorld world;
+    addGround(world, ground_shape);
+    std::vector<pe::DynamicObject*> boxes = buildStack(world, box_shape, 0.f, 1);
+    for (int i = 0; i < 100; i++) {
+      world.update();
+      // resting box doesn't sink through the ground
+      assert(boxes[0]->getPosition().getY() < 80.05f && boxes[0]->getPosition().getY() > 79.95f);
+    }
+    assert(boxes[0]->isSleeping());
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Stacking test" << std::endl;
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::SweepAndPrune}) {
+    for (unsigned warm = 0; warm < 2; warm++) {
+      pe::ContactSolver::setWarmStarting(warm == 1);
+      pe::PhysicsWorld world(type, 100);
+      addGround(world, ground_shape);
+      std::vector<pe::DynamicObject*> boxes = buildStack(world, box_shape, 0.f, 8);
+      // knock the stack once so that the solver has work to do
+      boxes.back()->setVelocity(pe::Vector2f(0.f, 5.f));
+      for (int i = 0; i < 400; i++) world.update();
+      for (unsigned i = 0; i < boxes.size(); i++) {
+        // boxes stay on top of each other without crossing frames
+        assert(std::abs(boxes[i]->getPosition().getX()) < 1e-3f);
+        assert(std::abs(boxes[i]->getPosition().getY() - (80.f - 20.f * i)) < 0.5f);
+        assert(boxes[i]->isSleeping());
+      }
+    }
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Warm starting test" << std::endl;
+  for (float rate : {60.f, 30.f}) {
+    pe::PhysicsWorld::setIterationAmount(rate);
+    unsigned iterations[2] = {0, 0};
+    unsigned steps[2] = {0, 0};
+    for (unsigned warm = 0; warm < 2; warm++) {
+      pe::ContactSolver::setWarmStarting(warm == 1);
+      pe::PhysicsWorld world(pe::BroadphaseType::Grid, 100);
+      addGround(world, ground_shape);
+      // columns dropped on the ground, each box falls on the one below it
+      std::vector<pe::DynamicObject*> boxes;
+      for (unsigned column = 0; column < 5; column++) {
+        std::vector<pe::DynamicObject*> stack = buildStack(world, box_shape, column * 40.f, 10, 1.f);
+        boxes.insert(boxes.end(), stack.begin(), stack.end());
+      }
+      while (!allSleeping(boxes) && (steps[warm] < 2000)) {
+        world.update();
+        iterations[warm] += world.getSolverIterations();
+        steps[warm]++;
+      }
+      if (warm == 0) continue;
+      // cached impulses settle the columns, also at the lower step rate
+      assert(allSleeping(boxes));
+      for (unsigned i = 0; i < boxes.size(); i++) {
+        assert(std::abs(boxes[i]->getPosition().getY() - (80.f - 20.f * (i % 10))) < 0.5f);
+      }
+    }
+    assert(iterations[1] < iterations[0]);
+    // columns fall asleep together, at the default rate both settle within a few steps of each other
+    if (rate < 60.f) assert(steps[1] < steps[0]);
+  }
+  pe::PhysicsWorld::setIterationAmount(60.f);
+  pe::ContactSolver::setWarmStarting(true);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Colouring test" << std::endl;
+  {
+    unsigned colours[3];
+    std::vector<float> serial = solvePile(box_shape, nullptr, colours[0]);
+    pe::ThreadPool pool(3);
+    std::vector<float> threaded = solvePile(box_shape, &pool, colours[1]);
+    pe::ThreadPool single(0);
+    std::vector<float> calling = solvePile(box_shape, &single, colours[2]);
+    // colours share no DynamicObjects, so the amount of threads doesn't change results
+    assert(serial == threaded && serial == calling);
+    assert(colours[0] > 1 && colours[0] < 16);
+    assert(colours[0] == colours[1] && colours[0] == colours[2]);
+    for (float value : serial) assert(std::isfinite(value));
+    // small sets keep the added order
+    unsigned limit = pe::ContactSolver::getColouringLimit();
+    pe::ContactSolver::setColouringLimit(0);
+    std::vector<float> ordered = solvePile(box_shape, &pool, colours[0]);
+    assert(colours[0] == 0 && ordered.size() == serial.size());
+    pe::ContactSolver::setColouringLimit(limit);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Coloured world test" << std::endl;
+  {
+    unsigned threads = pe::PhysicsWorld::getThreads() - 1;
+    std::vector<float> results[2];
+    for (unsigned run = 0; run < 2; run++) {
+      pe::PhysicsWorld::setThreads(run == 0 ? 0 : 3);
+      pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, 100);
+      pe::Shape pile_ground(1000.f, 20.f);
+      addGround(world, pile_ground);
+      // overlapping pile is one island which is large enough to be coloured
+      std::vector<pe::DynamicObject*> boxes;
+      for (unsigned i = 0; i < 1000; i++) {
+        pe::DynamicObject* box = world.createDynamicObject(&box_shape, 1.f);
+        box->setPosition(pe::Vector2f((i % 40) * 19.5f - 380.f, 80.5f - (i / 40) * 19.5f));
+        assert(world.addObject(box));
+        boxes.push_back(box);
+      }
+      boxes.back()->setVelocity(pe::Vector2f(0.f, 5.f));
+      for (int step = 0; step < 20; step++) {
+        world.update();
+        assert(world.getIslandAmount() == 1);
+      }
+      assert(world.getContacts().size() >= pe::ContactSolver::getColouringLimit());
+      for (auto box : boxes) {
+        results[run].push_back(box->getPosition().getX());
+        results[run].push_back(box->getPosition().getY());
+      }
+    }
+    assert(results[0] == results[1]);
+    pe::PhysicsWorld::setThreads(threads);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All ContactSolver tests passed" << std::endl;
+  return 0;
+}
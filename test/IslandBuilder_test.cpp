@@ -0,0 +1,167 @@
+/**
+  *   @file IslandBuilder_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for IslandBuilder and PhysicsWorld islands
+  */
+
+
+#include "../include/IslandBuilder.hpp"
+#include "../include/PhysicsWorld.hpp"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+  *   @brief Check whether island contains object
+  *   @param islands built IslandBuilder
+  *   @param island island index
+  *   @param object searched object
+  *   @return true if object is in island
+  */
+bool inIsland(const pe::IslandBuilder& islands, unsigned island, pe::PhysicsObject* object) {
+  unsigned amount;
+  pe::PhysicsObject* const* objects = islands.getObjects(island, amount);
+  for (unsigned i = 0; i < amount; i++) {
+    if (objects[i] == object) return true;
+  }
+  return false;
+}
+
+/**
+  *   @brief Main test function
+  */
+int main() {
+  pe::Shape shape(20.f, 20.f);
+  pe::Shape ground_shape(1000.f, 20.f);
+
+  std::cout << "Partition test" << std::endl;
+  {
+    pe::IslandBuilder islands;
+    pe::StaticObject ground(&ground_shape);
+    std::vector<pe::DynamicObject*> boxes;
+    for (int i = 0; i < 7; i++) boxes.push_back(new pe::DynamicObject(&shape, 1.f));
+    // chain 0 - 1 - 2, pair 3 - 4 and 5 alone, all touching the ground
+    islands.addContact(boxes[0], &ground);
+    islands.addContact(boxes[3], boxes[4]);
+    islands.addContact(boxes[1], boxes[0]);
+    islands.addContact(&ground, boxes[5]);
+    islands.addContact(boxes[2], boxes[1]);
+    islands.addContact(boxes[4], &ground);
+    islands.addContact(boxes[2], &ground);
+    islands.build();
+    assert(islands.getContactAmount() == 7);
+    // ground doesn't connect islands
+    assert(islands.size() == 3);
+    unsigned amount;
+    const unsigned* contacts = islands.getContacts(0, amount);
+    assert(amount == 4);
+    // added order is kept inside an island
+    assert(contacts[0] == 0 && contacts[1] == 2 && contacts[2] == 4 && contacts[3] == 6);
+    assert(islands.getObjects(0, amount) != nullptr && amount == 3);
+    assert(inIsland(islands, 0, boxes[0]) && inIsland(islands, 0, boxes[1]) && inIsland(islands, 0, boxes[2]));
+    assert(!inIsland(islands, 0, &ground));
+    contacts = islands.getContacts(1, amount);
+    assert(amount == 2 && contacts[0] == 1 && contacts[1] == 5);
+    islands.getObjects(1, amount);
+    assert(amount == 2 && inIsland(islands, 1, boxes[3]) && inIsland(islands, 1, boxes[4]));
+    contacts = islands.getContacts(2, amount);
+    assert(amount == 1 && contacts[0] == 3);
+    islands.getObjects(2, amount);
+    assert(amount == 1 && inIsland(islands, 2, boxes[5]));
+    // joining contact merges islands
+    islands.addContact(boxes[4], boxes[2]);
+    islands.addContact(boxes[6], boxes[6]);
+    islands.build();
+    assert(islands.size() == 3);
+    islands.getObjects(0, amount);
+    assert(amount == 5 && inIsland(islands, 0, boxes[4]));
+    islands.getContacts(2, amount);
+    assert(amount == 1 && inIsland(islands, 2, boxes[6]));
+    islands.clear();
+    islands.build();
+    assert(islands.size() == 0 && islands.getContactAmount() == 0);
+    for (auto box : boxes) delete box;
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Island sleep test" << std::endl;
+  pe::PhysicsProperties::GravityY = 100.f;
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::AABBTree}) {
+    pe::PhysicsWorld world(type, 100);
+    pe::StaticObject* ground = world.createStaticObject(&ground_shape);
+    ground->setPosition(pe::Vector2f(0.f, 100.f));
+    assert(world.addObject(ground));
+    // two separate stacks of three boxes
+    std::vector<pe::DynamicObject*> stacks[2];
+    for (unsigned stack = 0; stack < 2; stack++) {
+      for (unsigned i = 0; i < 3; i++) {
+        pe::DynamicObject* box = world.createDynamicObject(&shape, 1.f);
+        box->setPosition(pe::Vector2f(stack * 200.f, 80.f - 20.f * i));
+        assert(world.addObject(box));
+        stacks[stack].push_back(box);
+      }
+    }
+    stacks[1].back()->setVelocity(pe::Vector2f(0.f, 5.f));
+    world.update();
+    assert(world.getIslandAmount() == 2);
+    for (int step = 0; step < 400; step++) {
+      world.update();
+      // touching awake objects have rested equally long, so they fall asleep together
+      for (auto& contact : world.getContacts()) {
+        if ((contact.first->getObjectType() == pe::ObjectType::DynamicObject) && !contact.first->isSleeping() &&
+            (contact.second->getObjectType() == pe::ObjectType::DynamicObject) && !contact.second->isSleeping()) {
+          assert(contact.first->getRestSteps() == contact.second->getRestSteps());
+        }
+      }
+    }
+    for (unsigned stack = 0; stack < 2; stack++) {
+      for (auto box : stacks[stack]) assert(box->isSleeping());
+    }
+    assert(world.getIslandAmount() == 0);
+    for (unsigned stack = 0; stack < 2; stack++) {
+      for (unsigned i = 0; i < stacks[stack].size(); i++) {
+        assert(std::abs(stacks[stack][i]->getPosition().getY() - (80.f - 20.f * i)) < 0.5f);
+      }
+    }
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Threaded island test" << std::endl;
+  {
+    unsigned threads = pe::PhysicsWorld::getThreads() - 1;
+    pe::PhysicsWorld::setThreads(std::thread::hardware_concurrency());
+    pe::PhysicsWorld world(pe::BroadphaseType::HashGrid, 100);
+    pe::StaticObject* ground = world.createStaticObject(world.createShape(4200.f, 20.f));
+    ground->setPosition(pe::Vector2f(1980.f, 100.f));
+    assert(world.addObject(ground));
+    std::vector<pe::DynamicObject*> boxes;
+    for (unsigned stack = 0; stack < 100; stack++) {
+      for (unsigned i = 0; i < 4; i++) {
+        pe::DynamicObject* box = world.createDynamicObject(&shape, 1.f);
+        box->setPosition(pe::Vector2f(stack * 40.f, 79.f - 21.f * i));
+        assert(world.addObject(box));
+        boxes.push_back(box);
+      }
+    }
+    unsigned most_islands = 0;
+    unsigned steps = 0;
+    while ((world.getSleepingAmount() < boxes.size()) && (steps < 2000)) {
+      world.update();
+      most_islands = std::max(most_islands, world.getIslandAmount());
+      steps++;
+    }
+    // stacks don't touch each other
+    assert(most_islands >= 100);
+    assert(world.getSleepingAmount() == boxes.size());
+    for (unsigned i = 0; i < boxes.size(); i++) {
+      assert(std::abs(boxes[i]->getPosition().getX() - (i / 4) * 40.f) < 0.5f);
+      assert(std::abs(boxes[i]->getPosition().getY() - (80.f - 20.f * (i % 4))) < 0.5f);
+    }
+    pe::PhysicsWorld::setThreads(threads);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All IslandBuilder tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,174 @@
+/**
+  *   @file ObjectPool_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for ObjectPool and PhysicsWorld factory methods
+  */
+
+
+#include "../include/ObjectPool.hpp"
+#include "../include/PhysicsWorld.hpp"
+#include <iostream>
+#include <cassert>
+#include <set>
+#include <vector>
+
+/**
+  *   @struct Counted
+  *   @brief Counts alive instances
+  */
+struct Counted {
+  static int Alive; /**< Alive instances */
+  int value; /**< Constructor argument */
+
+  /**
+    *   @brief Constructor
+    *   @param value stored value
+    */
+  Counted(int value): value(value) {
+    Alive++;
+  }
+
+  /**
+    *   @brief Deconstructor
+    */
+  ~Counted() {
+    Alive--;
+  }
+};
+
+int Counted::Alive = 0;
+
+/**
+  *   @brief Main test function
+  */
+int main() {
+  std::cout << "Slot reuse test" << std::endl;
+  {
+    pe::ObjectPool<Counted> pool;
+    assert(pool.size() == 0 && pool.capacity() == 0);
+    Counted* first = pool.create(1);
+    Counted* second = pool.create(2);
+    assert(first->value == 1 && second->value == 2);
+    assert(second > first); // handed out in address order
+    assert(pool.size() == 2 && Counted::Alive == 2);
+    pool.destroy(first);
+    assert(pool.size() == 1 && Counted::Alive == 1);
+    Counted* third = pool.create(3);
+    assert(third == first); // freed slot is reused first
+    assert(third->value == 3);
+    assert(pool.capacity() == pe::ObjectPool<Counted>::SlabSize);
+    // only alive objects of the pool are owned
+    Counted outside(4);
+    pool.destroy(second);
+    assert(pool.owns(third) && !pool.owns(second) && !pool.owns(&outside));
+  }
+  assert(Counted::Alive == 0); // alive objects are destroyed with the pool
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Stable handle test" << std::endl;
+  {
+    pe::ObjectPool<Counted> pool;
+    std::vector<Counted*> objects;
+    unsigned amount = 3 * pe::ObjectPool<Counted>::SlabSize + 5;
+    for (unsigned i = 0; i < amount; i++) objects.push_back(pool.create(static_cast<int>(i)));
+    // pointers stay valid when new slabs are allocated
+    for (unsigned i = 0; i < amount; i++) assert(objects[i]->value == static_cast<int>(i));
+    assert(std::set<Counted*>(objects.begin(), objects.end()).size() == amount);
+    unsigned capacity = pool.capacity();
+    assert(capacity >= amount);
+    // churn doesn't allocate more slabs
+    for (unsigned round = 0; round < 10; round++) {
+      for (unsigned i = 0; i < amount; i += 2) pool.destroy(objects[i]);
+      for (unsigned i = 0; i < amount; i += 2) objects[i] = pool.create(static_cast<int>(i));
+    }
+    assert(pool.capacity() == capacity);
+    assert(pool.size() == amount);
+    for (unsigned i = 0; i < amount; i++) assert(objects[i]->value == static_cast<int>(i));
+    for (auto object : objects) pool.destroy(object);
+    assert(pool.size() == 0 && Counted::Alive == 0);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Factory test" << std::endl;
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+    pe::PhysicsWorld world(type, 100);
+    pe::Shape* shape = world.createShape(10.f, 10.f);
+    assert(shape->getType() == pe::ShapeType::Box);
+    pe::StaticObject* ground = world.createStaticObject(shape);
+    ground->setPosition(pe::Vector2f(0.f, 30.f));
+    assert(ground->getPool() != nullptr);
+    assert(world.addObject(ground));
+    std::vector<pe::PhysicsObject*> spawned;
+    for (int i = 0; i < 100; i++) {
+      pe::DynamicObject* object = world.createDynamicObject(shape, 1.f);
+      object->setPosition(pe::Vector2f(i * 20.f, 0.f));
+      assert(world.addObject(object));
+      spawned.push_back(object);
+    }
+    assert(world.getPooledAmount() == 101);
+    world.update();
+    // removed objects return to the pool and their slots are reused
+    pe::PhysicsObject* removed = spawned.back();
+    assert(world.removeObject(removed));
+    assert(world.getPooledAmount() == 100);
+    pe::DynamicObject* respawned = world.createDynamicObject(shape, 1.f);
+    assert(respawned == removed);
+    respawned->setPosition(pe::Vector2f(-100.f, 0.f));
+    assert(world.addObject(respawned));
+    world.update();
+    // copies are heap allocated, freeing them leaves the pools untouched
+    {
+      pe::PhysicsWorld copy(world);
+      assert(copy.getPooledAmount() == 0);
+      copy.update();
+    }
+    assert(world.getPooledAmount() == 101);
+    // objects which were never added are freed with destroyObject
+    pe::DynamicObject* unused = world.createDynamicObject(shape, 1.f);
+    world.destroyObject(unused);
+    assert(world.getPooledAmount() == 101);
+    // heap allocated objects are still supported
+    pe::DynamicObject* heap = new pe::DynamicObject(shape, 1.f);
+    assert(heap->getPool() == nullptr);
+    assert(world.addObject(heap));
+    assert(world.removeObject(heap));
+    pe::Shape* copied = world.createShape(*shape);
+    assert(copied != shape && copied->getEdges() == shape->getEdges());
+    world.destroyShape(copied);
+    assert(world.removeObject(ground));
+    assert(world.getPooledAmount() == 100);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Copied world test" << std::endl;
+  for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+    pe::PhysicsWorld* world = new pe::PhysicsWorld(type, 100);
+    pe::Shape* shape = world->createShape(10.f, 10.f);
+    pe::StaticObject* ground = world->createStaticObject(world->createShape(400.f, 10.f));
+    ground->setPosition(pe::Vector2f(0.f, 30.f));
+    assert(world->addObject(ground));
+    for (int i = 0; i < 10; i++) {
+      pe::DynamicObject* object = world->createDynamicObject(shape, 1.f);
+      object->setPosition(pe::Vector2f(i * 20.f - 100.f, 0.f));
+      assert(world->addObject(object));
+    }
+    world->update();
+    // copies own their Shapes, the source world can be destroyed first
+    pe::PhysicsWorld copy(*world);
+    pe::PhysicsWorld assigned(type, 100);
+    assigned = *world;
+    delete world;
+    for (int i = 0; i < 10; i++) {
+      copy.update();
+      assigned.update();
+    }
+    std::vector<pe::PhysicsObject*> objects;
+    copy.queryRegion(pe::Vector2f(-1000.f, -1000.f), pe::Vector2f(1000.f, 1000.f), objects);
+    assert(objects.size() == 11);
+    for (auto object : objects) assert(object->getShape()->getEdges() == 4);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All ObjectPool tests passed" << std::endl;
+  return 0;
+}
@@ -9,6 +9,9 @@
 #include "../include/DynamicObject.hpp"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 
 /**
@@ -29,17 +32,99 @@ int main() {
   pe::PhysicsGrid grid;
   grid.addCells(1000, 1000, 10);
   pe::PhysicsGrid grid2 = grid;
-  int x, y;
-  y = 0;
-  for (auto it = grid2.cbegin(); it != grid2.cend(); it++) {
-    y++;
-    x = 0;
-    for (auto it2 = it->cbegin(); it2 != it->cend(); it2++) {
-      x++;
+  assert(grid2.getColumns() == 100); // 100 == grid width / grid cell size
+  assert(grid2.getRows() == 100); // 100 = grid height / grid cell size
+  for (unsigned y = 0; y < grid2.getRows(); y++) {
+    for (unsigned x = 0; x < grid2.getColumns(); x++) {
+      assert(grid2.getCell(x, y)->x == static_cast<int32_t>(x) && grid2.getCell(x, y)->y == static_cast<int32_t>(y));
     }
-    assert(x == 100); // 100 == grid width / grid cell size
   }
-  assert(y == 100); // 100 = grid height / grid cell size
+
+  std::cout << "Region query test" << std::endl;
+  pe::PhysicsGrid query_grid;
+  query_grid.addCells(1000, 1000, 100);
+  pe::Shape shape(30.f, 30.f);
+  for (int i = 0; i < 200; i++) {
+    pe::DynamicObject* object = new pe::DynamicObject(&shape, 1.f);
+    // some objects straddle Cells and some are outside the grid
+    object->setPosition(pe::Vector2f(i % 20 * 37.f - 400.f, i / 20 * 61.f - 200.f + (i % 3) * 500.f));
+    assert(query_grid.addObject(object));
+  }
+  pe::Vector2f regions[][2] = {{pe::Vector2f(-110.f, -110.f), pe::Vector2f(110.f, 110.f)},
+                               {pe::Vector2f(-1000.f, -1000.f), pe::Vector2f(1000.f, 1000.f)},
+                               {pe::Vector2f(350.f, 300.f), pe::Vector2f(351.f, 900.f)},
+                               {pe::Vector2f(10.f, 10.f), pe::Vector2f(-10.f, -10.f)}};
+  for (auto& region : regions) {
+    // Cell based query finds the same objects as checking every object
+    std::vector<pe::PhysicsObject*> found, expected;
+    query_grid.queryRegion(region[0], region[1], found);
+    query_grid.Broadphase::queryRegion(region[0], region[1], expected);
+    std::sort(found.begin(), found.end());
+    std::sort(expected.begin(), expected.end());
+    assert(found == expected);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << "Cell id test" << std::endl;
+  // grid covers [-500, 500) with 10 x 10 Cells
+  float far = std::numeric_limits<float>::max();
+  pe::Vector2f positions[] = {pe::Vector2f(-500.f, -500.f), pe::Vector2f(-400.f, -500.f), pe::Vector2f(-401.f, -399.f),
+                              pe::Vector2f(499.f, 499.f), pe::Vector2f(500.f, 500.f), pe::Vector2f(-far, far),
+                              pe::Vector2f(std::numeric_limits<float>::quiet_NaN(), 0.f), pe::Vector2f(-1.f, 0.f)};
+  uint32_t expected_ids[] = {0, 1, 10, 99, 99, 90, 50, 54};
+  uint32_t ids[8];
+  query_grid.getCellIds(positions, 8, ids);
+  for (unsigned i = 0; i < 8; i++) assert(ids[i] == expected_ids[i]);
+  // batch variant handles more positions than one internal batch
+  std::vector<pe::Vector2f> many;
+  for (int i = 0; i < 1000; i++) many.push_back(pe::Vector2f(i * 1.7f - 850.f, 500.f - i));
+  std::vector<uint32_t> many_ids(many.size());
+  query_grid.getCellIds(many.data(), many.size(), many_ids.data());
+  for (unsigned i = 0; i < many.size(); i++) {
+    uint32_t id;
+    query_grid.getCellIds(&many[i], 1, &id);
+    assert(id == many_ids[i] && id < 100);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << "Morton order test" << std::endl;
+  {
+    pe::PhysicsGrid row_grid, morton_grid;
+    row_grid.addCells(1600, 1200, 100);
+    morton_grid.addCells(1600, 1200, 100, pe::CellOrder::Morton);
+    assert(morton_grid.getCellOrder() == pe::CellOrder::Morton);
+    assert(morton_grid.getColumns() == 16 && morton_grid.getRows() == 12);
+    std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+    morton_grid.collectCells(cells, false);
+    assert(cells.size() == 192);
+    // cells are collected in memory order and the first 2 x 2 block is adjacent
+    for (unsigned i = 1; i < cells.size(); i++) assert(cells[i] > cells[i - 1]);
+    assert(cells[1] == cells[0] + 1 && cells[1]->x == 1 && cells[1]->y == 0);
+    assert(cells[2]->x == 0 && cells[2]->y == 1);
+    assert(cells[3]->x == 1 && cells[3]->y == 1);
+    // Morton order doesn't change where objects are stored
+    std::vector<pe::PhysicsObject*> objects;
+    for (int i = 0; i < 100; i++) {
+      for (auto grid : {&row_grid, &morton_grid}) {
+        pe::DynamicObject* object = new pe::DynamicObject(&shape, 1.f);
+        object->setPosition(pe::Vector2f(i % 10 * 157.f - 780.f, i / 10 * 119.f - 590.f));
+        assert(grid->addObject(object));
+      }
+    }
+    for (unsigned y = 0; y < 12; y++) {
+      for (unsigned x = 0; x < 16; x++) {
+        assert(row_grid.getCell(x, y)->entities.size() == morton_grid.getCell(x, y)->entities.size());
+      }
+    }
+    pe::PhysicsGrid copy(morton_grid);
+    assert(copy.getCellOrder() == pe::CellOrder::Morton);
+    assert(copy.getCell(3, 4)->entities.size() == morton_grid.getCell(3, 4)->entities.size());
+    // narrow grids would need too much padding and stay row-major
+    pe::PhysicsGrid narrow;
+    narrow.addCells(1000, 200, 100, pe::CellOrder::Morton);
+    assert(narrow.getCellOrder() == pe::CellOrder::RowMajor);
+  }
+  std::cout << "test successful" << std::endl;
 
   std::cout << "All test passed" << std::endl;
   return 0;
@@ -10,8 +10,152 @@
 #include "../include/DynamicObject.hpp"
 #include <iostream>
 #include <cassert>
+#include <cmath>
 
 
+/**
+  *   @brief Check that a resting box is reported in contacts
+  *   @param world PhysicsWorld to be tested
+  *   @param ground_shape Shape for the StaticObject ground
+  *   @param box_shape Shape for the DynamicObject box
+  */
+void contactsTest(pe::PhysicsWorld& world, pe::Shape& ground_shape, pe::Shape& box_shape) {
+   pe::StaticObject* ground = new pe::StaticObject(&ground_shape);
+   ground->setPosition(pe::Vector2f(0.f, 100.f));
+   assert(world.addObject(ground));
+   pe::DynamicObject* box = new pe::DynamicObject(&box_shape, 1.f);
+   box->setPosition(pe::Vector2f(0.f, 88.f));
+   assert(world.addObject(box));
+   world.update();
+   std::vector<pe::Collided>& contacts = world.getContacts();
+   assert(contacts.size() == 1);
+   assert((contacts[0][0] == box && contacts[0][1] == ground) || (contacts[0][0] == ground && contacts[0][1] == box));
+   std::list<pe::Collided>& collided = world.getCollided();
+   assert(collided.size() == 1 && collided.front().first == contacts[0].first);
+   // contacts are rebuilt by each update, box is far away after this
+   box->setPosition(pe::Vector2f(0.f, -1000.f));
+   world.update();
+   assert(world.getContacts().empty() && world.getCollided().empty());
+}
+
+/**
+  *   @brief Check collisions of an object overlapping multiple Cells
+  *   @details Each contact must be reported once although the ground is in many Cells
+  *   @param world PhysicsWorld to be tested
+  *   @param ground_shape Shape for the StaticObject ground
+  *   @param box_shape Shape for the DynamicObject boxes
+  */
+void straddleTest(pe::PhysicsWorld& world, pe::Shape& ground_shape, pe::Shape& box_shape) {
+   pe::StaticObject* ground = new pe::StaticObject(&ground_shape);
+   ground->setPosition(pe::Vector2f(0.f, 300.f)); // crosses Cell border at x = 0
+   assert(world.addObject(ground));
+   pe::DynamicObject* left = new pe::DynamicObject(&box_shape, 1.f);
+   left->setPosition(pe::Vector2f(-200.f, 288.f));
+   assert(world.addObject(left));
+   pe::DynamicObject* right = new pe::DynamicObject(&box_shape, 1.f);
+   right->setPosition(pe::Vector2f(200.f, 288.f));
+   assert(world.addObject(right));
+   world.update();
+   std::vector<pe::Collided>& contacts = world.getContacts();
+   assert(contacts.size() == 2);
+   assert((contacts[0][0] == ground) || (contacts[0][1] == ground));
+   assert((contacts[1][0] == ground) || (contacts[1][1] == ground));
+   assert(world.removeObject(left));
+   assert(world.removeObject(right));
+   assert(world.removeObject(ground));
+}
+
+/**
+  *   @brief Check that an object moved with setPosition is moved to its new Cells
+  *   @details Broadphase moves only objects which the update reports as moved
+  *   @param world PhysicsWorld to be tested
+  *   @param box_shape Shape for the DynamicObject boxes
+  */
+void movedTest(pe::PhysicsWorld& world, pe::Shape& box_shape) {
+   pe::DynamicObject* first = new pe::DynamicObject(&box_shape, 1.f);
+   first->setPosition(pe::Vector2f(-20000.f, -20000.f));
+   assert(world.addObject(first));
+   pe::DynamicObject* second = new pe::DynamicObject(&box_shape, 1.f);
+   second->setPosition(pe::Vector2f(20000.f, 20000.f));
+   assert(world.addObject(second));
+   world.update();
+   assert(world.getContacts().empty());
+   // far away Cell, found only if first is rebinned
+   first->setPosition(second->getPosition() + pe::Vector2f(0.f, 5.f));
+   world.update();
+   assert(world.getContacts().size() == 1);
+   assert(world.removeObject(first));
+   assert(world.removeObject(second));
+}
+
+/**
+  *   @brief Check that addObjects gives the same simulation as addObject
+  *   @param type Broadphase of the compared worlds
+  *   @param ground_shape Shape for the StaticObject grounds
+  *   @param box_shape Shape for the DynamicObject boxes
+  */
+void bulkTest(enum pe::BroadphaseType::BroadphaseType type, pe::Shape& ground_shape, pe::Shape& box_shape) {
+   pe::PhysicsWorld single(type, 100);
+   pe::PhysicsWorld bulk(type, 100);
+   std::vector<pe::PhysicsObject*> single_objects, bulk_objects;
+   for (auto objects : {&single_objects, &bulk_objects}) {
+     for (int i = 0; i < 300; i++) {
+       // boxes fall to grounds, many of them overlap Cell borders
+       pe::PhysicsObject* object;
+       if (i % 10 == 0) object = new pe::StaticObject(&ground_shape);
+       else object = new pe::DynamicObject(&box_shape, 1.f);
+       object->setPosition(pe::Vector2f(i % 30 * 45.f - 600.f, i / 30 * 70.f + (i % 10 == 0 ? 20.f : 0.f)));
+       objects->push_back(object);
+     }
+   }
+   for (auto object : single_objects) assert(single.addObject(object));
+   assert(bulk.addObjects(bulk_objects.data(), bulk_objects.size()) == bulk_objects.size());
+   for (int step = 0; step < 30; step++) {
+     single.update();
+     bulk.update();
+     assert(single.getContacts().size() == bulk.getContacts().size());
+   }
+   for (unsigned i = 0; i < single_objects.size(); i++) {
+     assert(single_objects[i]->getPosition() == bulk_objects[i]->getPosition());
+   }
+   // bulk added objects can be removed like others
+   for (auto object : bulk_objects) assert(bulk.removeObject(object));
+}
+
+/**
+  *   @brief Test that bullets don't pass through a thin wall
+  *   @param type BroadphaseType of the tested PhysicsWorld
+  *   @param box_shape Shape for the DynamicObject boxes
+  */
+void bulletTest(pe::BroadphaseType::BroadphaseType type, pe::Shape& box_shape) {
+   pe::PhysicsWorld world(type, 100);
+   pe::Shape wall_shape(2.f, 200.f);
+   pe::StaticObject* wall = new pe::StaticObject(&wall_shape);
+   wall->setPosition(pe::Vector2f(300.f, 0.f));
+   assert(world.addObject(wall));
+   // both boxes move 50 units per step, much more than their own width
+   pe::DynamicObject* bullet = new pe::DynamicObject(&box_shape, 1.f);
+   bullet->setPosition(pe::Vector2f(0.f, 0.f));
+   bullet->setVelocity(pe::Vector2f(3000.f, 0.f));
+   bullet->setBullet(true);
+   assert(bullet->isBullet() && world.addObject(bullet));
+   pe::DynamicObject* regular = new pe::DynamicObject(&box_shape, 1.f);
+   regular->setPosition(pe::Vector2f(0.f, 50.f));
+   regular->setVelocity(pe::Vector2f(3000.f, 0.f));
+   assert(!regular->isBullet() && world.addObject(regular));
+   bool hit = false;
+   for (int step = 0; step < 20; step++) {
+     world.update();
+     // bullet never crosses the wall
+     assert(bullet->getMaxPosition().getX() < wall->getMinPosition().getX() + 1.f);
+     for (auto& contact : world.getContacts()) {
+       if ((contact.first == bullet) || (contact.second == bullet)) hit = true;
+     }
+   }
+   assert(hit);
+   assert(regular->getMinPosition().getX() > wall->getMaxPosition().getX());
+}
+
 /**
   *   @brief Test main for PhysicsWorld
   */
@@ -43,10 +187,182 @@
 
    dyn2->setPosition(pe::Vector2f(1000.f, 10000.f));
    assert(world.removeObject(dyn1));
-   //assert(!world.removeObject(dyn2)); // world is not updated so position isn't updated so object cannot be removed at the moment
-   dyn2->setPosition(pe::Vector2f(0.f, 0.f)); // object is returned to its original position which matches to PhysicsWorld position
-   assert(world.removeObject(dyn2)); // now removal should succeed
+   // objects store their Broadphase location, so removal works although dyn2 moved after update
+   assert(world.removeObject(dyn2));
+
+   std::cout << "Constructor test passed" << std::endl;
+
+   std::cout << std::endl << "Contacts test" << std::endl;
+   pe::Shape ground_shape(1000.f, 20.f);
+   pe::Shape box_shape(10.f, 10.f);
+   contactsTest(world, ground_shape, box_shape);
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Multiple Cells test" << std::endl;
+   straddleTest(world, ground_shape, box_shape);
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "SpatialHashGrid test" << std::endl;
+   pe::PhysicsWorld hash_world(pe::BroadphaseType::HashGrid, 500);
+   assert(hash_world.getBroadphaseType() == pe::BroadphaseType::HashGrid);
+   contactsTest(hash_world, ground_shape, box_shape);
+   straddleTest(hash_world, ground_shape, box_shape);
+   // no world size limits
+   pe::DynamicObject* far = new pe::DynamicObject(&box_shape, 1.f);
+   far->setPosition(pe::Vector2f(1e6f, -1e6f));
+   assert(hash_world.addObject(far));
+   pe::PhysicsWorld hash_copy = hash_world;
+   assert(hash_copy.getBroadphaseType() == pe::BroadphaseType::HashGrid);
+   hash_world.update();
+   assert(hash_world.removeObject(far));
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "SweepAndPrune test" << std::endl;
+   pe::PhysicsWorld sap_world(pe::BroadphaseType::SweepAndPrune);
+   assert(sap_world.getBroadphaseType() == pe::BroadphaseType::SweepAndPrune);
+   contactsTest(sap_world, ground_shape, box_shape);
+   straddleTest(sap_world, ground_shape, box_shape);
+   pe::PhysicsWorld sap_copy = sap_world;
+   sap_copy.update();
+   assert(sap_copy.getContacts().empty());
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "AABBTree test" << std::endl;
+   pe::PhysicsWorld tree_world(pe::BroadphaseType::AABBTree);
+   contactsTest(tree_world, ground_shape, box_shape);
+   straddleTest(tree_world, ground_shape, box_shape);
+   pe::PhysicsWorld tree_copy = tree_world;
+   tree_copy.update();
+   assert(tree_copy.getContacts().empty());
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Query test" << std::endl;
+   pe::PhysicsWorld* query_worlds[] = {&world, &hash_world, &sap_world, &tree_world};
+   for (auto query_world : query_worlds) {
+     // each world has the 1000 x 20 ground at (0, 100) from contactsTest
+     std::vector<pe::PhysicsObject*> found;
+     query_world->queryRegion(pe::Vector2f(-10.f, 95.f), pe::Vector2f(10.f, 105.f), found);
+     assert(found.size() == 1 && found[0]->getObjectType() == pe::ObjectType::StaticObject);
+     found.clear();
+     query_world->queryRay(pe::Vector2f(0.f, 50.f), pe::Vector2f(0.f, 200.f), found);
+     assert(found.size() == 1);
+     found.clear();
+     query_world->queryRay(pe::Vector2f(0.f, 50.f), pe::Vector2f(0.f, 80.f), found);
+     assert(found.empty());
+   }
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Moved objects test" << std::endl;
+   for (auto moved_world : query_worlds) movedTest(*moved_world, box_shape);
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Static geometry test" << std::endl;
+   pe::PhysicsWorld static_world;
+   pe::StaticObject* tile = new pe::StaticObject(&box_shape);
+   tile->setPosition(pe::Vector2f(0.f, 0.f));
+   assert(static_world.addObject(tile));
+   pe::DynamicObject* falling = new pe::DynamicObject(&box_shape, 1.f);
+   falling->setPosition(pe::Vector2f(200.f, 0.f));
+   assert(static_world.addObject(falling));
+   static_world.update();
+   assert(static_world.getContacts().empty());
+   // static moved under the dynamic object, not seen before rebuild
+   tile->setPosition(pe::Vector2f(200.f, 5.f));
+   std::vector<pe::PhysicsObject*> tiles;
+   static_world.queryRegion(pe::Vector2f(195.f, 0.f), pe::Vector2f(205.f, 10.f), tiles);
+   assert(tiles.size() == 1 && tiles[0] == falling);
+   static_world.rebuildStatics();
+   static_world.update();
+   assert(static_world.getContacts().size() == 1);
+   assert(static_world.removeObject(tile));
+   static_world.update();
+   assert(static_world.getContacts().empty());
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Sleep test" << std::endl;
+   pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 10);
+   pe::PhysicsWorld sleep_world;
+   pe::StaticObject* floor = new pe::StaticObject(&ground_shape);
+   floor->setPosition(pe::Vector2f(0.f, 100.f));
+   assert(sleep_world.addObject(floor));
+   pe::DynamicObject* resting = new pe::DynamicObject(&box_shape, 1.f);
+   resting->setPosition(pe::Vector2f(0.f, 85.f));
+   assert(sleep_world.addObject(resting));
+   pe::DynamicObject* other = new pe::DynamicObject(&box_shape, 1.f);
+   other->setPosition(pe::Vector2f(200.f, 85.f));
+   assert(sleep_world.addObject(other));
+   for (int i = 0; i < 20; i++) sleep_world.update();
+   assert(resting->isSleeping() && other->isSleeping());
+   assert(sleep_world.getSleepingAmount() == 2 && sleep_world.getAwakeAmount() == 0);
+   assert(sleep_world.getContacts().empty()); // sleeping vs static is not checked
+   resting->setVelocity(pe::Vector2f(0.f, 0.f));
+   assert(!resting->isSleeping());
+   for (int i = 0; i < 20; i++) sleep_world.update();
+   assert(resting->isSleeping());
+   // moving object wakes the sleeping one
+   pe::DynamicObject* hitting = new pe::DynamicObject(&box_shape, 1.f);
+   hitting->setPosition(pe::Vector2f(8.f, 76.f));
+   hitting->setVelocity(pe::Vector2f(0.f, 100.f));
+   assert(sleep_world.addObject(hitting));
+   sleep_world.update();
+   assert(!resting->isSleeping() && other->isSleeping());
+   // removing the floor wakes the objects resting on it
+   assert(sleep_world.removeObject(floor));
+   assert(!other->isSleeping());
+   pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 60);
+   // removing the bottom of a sleeping stack lets the rest of it fall
+   pe::PhysicsWorld stack_world;
+   pe::StaticObject* stack_floor = new pe::StaticObject(&ground_shape);
+   stack_floor->setPosition(pe::Vector2f(0.f, 100.f));
+   assert(stack_world.addObject(stack_floor));
+   pe::DynamicObject* stack[3];
+   for (int i = 0; i < 3; i++) {
+     stack[i] = new pe::DynamicObject(&box_shape, 1.f);
+     stack[i]->setPosition(pe::Vector2f(0.f, 85.f - 10.f * i));
+     assert(stack_world.addObject(stack[i]));
+   }
+   for (int i = 0; i < 300; i++) stack_world.update();
+   assert(stack_world.getSleepingAmount() == 3);
+   assert(stack_world.removeObject(stack[0]));
+   for (int i = 0; i < 600; i++) stack_world.update();
+   // also the box which didn't touch the removed one falls, nothing puts them back to sleep mid-air
+   assert(stack_world.getSleepingAmount() == 0 && stack_world.getAwakeAmount() == 2);
+   assert(stack[1]->getPosition().getY() > 75.5f && stack[2]->getPosition().getY() > 65.5f);
+   assert(std::abs(stack[1]->getPosition().getY() - stack[2]->getPosition().getY() - 10.f) < 0.1f);
+   // resting box pushed against a sleeping one wakes it instead of falling asleep alone
+   pe::DynamicObject* neighbour = new pe::DynamicObject(&box_shape, 1.f);
+   neighbour->setPosition(pe::Vector2f(-300.f, 85.f));
+   assert(stack_world.addObject(neighbour));
+   for (int i = 0; i < 300; i++) stack_world.update();
+   assert(neighbour->isSleeping());
+   pe::PhysicsWorld::setSleepThresholds(100.f, 100.f, 60); // slow box counts as resting
+   pe::DynamicObject* pushed = new pe::DynamicObject(&box_shape, 1.f);
+   pushed->setPosition(pe::Vector2f(-287.f, 85.f));
+   pushed->setVelocity(pe::Vector2f(-30.f, 0.f));
+   assert(stack_world.addObject(pushed));
+   for (int i = 0; i < 5; i++) stack_world.update();
+   assert(pushed->getRestSteps() > 0 && neighbour->isSleeping());
+   for (int i = 0; i < 5; i++) stack_world.update();
+   assert(!pushed->isSleeping() && !neighbour->isSleeping());
+   for (int i = 0; i < 100; i++) stack_world.update();
+   // both fall asleep together once they are separated
+   assert(neighbour->isSleeping() && pushed->isSleeping());
+   assert(neighbour->getMaxPosition().getX() < pushed->getMinPosition().getX() + 0.1f);
+   pe::PhysicsWorld::setSleepThresholds(1.f, 0.001f, 60);
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Bulk add test" << std::endl;
+   for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+     bulkTest(type, ground_shape, box_shape);
+   }
+   std::cout << "test successful" << std::endl;
+
+   std::cout << std::endl << "Bullet test" << std::endl;
+   for (auto type : {pe::BroadphaseType::Grid, pe::BroadphaseType::HashGrid, pe::BroadphaseType::SweepAndPrune, pe::BroadphaseType::AABBTree}) {
+     bulletTest(type, box_shape);
+   }
+   std::cout << "test successful" << std::endl;
 
-   std::cout << "All PhysicsWorld tests passed" << std::endl;
+   std::cout << std::endl << "All PhysicsWorld tests passed" << std::endl;
    return 0;
  }
@@ -0,0 +1,213 @@
+/**
+  *   @file SpatialHashGrid_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for SpatialHashGrid
+  */
+
+
+#include "../include/SpatialHashGrid.hpp"
+#include "../include/DynamicObject.hpp"
+#include "../include/StaticObject.hpp"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+/**
+  *   @brief Count objects in all Cells
+  *   @details Objects overlapping multiple Cells are counted only in their home Cell
+  *   @param grid SpatialHashGrid to be checked
+  *   @return amount of objects
+  */
+unsigned countObjects(pe::SpatialHashGrid& grid) {
+  std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+  grid.collectCells(cells, false);
+  unsigned amount = 0;
+  for (auto cell : cells) {
+    for (auto object : cell->entities) {
+      if (pe::isHomeCell(cell, object)) amount++;
+    }
+  }
+  return amount;
+}
+
+/**
+  *   @brief Count Cells containing object
+  *   @param grid SpatialHashGrid to be checked
+  *   @param object PhysicsObject to be found
+  *   @return amount of Cells containing object
+  */
+unsigned countCells(pe::SpatialHashGrid& grid, pe::PhysicsObject* object) {
+  std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+  grid.collectCells(cells, false);
+  unsigned amount = 0;
+  for (auto cell : cells) {
+    for (auto entity : cell->entities) {
+      if (entity == object) amount++;
+    }
+  }
+  return amount;
+}
+
+/**
+  *   @brief Check that every entity is found from its stored slot
+  *   @details Also checks that Cells are active exactly when they contain
+  *   DynamicObjects
+  *   @param grid SpatialHashGrid to be checked
+  *   @return true if all slots and active flags are correct
+  */
+bool validSlots(pe::SpatialHashGrid& grid) {
+  std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+  grid.collectCells(cells, false);
+  for (auto cell : cells) {
+    unsigned dynamics = 0;
+    for (unsigned i = 0; i < cell->entities.size(); i++) {
+      if (pe::cellSlot(cell, cell->entities[i]) != i) return false;
+      if (cell->entities[i]->getObjectType() == pe::ObjectType::DynamicObject) dynamics++;
+    }
+    if ((dynamics != cell->dynamic_entities) || (cell->active_cell != (dynamics > 0))) return false;
+  }
+  return true;
+}
+
+/**
+  *   @brief Test main for SpatialHashGrid
+  */
+int main() {
+  std::cout << "SpatialHashGrid test" << std::endl << std::endl;
+
+  std::cout << "Constructor test" << std::endl;
+  pe::SpatialHashGrid grid(100.f);
+  assert(grid.getCellSize() == 100.f);
+  assert(grid.getCellAmount() == 0);
+  pe::SpatialHashGrid grid2(-50.f);
+  assert(grid2.getCellSize() == 50.f);
+  pe::SpatialHashGrid grid3(0.f);
+  assert(grid3.getCellSize() == pe::SpatialHashGrid::DefaultCellSize);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Add and remove test" << std::endl;
+  pe::Shape shape(10.f, 10.f);
+  pe::Shape big_shape(300.f, 20.f);
+  // far away positions are allowed, there is no world size
+  pe::Vector2f positions[] = {pe::Vector2f(50.f, 50.f), pe::Vector2f(-50.f, 50.f), pe::Vector2f(10000050.f, -10000050.f), pe::Vector2f(-3e9f, 3e9f)};
+  std::vector<pe::PhysicsObject*> objects;
+  for (auto& position : positions) {
+    pe::DynamicObject* dyn = new pe::DynamicObject(&shape, 1.f);
+    dyn->setPosition(position);
+    assert(grid.addObject(dyn));
+    objects.push_back(dyn);
+  }
+  assert(grid.getCellAmount() == 4);
+  pe::StaticObject* ground = new pe::StaticObject(&big_shape);
+  ground->setPosition(pe::Vector2f(0.f, 0.f)); // overlaps multiple Cells
+  assert(grid.addObject(ground));
+  assert(countCells(grid, ground) == 8); // x from -2 to 1 and y from -1 to 0
+  assert(grid.getCellAmount() == 10);
+  // many objects in one Cell, forces also table growth with other Cells
+  for (int i = 0; i < 200; i++) {
+    pe::StaticObject* stat = new pe::StaticObject(&shape);
+    stat->setPosition(pe::Vector2f(1000.f * i + 50.f, 550.f));
+    assert(grid.addObject(stat));
+    objects.push_back(stat);
+  }
+  assert(grid.getCellAmount() == 210);
+  assert(countObjects(grid) == 205);
+  std::vector<pe::Cell<pe::PhysicsObject*>*> active;
+  grid.collectCells(active, true);
+  assert(active.size() == 4); // only Cells with DynamicObjects
+  pe::SpatialHashGrid copy = grid;
+  assert(countObjects(copy) == 205);
+  assert(copy.getCellAmount() == grid.getCellAmount());
+  assert(countCells(copy, ground) == 0); // objects are copied
+  assert(grid.removeObject(ground));
+  assert(!copy.removeObject(objects[1])); // not owned by copy
+  assert(grid.removeObject(objects[0]));
+  assert(grid.removeObject(objects[2])); // very far away object
+  assert(countObjects(grid) == 202);
+  pe::DynamicObject outside(&shape, 1.f);
+  assert(!grid.removeObject(&outside)); // never added
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Move test" << std::endl;
+  pe::SpatialHashGrid moving(100.f);
+  pe::DynamicObject* dyn = new pe::DynamicObject(&shape, 1.f);
+  dyn->setPosition(pe::Vector2f(50.f, 50.f));
+  moving.addObject(dyn);
+  // move to another Cell
+  dyn->setPosition(pe::Vector2f(250.f, 50.f));
+  moving.moveObjects();
+  assert(moving.getCellAmount() == 2);
+  assert(countObjects(moving) == 1);
+  assert(!dyn->getMoved());
+  // move to Cell border -> stored to both Cells
+  dyn->setPosition(pe::Vector2f(300.f, 50.f));
+  moving.moveObjects();
+  assert(countCells(moving, dyn) == 2);
+  assert(countObjects(moving) == 1);
+  // and back inside one Cell
+  dyn->setPosition(pe::Vector2f(350.f, 50.f));
+  moving.moveObjects();
+  assert(countCells(moving, dyn) == 1);
+  assert(countObjects(moving) == 1);
+  // removal uses stored CellRange, so it works after position changes too
+  dyn->setPosition(pe::Vector2f(-950.f, 50.f));
+  assert(moving.removeObject(dyn));
+  assert(countObjects(moving) == 0);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Swap remove test" << std::endl;
+  pe::SpatialHashGrid dense(100.f);
+  std::vector<pe::PhysicsObject*> members;
+  for (int i = 0; i < 300; i++) {
+    // objects overlap up to four Cells, every third object is static
+    pe::PhysicsObject* object;
+    if (i % 3 == 0) object = new pe::StaticObject(&shape);
+    else object = new pe::DynamicObject(&shape, 1.f);
+    object->setPosition(pe::Vector2f(i % 7 * 33.f, i % 5 * 47.f));
+    assert(dense.addObject(object));
+    members.push_back(object);
+  }
+  assert(validSlots(dense));
+  // remove in scattered order so that removed objects are rarely the last ones
+  for (unsigned i = 0; i < members.size(); i += 2) {
+    pe::PhysicsObject* object = members[(i * 37) % members.size()];
+    if (object == nullptr) continue;
+    members[(i * 37) % members.size()] = nullptr;
+    assert(dense.removeObject(object));
+    assert(validSlots(dense));
+  }
+  for (auto object : members) {
+    if ((object != nullptr) && (object->getObjectType() == pe::ObjectType::DynamicObject)) {
+      object->setPosition(object->getPosition() + pe::Vector2f(60.f, 0.f));
+      object->setMoved(true);
+    }
+  }
+  dense.moveObjects();
+  assert(validSlots(dense));
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Region query test" << std::endl;
+  pe::Vector2f regions[][2] = {{pe::Vector2f(-10.f, -10.f), pe::Vector2f(110.f, 110.f)},
+                               {pe::Vector2f(150.f, 0.f), pe::Vector2f(150.f, 500.f)},
+                               {pe::Vector2f(-1e6f, -1e6f), pe::Vector2f(1e6f, 1e6f)}, // more Cells than allocated
+                               {pe::Vector2f(10.f, 10.f), pe::Vector2f(-10.f, -10.f)}};
+  for (auto& region : regions) {
+    // Cell based query finds the same objects as checking every object
+    std::vector<pe::PhysicsObject*> found, expected;
+    dense.queryRegion(region[0], region[1], found);
+    dense.Broadphase::queryRegion(region[0], region[1], expected);
+    std::sort(found.begin(), found.end());
+    std::sort(expected.begin(), expected.end());
+    assert(found == expected);
+  }
+  for (auto object : members) {
+    if (object != nullptr) assert(dense.removeObject(object));
+  }
+  assert(countObjects(dense) == 0);
+  assert(validSlots(dense));
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All SpatialHashGrid tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,86 @@
+/**
+  *   @file StaticGeometry_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for StaticGeometry
+  */
+
+
+#include "../include/StaticGeometry.hpp"
+#include "../include/DynamicObject.hpp"
+#include "../include/StaticObject.hpp"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+/**
+  *   @brief Test main for StaticGeometry
+  */
+int main() {
+  std::cout << "StaticGeometry test" << std::endl << std::endl;
+
+  std::cout << "Build test" << std::endl;
+  pe::StaticGeometry geometry;
+  pe::Shape shape(10.f, 10.f);
+  std::vector<pe::PhysicsObject*> tiles;
+  // 100 x 100 tiles, 20 units apart
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++) {
+      pe::StaticObject* tile = new pe::StaticObject(&shape);
+      tile->setPosition(pe::Vector2f(20.f * x, 20.f * y));
+      assert(geometry.addObject(tile));
+      tiles.push_back(tile);
+    }
+  }
+  pe::DynamicObject* box = new pe::DynamicObject(&shape, 1.f);
+  assert(!geometry.addObject(box)); // only StaticObjects
+  delete box;
+  assert(geometry.getObjectAmount() == 10000);
+  assert(geometry.isDirty() && geometry.getNodeAmount() == 0);
+  geometry.rebuild();
+  assert(!geometry.isDirty());
+  assert(geometry.getNodeAmount() > 0 && geometry.getNodeAmount() < 2 * 10000 / pe::StaticGeometry::LeafSize + 2);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Query test" << std::endl;
+  std::vector<pe::PhysicsObject*> found;
+  geometry.queryRegion(pe::Vector2f(36.f, 36.f), pe::Vector2f(44.f, 44.f), found);
+  assert(found.size() == 1 && found[0] == tiles[2 * 100 + 2]);
+  found.clear();
+  geometry.queryRegion(pe::Vector2f(5.f, 5.f), pe::Vector2f(25.f, 25.f), found);
+  assert(found.size() == 4); // touching bounds overlap
+  found.clear();
+  geometry.queryRegion(pe::Vector2f(-100.f, -100.f), pe::Vector2f(-20.f, -20.f), found);
+  assert(found.empty());
+  std::vector<std::pair<float, pe::PhysicsObject*>> hits;
+  geometry.queryRay(pe::Vector2f(100.f, -50.f), pe::Vector2f(100.f, 2500.f), hits);
+  assert(hits.size() == 100); // whole column
+  hits.clear();
+  geometry.queryRay(pe::Vector2f(-50.f, 10.f), pe::Vector2f(-50.f, 500.f), hits);
+  assert(hits.empty());
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Copy and remove test" << std::endl;
+  pe::StaticGeometry copy = geometry;
+  assert(copy.getObjectAmount() == 10000 && copy.isDirty());
+  assert(!copy.removeObject(tiles[0])); // not owned by copy
+  assert(geometry.removeObject(tiles[2 * 100 + 2]));
+  assert(geometry.removeObject(tiles[9999]));
+  pe::StaticObject outside(&shape);
+  assert(!geometry.removeObject(&outside)); // never added
+  assert(geometry.getObjectAmount() == 9998 && geometry.isDirty());
+  geometry.rebuild();
+  found.clear();
+  geometry.queryRegion(pe::Vector2f(36.f, 36.f), pe::Vector2f(44.f, 44.f), found);
+  assert(found.empty());
+  found.clear();
+  geometry.queryRegion(pe::Vector2f(-10.f, -10.f), pe::Vector2f(2000.f, 2000.f), found);
+  assert(found.size() == 9998);
+  copy.rebuild();
+  found.clear();
+  copy.queryRegion(pe::Vector2f(36.f, 36.f), pe::Vector2f(44.f, 44.f), found);
+  assert(found.size() == 1 && found[0] != tiles[2 * 100 + 2]); // objects are copied
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All StaticGeometry tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,213 @@
+/**
+  *   @file SweepAndPrune_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for SweepAndPrune
+  */
+
+
+#include "../include/SweepAndPrune.hpp"
+#include "../include/DynamicObject.hpp"
+#include "../include/StaticObject.hpp"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+/**
+  *   @brief Check whether pairs contain pair of objects
+  *   @param pairs pairs returned by collectPairs
+  *   @param object1 1st object
+  *   @param object2 2nd object
+  *   @return true if pair found, otherwise false
+  */
+bool containsPair(const std::vector<pe::ObjectPair>& pairs, pe::PhysicsObject* object1, pe::PhysicsObject* object2) {
+  for (auto& pair : pairs) {
+    if ((pair.first == object1 && pair.second == object2) || (pair.first == object2 && pair.second == object1)) return true;
+  }
+  return false;
+}
+
+/**
+  *   @brief Find overlapping pairs by checking every pair of objects
+  *   @param objects checked DynamicObjects
+  *   @return pairs with the smaller address first, sorted
+  */
+std::vector<std::pair<pe::PhysicsObject*, pe::PhysicsObject*>> bruteForcePairs(const std::vector<pe::PhysicsObject*>& objects) {
+  std::vector<std::pair<pe::PhysicsObject*, pe::PhysicsObject*>> pairs;
+  for (unsigned i = 0; i < objects.size(); i++) {
+    for (unsigned j = i + 1; j < objects.size(); j++) {
+      pe::Vector2f min1 = objects[i]->getMinPosition(), max1 = objects[i]->getMaxPosition();
+      pe::Vector2f min2 = objects[j]->getMinPosition(), max2 = objects[j]->getMaxPosition();
+      if ((max1.getX() < min2.getX()) || (max2.getX() < min1.getX()) || (max1.getY() < min2.getY()) || (max2.getY() < min1.getY())) continue;
+      pairs.push_back(std::minmax(objects[i], objects[j]));
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+/**
+  *   @brief Collect pairs of SweepAndPrune in the format of bruteForcePairs
+  *   @param sap tested SweepAndPrune
+  *   @return pairs with the smaller address first, sorted
+  */
+std::vector<std::pair<pe::PhysicsObject*, pe::PhysicsObject*>> sortedPairs(pe::SweepAndPrune& sap) {
+  std::vector<pe::ObjectPair> pairs;
+  sap.collectPairs(pairs);
+  std::vector<std::pair<pe::PhysicsObject*, pe::PhysicsObject*>> sorted;
+  for (auto& pair : pairs) sorted.push_back(std::minmax(pair.first, pair.second));
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+/**
+  *   @brief Test main for SweepAndPrune
+  */
+int main() {
+  std::cout << "SweepAndPrune test" << std::endl << std::endl;
+
+  std::cout << "Pair test" << std::endl;
+  pe::SweepAndPrune sap;
+  pe::Shape shape(10.f, 10.f);
+  pe::Shape ground_shape(1000.f, 20.f);
+  pe::StaticObject* ground = new pe::StaticObject(&ground_shape);
+  ground->setPosition(pe::Vector2f(0.f, 0.f));
+  assert(sap.addObject(ground));
+  pe::StaticObject* wall = new pe::StaticObject(&shape);
+  wall->setPosition(pe::Vector2f(100.f, 10.f)); // overlaps ground, static pair is skipped
+  assert(sap.addObject(wall));
+  pe::DynamicObject* box = new pe::DynamicObject(&shape, 1.f);
+  box->setPosition(pe::Vector2f(-100.f, 10.f)); // touches ground
+  assert(sap.addObject(box));
+  pe::DynamicObject* flying = new pe::DynamicObject(&shape, 1.f);
+  flying->setPosition(pe::Vector2f(-100.f, -100.f)); // same x as box, no y overlap
+  assert(sap.addObject(flying));
+  assert(sap.getObjectAmount() == 4);
+  std::vector<pe::ObjectPair> pairs;
+  assert(sap.collectPairs(pairs));
+  assert(pairs.size() == 1);
+  assert(containsPair(pairs, box, ground));
+  std::vector<pe::Cell<pe::PhysicsObject*>*> cells;
+  sap.collectCells(cells, true);
+  assert(cells.size() == 1 && cells[0]->entities.size() == 4);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Move test" << std::endl;
+  // move flying over the wall, endpoints need reordering
+  flying->setPosition(pe::Vector2f(102.f, 12.f));
+  sap.moveObjects();
+  assert(!flying->getMoved());
+  pairs.clear();
+  sap.collectPairs(pairs);
+  assert(pairs.size() == 3);
+  assert(containsPair(pairs, flying, wall) && containsPair(pairs, flying, ground) && containsPair(pairs, box, ground));
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Copy and remove test" << std::endl;
+  pe::SweepAndPrune copy = sap;
+  assert(copy.getObjectAmount() == 4);
+  pairs.clear();
+  copy.collectPairs(pairs);
+  assert(pairs.size() == 3);
+  assert(!containsPair(pairs, flying, wall)); // objects are copied
+  assert(!copy.removeObject(box)); // not owned by copy
+  assert(sap.removeObject(ground));
+  assert(sap.getObjectAmount() == 3);
+  pairs.clear();
+  sap.collectPairs(pairs);
+  assert(pairs.size() == 1 && containsPair(pairs, flying, wall));
+  // removed proxy is reused
+  pe::StaticObject* ground2 = new pe::StaticObject(&ground_shape);
+  assert(sap.addObject(ground2));
+  pairs.clear();
+  sap.collectPairs(pairs);
+  assert(pairs.size() == 3);
+  // removal and addition between sorts, stale endpoints must not pair the new object
+  assert(sap.removeObject(ground2));
+  pe::StaticObject* ground3 = new pe::StaticObject(&ground_shape);
+  assert(sap.addObject(ground3));
+  assert(sap.getObjectAmount() == 4);
+  pairs.clear();
+  sap.collectPairs(pairs);
+  assert(pairs.size() == 3 && containsPair(pairs, box, ground3));
+  pe::DynamicObject outside(&shape, 1.f);
+  assert(!sap.removeObject(&outside)); // never added
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Bucket test" << std::endl;
+  pe::SweepAndPrune many;
+  for (unsigned i = 0; i < pe::ObjectBuckets::BucketSize + 1; i++) {
+    pe::DynamicObject* dyn = new pe::DynamicObject(&shape, 1.f);
+    dyn->setPosition(pe::Vector2f(20.f * i, 0.f));
+    many.addObject(dyn);
+  }
+  cells.clear();
+  many.collectCells(cells, false);
+  assert(cells.size() == 2);
+  assert(cells[1]->entities.size() == 1);
+  pairs.clear();
+  many.collectPairs(pairs);
+  assert(pairs.empty()); // 10 units wide objects with 20 units spacing
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Region query test" << std::endl;
+  pe::Shape wide_shape(200.f, 10.f);
+  for (unsigned i = 0; i < 40; i++) {
+    // wide objects start far left of the regions they overlap
+    pe::DynamicObject* wide = new pe::DynamicObject(&wide_shape, 1.f);
+    wide->setPosition(pe::Vector2f(37.f * i, 15.f * (i % 4) - 20.f));
+    many.addObject(wide);
+  }
+  many.moveObjects();
+  pe::Vector2f regions[][2] = {{pe::Vector2f(300.f, -5.f), pe::Vector2f(320.f, 5.f)},
+                               {pe::Vector2f(-1000.f, -1000.f), pe::Vector2f(10000.f, 1000.f)},
+                               {pe::Vector2f(1500.f, 20.f), pe::Vector2f(1500.f, 30.f)},
+                               {pe::Vector2f(5000.f, 0.f), pe::Vector2f(6000.f, 0.f)}};
+  for (auto& region : regions) {
+    // endpoint search finds the same objects as checking every object
+    std::vector<pe::PhysicsObject*> found, expected;
+    many.queryRegion(region[0], region[1], found);
+    many.Broadphase::queryRegion(region[0], region[1], expected);
+    std::sort(found.begin(), found.end());
+    std::sort(expected.begin(), expected.end());
+    assert(found == expected);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Bulk load test" << std::endl;
+  {
+    // objects are added in random order, sorted endpoints are merged with appended ones
+    pe::SweepAndPrune bulk;
+    std::vector<pe::PhysicsObject*> objects;
+    uint32_t seed = 12345;
+    auto random = [&seed] (float range) {
+      seed = seed * 1664525u + 1013904223u;
+      return static_cast<float>(seed >> 8) / 16777216.f * range;
+    };
+    for (unsigned i = 0; i < 2000; i++) {
+      pe::DynamicObject* dyn = new pe::DynamicObject(&shape, 1.f);
+      dyn->setPosition(pe::Vector2f(random(1000.f), random(1000.f)));
+      assert(bulk.addObject(dyn));
+      objects.push_back(dyn);
+    }
+    assert(sortedPairs(bulk) == bruteForcePairs(objects));
+    // removals, additions and moves before the same sort
+    for (unsigned i = 0; i < 500; i++) {
+      assert(bulk.removeObject(objects[i]));
+      pe::DynamicObject* dyn = new pe::DynamicObject(&shape, 1.f);
+      dyn->setPosition(pe::Vector2f(random(1000.f), random(1000.f)));
+      assert(bulk.addObject(dyn));
+      objects[i] = dyn;
+    }
+    for (unsigned i = 500; i < 1000; i++) objects[i]->setPosition(pe::Vector2f(random(1000.f), random(1000.f)));
+    bulk.moveObjects();
+    assert(bulk.getObjectAmount() == 2000);
+    assert(sortedPairs(bulk) == bruteForcePairs(objects));
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All SweepAndPrune tests passed" << std::endl;
+  return 0;
+}
@@ -0,0 +1,62 @@
+/**
+  *   @file TaskScheduler_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for TaskScheduler
+  */
+
+#include "../include/TaskScheduler.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <vector>
+
+
+/**
+  *   @brief Test main for TaskScheduler
+  */
+int main() {
+  std::cout << "TaskScheduler test" << std::endl << std::endl;
+
+  std::cout << "Every task executed once test" << std::endl;
+  pe::ThreadPool pool(3);
+  pe::TaskScheduler scheduler(&pool);
+  assert(scheduler.getThreads() == 4);
+  for (unsigned tasks : {0u, 1u, 3u, 4u, 5u, 100u, 1001u}) {
+    std::vector<std::atomic<unsigned>> calls(tasks);
+    for (auto& call : calls) call = 0;
+    std::atomic<bool> valid_thread(true);
+    scheduler.run(tasks, [&] (unsigned task, unsigned thread) {
+      if (thread >= 4) valid_thread = false;
+      calls[task]++;
+    });
+    assert(valid_thread);
+    for (auto& call : calls) assert(call == 1);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Uneven tasks test" << std::endl;
+  // first tasks are much heavier than the rest, results must still be complete
+  std::vector<unsigned long> results(64, 0);
+  scheduler.run(results.size(), [&results] (unsigned task, unsigned) {
+    unsigned long sum = 0;
+    unsigned long rounds = task < 4 ? 200000 : 10;
+    for (unsigned long i = 0; i < rounds; i++) sum += i;
+    results[task] = sum;
+  });
+  for (unsigned i = 0; i < results.size(); i++) {
+    unsigned long rounds = i < 4 ? 200000 : 10;
+    assert(results[i] == rounds * (rounds - 1) / 2);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Resized pool test" << std::endl;
+  pool.resize(0);
+  assert(scheduler.getThreads() == 1);
+  unsigned count = 0;
+  scheduler.run(10, [&count] (unsigned, unsigned thread) { assert(thread == 0); count++; });
+  assert(count == 10);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All TaskScheduler tests passed" << std::endl;
+  return 0;
+}
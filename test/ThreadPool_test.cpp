@@ -0,0 +1,48 @@
+/**
+  *   @file ThreadPool_test.cpp
+  *   @author Lauri Westerholm
+  *   @brief Contains test main for ThreadPool
+  */
+
+#include "../include/ThreadPool.hpp"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <vector>
+
+
+/**
+  *   @brief Test main for ThreadPool
+  */
+int main() {
+  std::cout << "ThreadPool test" << std::endl << std::endl;
+
+  std::cout << "Run test" << std::endl;
+  pe::ThreadPool pool(3);
+  assert(pool.getWorkers() == 3);
+  std::vector<int> calls(4, 0);
+  // every index is called exactly once per run
+  for (int round = 1; round <= 100; round++) {
+    pool.run([&calls] (unsigned index) { calls[index]++; });
+    for (int amount : calls) assert(amount == round);
+  }
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "Resize test" << std::endl;
+  pool.resize(1);
+  assert(pool.getWorkers() == 1);
+  std::atomic<unsigned> sum(0);
+  pool.run([&sum] (unsigned index) { sum += index + 1; });
+  assert(sum == 3); // indices 0 and 1
+  pool.resize(0);
+  sum = 0;
+  pool.run([&sum] (unsigned index) { sum += index + 1; });
+  assert(sum == 1); // only the calling thread
+  pe::ThreadPool empty(0);
+  empty.run([&sum] (unsigned index) { assert(index == 0); sum++; });
+  assert(sum == 2);
+  std::cout << "test successful" << std::endl;
+
+  std::cout << std::endl << "All ThreadPool tests passed" << std::endl;
+  return 0;
+}
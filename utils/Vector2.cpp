@@ -9,32 +9,6 @@
 namespace pe {
 
 
-  /*  Constructors */
-  template<typename T>
-  Vector2<T>::Vector2(T x, T y): x(x), y(y) {}
-
-  template<typename T>
-  Vector2<T>::Vector2(): x(static_cast<T> (0)), y(static_cast<T> (0)) {}
-
-  template<typename T>
-  Vector2<T>::Vector2(const Vector2<T>& vector2): x(vector2.x), y(vector2.y) {}
-
-  template<typename T>
-  T Vector2<T>::getX() const {
-    return x;
-  }
-
-  template<typename T>
-  T Vector2<T>::getY() const {
-    return y;
-  }
-
-  template<typename T>
-  void Vector2<T>::update(T x, T y) {
-    this->x = x;
-    this->y = y;
-  }
-
   template<typename T>
   void Vector2<T>::normalize() {
     float norm = std::sqrt(x * x + y * y);
@@ -32,19 +32,19 @@ namespace pe {
         *   @param x x coordinate
         *   @param y y coordinate
         */
-      Vector2(T x, T y);
+      Vector2(T x, T y): x(x), y(y) {}
 
       /**
         *   @brief Empty constructor
         *   @remark sets x and y to 0
         */
-      Vector2();
+      Vector2(): x(static_cast<T> (0)), y(static_cast<T> (0)) {}
 
       /**
         *   @brief Copy constructor
         *   @param vector2 Vector2 instance to be copied
         */
-      Vector2(const Vector2<T>& vector2);
+      Vector2(const Vector2<T>& vector2): x(vector2.x), y(vector2.y) {}
 
       /**
         *   @brief Cast to another Vector2 type
@@ -59,20 +59,27 @@ namespace pe {
         *   @brief Get x value
         *   @return x
         */
-      T getX() const;
+      inline T getX() const {
+        return x;
+      }
 
       /**
         *   @brief Get y value
         *   @return y
         */
-      T getY() const;
+      inline T getY() const {
+        return y;
+      }
 
       /**
         *   @brief Update x and y values
         *   @param x new x value
         *   @param y new y value
         */
-      void update(T x, T y);
+      inline void update(T x, T y) {
+        this->x = x;
+        this->y = y;
+      }
 
       /**
         *   @brief Normalize Vector2